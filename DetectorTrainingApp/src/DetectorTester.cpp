@@ -7,19 +7,27 @@
 
 #include "Annotations.hpp"
 #include "DetectorTester.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <exception>
 #include <fstream>
+#include <mutex>
 #include <string>
+#include <thread>
 
 using cv::Mat;
 using cv::Rect;
 using detection::SimpleDetector;
 using imageio::RectLandmark;
+using std::chrono::duration;
 using std::chrono::duration_cast;
 using std::chrono::milliseconds;
 using std::chrono::steady_clock;
 using std::function;
 using std::ifstream;
 using std::ofstream;
+using std::shared_ptr;
 using std::vector;
 
 using namespace std;
@@ -31,19 +39,83 @@ DetectorTester::DetectorTester(cv::Size minWindowSize, double overlapThreshold)
 }
 
 void DetectorTester::evaluate(SimpleDetector& detector, const vector<LabeledImage>& images) {
+	vector<ImageEvaluation> evaluations;
+	evaluations.reserve(images.size());
+	steady_clock::time_point start = steady_clock::now();
 	for (const LabeledImage& image : images)
-		evaluate(detector, image.image, image.landmarks);
+		evaluations.push_back(evaluateImage(detector, image.image, image.landmarks));
+	steady_clock::time_point end = steady_clock::now();
+	addEvaluations(evaluations, duration_cast<milliseconds>(end - start));
+}
+
+void DetectorTester::evaluate(const vector<shared_ptr<SimpleDetector>>& detectors, const vector<LabeledImage>& images) {
+	if (detectors.empty())
+		throw invalid_argument("there must be at least one detector");
+	vector<ImageEvaluation> evaluations(images.size());
+	std::atomic<size_t> nextIndex(0);
+	std::exception_ptr error;
+	std::mutex errorMutex;
+	steady_clock::time_point start = steady_clock::now();
+	// each worker thread uses its own detector and takes the next image that was not evaluated yet
+	vector<std::thread> workers;
+	workers.reserve(detectors.size());
+	for (const shared_ptr<SimpleDetector>& detector : detectors) {
+		workers.emplace_back([&, detector]() {
+			try {
+				for (size_t i = nextIndex++; i < images.size(); i = nextIndex++)
+					evaluations[i] = evaluateImage(*detector, images[i].image, images[i].landmarks);
+			} catch (...) {
+				std::lock_guard<std::mutex> lock(errorMutex);
+				if (!error)
+					error = std::current_exception();
+				nextIndex = images.size(); // let the other workers stop early
+			}
+		});
+	}
+	for (std::thread& worker : workers)
+		worker.join();
+	if (error)
+		std::rethrow_exception(error);
+	steady_clock::time_point end = steady_clock::now();
+	addEvaluations(evaluations, duration_cast<milliseconds>(end - start));
 }
 
 void DetectorTester::evaluate(SimpleDetector& detector, const Mat& image, const vector<RectLandmark>& landmarks) {
+	steady_clock::time_point start = steady_clock::now();
+	vector<ImageEvaluation> evaluations = { evaluateImage(detector, image, landmarks) };
+	steady_clock::time_point end = steady_clock::now();
+	addEvaluations(evaluations, duration_cast<milliseconds>(end - start));
+}
+
+DetectorTester::ImageEvaluation DetectorTester::evaluateImage(
+		SimpleDetector& detector, const Mat& image, const vector<RectLandmark>& landmarks) const {
 	Annotations annotations(landmarks, minWindowSize);
 	steady_clock::time_point start = steady_clock::now();
 	vector<pair<Rect, float>> detections = detector.detectWithScores(image);
 	steady_clock::time_point end = steady_clock::now();
-	detectionTimeSum += duration_cast<milliseconds>(end - start);
-	imageCount += 1;
-	positiveCount += annotations.positives.size();
-	mergeInto(classifiedScores, classifyScores(detections, annotations));
+	ImageEvaluation evaluation;
+	evaluation.time = duration_cast<duration<double, std::milli>>(end - start).count();
+	evaluation.positiveCount = annotations.positives.size();
+	evaluation.classifiedScores = classifyScores(detections, annotations);
+	return evaluation;
+}
+
+void DetectorTester::addEvaluations(vector<ImageEvaluation>& evaluations, milliseconds wallTime) {
+	size_t additionalScoreCount = 0;
+	for (const ImageEvaluation& evaluation : evaluations)
+		additionalScoreCount += evaluation.classifiedScores.size();
+	vector<pair<float, bool>> additionalScores;
+	additionalScores.reserve(additionalScoreCount);
+	for (ImageEvaluation& evaluation : evaluations) {
+		std::move(evaluation.classifiedScores.begin(), evaluation.classifiedScores.end(), std::back_inserter(additionalScores));
+		detectionTimeSum += milliseconds(static_cast<milliseconds::rep>(std::round(evaluation.time)));
+		imageTimes.push_back(evaluation.time);
+		imageCount += 1;
+		positiveCount += evaluation.positiveCount;
+	}
+	wallTimeSum += wallTime;
+	std::sort(additionalScores.begin(), additionalScores.end(), std::greater<pair<float, bool>>());
+	mergeInto(classifiedScores, additionalScores);
 }
 
 vector<pair<float, bool>> DetectorTester::classifyScores(const vector<pair<Rect, float>>& detections, Annotations annotations) const {
@@ -171,6 +243,14 @@ DetectorEvaluationSummary DetectorTester::getSummary() const {
 	if (imageCount > 0) {
 		summary.avgTime = detectionTimeSum / imageCount;
 		summary.fps = 1000.0 * imageCount / detectionTimeSum.count();
+		summary.throughput = 1000.0 * imageCount / wallTimeSum.count();
+	}
+	if (!imageTimes.empty()) {
+		vector<double> sortedTimes = imageTimes;
+		std::sort(sortedTimes.begin(), sortedTimes.end());
+		summary.medianTime = getTimeAtPercentile(sortedTimes, 0.5);
+		summary.timeAtPercentile90 = getTimeAtPercentile(sortedTimes, 0.9);
+		summary.timeAtPercentile99 = getTimeAtPercentile(sortedTimes, 0.99);
 	}
 	bool defaultThresholdFound = false;
 	array<double, 9> fppiRates = {
@@ -234,12 +314,22 @@ DetectorEvaluationSummary DetectorTester::getSummary() const {
 	return summary;
 }
 
+double DetectorTester::getTimeAtPercentile(const vector<double>& sortedTimes, double percentile) const {
+	size_t index = static_cast<size_t>(std::ceil(percentile * sortedTimes.size()));
+	return sortedTimes[std::min(std::max(index, static_cast<size_t>(1)), sortedTimes.size()) - 1];
+}
+
 void DetectorTester::storeData(const string& filename) const {
 	ofstream file(filename);
 	file << "Threshold " << overlapThreshold << '\n';
 	file << "Images " << imageCount << '\n';
 	file << "Positives " << positiveCount << '\n';
 	file << "Time " << detectionTimeSum.count() << '\n';
+	file << "WallTime " << wallTimeSum.count() << '\n';
+	file << "ImageTimes " << imageTimes.size();
+	for (double time : imageTimes)
+		file << ' ' << time;
+	file << '\n';
 	file << "Scores\n";
 	for (const pair<float, bool>& classifiedScore : classifiedScores)
 		file << classifiedScore.first << " " << classifiedScore.second << '\n';
@@ -255,7 +345,20 @@ void DetectorTester::loadData(const string& filename) {
 	milliseconds::rep timeInMilliseconds;
 	file >> tmp >> timeInMilliseconds; // "Time"
 	detectionTimeSum = milliseconds(timeInMilliseconds);
-	file >> tmp; // "Scores"
+	wallTimeSum = detectionTimeSum; // data of older evaluations does not contain the wall-clock time
+	imageTimes.clear();
+	file >> tmp; // "WallTime", "ImageTimes" or "Scores"
+	if (tmp == "WallTime") {
+		file >> timeInMilliseconds;
+		wallTimeSum = milliseconds(timeInMilliseconds);
+		file >> tmp; // "ImageTimes"
+		size_t imageTimeCount;
+		file >> imageTimeCount;
+		imageTimes.resize(imageTimeCount);
+		for (double& time : imageTimes)
+			file >> time;
+		file >> tmp; // "Scores"
+	}
 	classifiedScores.clear();
 	while (!file.eof()) {
 		float score;
@@ -14,6 +14,8 @@
 #include "imageio/RectLandmark.hpp"
 #include "opencv2/core/core.hpp"
 #include <chrono>
+#include <functional>
+#include <memory>
 #include <vector>
 
 /**
@@ -31,6 +33,10 @@ struct DetectorEvaluationSummary {
 	double avgMissRate = std::numeric_limits<double>::quiet_NaN(); ///< Log-average miss rate.
 	std::chrono::milliseconds avgTime; ///< Average detection time per image.
 	double fps = std::numeric_limits<double>::quiet_NaN(); ///< Detection speed in frames per second.
+	double throughput = std::numeric_limits<double>::quiet_NaN(); ///< Evaluated images per second of wall-clock time (includes parallelism).
+	double medianTime = std::numeric_limits<double>::quiet_NaN(); ///< Median detection time per image in milliseconds.
+	double timeAtPercentile90 = std::numeric_limits<double>::quiet_NaN(); ///< 90th percentile of the detection time per image in milliseconds.
+	double timeAtPercentile99 = std::numeric_limits<double>::quiet_NaN(); ///< 99th percentile of the detection time per image in milliseconds.
 
 	/**
 	 * Writes the summary data into a stream.
@@ -40,6 +46,10 @@ struct DetectorEvaluationSummary {
 	void writeTo(std::ostream& out) {
 		out << "Speed: " << fps << " frames / second" << std::endl;
 		out << "Average time: " << avgTime.count() << " ms" << std::endl;
+		out << "Throughput: " << throughput << " images / second" << std::endl;
+		out << "Median time: " << medianTime << " ms" << std::endl;
+		out << "Time at 90th percentile: " << timeAtPercentile90 << " ms" << std::endl;
+		out << "Time at 99th percentile: " << timeAtPercentile99 << " ms" << std::endl;
 		out << "Default FPPI rate: " << defaultFppiRate << std::endl;
 		out << "Default miss rate: " << defaultMissRate << std::endl;
 		out << "Miss rate at 1 FPPI: " << missRateAtFppi0 << " (threshold " << thresholdAtFppi0 << ")" << std::endl;
@@ -92,6 +102,20 @@ public:
 	 */
 	void evaluate(detection::SimpleDetector& detector, const std::vector<LabeledImage>& images);
 
+	/**
+	 * Evaluates detectors on several images in parallel.
+	 *
+	 * Detectors are not thread-safe, so there is one worker thread per detector. The workers take the images one
+	 * after another until all of them are evaluated. The classified scores of all images are merged into the
+	 * existing data at the end.
+	 *
+	 * @param[in] detectors Detectors that should be evaluated, one per worker thread (the number of detectors
+	 *            determines the number of threads). They must be equally configured.
+	 * @param[in] images Images with labeled bounding boxes.
+	 */
+	void evaluate(const std::vector<std::shared_ptr<detection::SimpleDetector>>& detectors,
+			const std::vector<LabeledImage>& images);
+
 	/**
 	 * Evaluates a detector on a single image.
 	 *
@@ -158,6 +182,43 @@ private:
 		std::vector<PositiveStatus> positiveStatus;
 	};
 
+	/**
+	 * Evaluation result of a single image.
+	 */
+	struct ImageEvaluation {
+		std::vector<std::pair<float, bool>> classifiedScores; ///< Detection scores in descending order with their classification label.
+		int positiveCount = 0; ///< Number of positive annotations.
+		double time = 0; ///< Detection time in milliseconds.
+	};
+
+	/**
+	 * Runs a detector on a single image and compares the detections with the ground truth.
+	 *
+	 * @param[in] detector Detector that should be evaluated.
+	 * @param[in] image Image to detect targets in.
+	 * @param[in] landmarks Labeled bounding boxes that are either positive or should be ignored (neither positive, nor negative).
+	 * @return Classified scores, number of positives and detection time.
+	 */
+	ImageEvaluation evaluateImage(detection::SimpleDetector& detector,
+			const cv::Mat& image, const std::vector<imageio::RectLandmark>& landmarks) const;
+
+	/**
+	 * Adds the evaluation results of several images, sorting and merging the scores only once.
+	 *
+	 * @param[in] evaluations Evaluation results of the images.
+	 * @param[in] wallTime Wall-clock time it took to evaluate the images.
+	 */
+	void addEvaluations(std::vector<ImageEvaluation>& evaluations, std::chrono::milliseconds wallTime);
+
+	/**
+	 * Computes the detection time per image at the given percentile.
+	 *
+	 * @param[in] sortedTimes Detection times in ascending order.
+	 * @param[in] percentile Percentile between zero and one.
+	 * @return Detection time in milliseconds.
+	 */
+	double getTimeAtPercentile(const std::vector<double>& sortedTimes, double percentile) const;
+
 	/**
 	 * Classifies the detection scores as either true positive or false positive.
 	 *
@@ -225,6 +286,8 @@ private:
 	int positiveCount = 0; ///< Number of positive annotations.
 	std::vector<std::pair<float, bool>> classifiedScores; ///< Detection scores with flag that indicates whether the detection was a true positive.
 	std::chrono::milliseconds detectionTimeSum = std::chrono::milliseconds::zero(); ///< Sum of detection times.
+	std::chrono::milliseconds wallTimeSum = std::chrono::milliseconds::zero(); ///< Sum of wall-clock times of the evaluations.
+	std::vector<double> imageTimes; ///< Detection time of each image in milliseconds.
 };
 
 #endif /* DETECTORTESTER_HPP_ */
@@ -42,7 +42,6 @@ DetectorTrainer::DetectorTrainer(bool printProgressInformation, std::string prin
 		printPrefix(printPrefix),
 		aspectRatio(1),
 		aspectRatioInv(1),
-		noSuppression(make_shared<NonMaximumSuppression>(1.0)),
 		generator(std::random_device()()) {}
 
 shared_ptr<AggregatedFeaturesDetector> DetectorTrainer::getDetector(shared_ptr<NonMaximumSuppression> nms) const {
@@ -100,12 +99,15 @@ void DetectorTrainer::setFeatures(FeatureParams params, const shared_ptr<ImageFi
 
 void DetectorTrainer::train(vector<LabeledImage> images) {
 	createEmptyClassifier();
+	hardNegativeMiner.reset(new HardNegativeMiner(featureExtractor,
+			trainingParams.featureCaching, trainingParams.featureCacheFilename));
 	collectInitialTrainingExamples(images);
 	trainClassifier();
 	for (int round = 0; round < trainingParams.bootstrappingRounds; ++round) {
-		collectHardTrainingExamples(images);
+		collectHardTrainingExamples();
 		retrainClassifier();
 	}
+	hardNegativeMiner.reset();
 }
 
 void DetectorTrainer::createEmptyClassifier() {
@@ -119,28 +121,22 @@ void DetectorTrainer::createEmptyClassifier() {
 void DetectorTrainer::collectInitialTrainingExamples(vector<LabeledImage> images) {
 	if (printProgressInformation)
 		std::cout << printPrefix << "collecting initial training examples" << std::endl;
-	collectTrainingExamples(images, true);
+	collectTrainingExamples(images);
 }
 
-void DetectorTrainer::collectHardTrainingExamples(vector<LabeledImage> images) {
+void DetectorTrainer::collectHardTrainingExamples() {
 	if (printProgressInformation)
 		std::cout << printPrefix << "collecting additional hard negative training examples" << std::endl;
-	createHardNegativesDetector();
-	collectTrainingExamples(images, false);
+	negativeTrainingExamples = hardNegativeMiner->mine(*classifier->getSvm(), trainingParams.negativeScoreThreshold,
+			trainingParams.maxHardNegativesPerImage, trainingParams.overlapThreshold, trainingParams.nmsOverlapThreshold);
 }
 
-void DetectorTrainer::createHardNegativesDetector() {
-	classifier->getSvm()->setThreshold(trainingParams.negativeScoreThreshold);
-	hardNegativesDetector = make_shared<AggregatedFeaturesDetector>(featureExtractor, classifier->getSvm(), noSuppression);
-	classifier->getSvm()->setThreshold(0);
-}
-
-void DetectorTrainer::collectTrainingExamples(vector<LabeledImage> images, bool initial) {
+void DetectorTrainer::collectTrainingExamples(vector<LabeledImage> images) {
 	for (LabeledImage labeledImage : images) {
 		vector<RectLandmark> landmarks = adjustSizes(labeledImage.landmarks);
-		addTrainingExamples(labeledImage.image, landmarks, initial);
+		addTrainingExamples(labeledImage.image, landmarks);
 		if (trainingParams.mirrorTrainingData)
-			addMirroredTrainingExamples(labeledImage.image, landmarks, initial);
+			addMirroredTrainingExamples(labeledImage.image, landmarks);
 	}
 }
 
@@ -165,10 +161,10 @@ RectLandmark DetectorTrainer::adjustSize(const RectLandmark& landmark) const {
 	return RectLandmark(name, x, y, width, height);
 }
 
-void DetectorTrainer::addMirroredTrainingExamples(const Mat& image, const vector<RectLandmark>& landmarks, bool initial) {
+void DetectorTrainer::addMirroredTrainingExamples(const Mat& image, const vector<RectLandmark>& landmarks) {
 	Mat mirroredImage = flipHorizontally(image);
 	vector<RectLandmark> mirroredLandmarks = flipHorizontally(landmarks, image.cols);
-	addTrainingExamples(mirroredImage, mirroredLandmarks, initial);
+	addTrainingExamples(mirroredImage, mirroredLandmarks);
 }
 
 Mat DetectorTrainer::flipHorizontally(const Mat& image) {
@@ -195,18 +191,15 @@ RectLandmark DetectorTrainer::flipHorizontally(const RectLandmark& landmark, int
 	return RectLandmark(name, mirroredX, y, width, height);
 }
 
-void DetectorTrainer::addTrainingExamples(const Mat& image, const vector<RectLandmark>& landmarks, bool initial) {
-	addTrainingExamples(image, Annotations(landmarks), initial);
+void DetectorTrainer::addTrainingExamples(const Mat& image, const vector<RectLandmark>& landmarks) {
+	addTrainingExamples(image, Annotations(landmarks));
 }
 
-void DetectorTrainer::addTrainingExamples(const Mat& image, const Annotations& annotations, bool initial) {
+void DetectorTrainer::addTrainingExamples(const Mat& image, const Annotations& annotations) {
 	setImage(image);
-	if (initial) {
-		addPositiveExamples(annotations.positives);
-		addRandomNegativeExamples(annotations.nonNegatives);
-	} else {
-		addHardNegativeExamples(annotations.nonNegatives);
-	}
+	addPositiveExamples(annotations.positives);
+	addRandomNegativeExamples(annotations.nonNegatives);
+	hardNegativeMiner->addImage(image, annotations.nonNegatives);
 }
 
 void DetectorTrainer::setImage(const Mat& image) {
@@ -243,17 +236,6 @@ Rect DetectorTrainer::createRandomBounds() const {
 	return Rect(x, y, width, height);
 }
 
-void DetectorTrainer::addHardNegativeExamples(const vector<Rect>& nonNegativeBoxes) {
-	vector<Rect> detections = hardNegativesDetector->detect(image);
-	auto detection = detections.begin();
-	int addedCount = 0;
-	while (detection != detections.end() && addedCount < trainingParams.maxHardNegativesPerImage) {
-		if (addNegativeIfNotOverlapping(*detection, nonNegativeBoxes))
-			++addedCount;
-		++detection;
-	}
-}
-
 bool DetectorTrainer::addNegativeIfNotOverlapping(Rect candidate, const vector<Rect>& nonNegativeBoxes) {
 	shared_ptr<Patch> patch = featureExtractor->extract(candidate);
 	if (!patch || isOverlapping(patch->getBounds(), nonNegativeBoxes))
@@ -8,6 +8,7 @@
 #ifndef DETECTORTRAINER_HPP_
 #define DETECTORTRAINER_HPP_
 
+#include "HardNegativeMiner.hpp"
 #include "LabeledImage.hpp"
 #include "classification/ConfidenceBasedExampleManagement.hpp"
 #include "detection/AggregatedFeaturesDetector.hpp"
@@ -75,9 +76,12 @@ struct TrainingParams {
 	int bootstrappingRounds = 3; ///< Number of bootstrapping rounds.
 	float negativeScoreThreshold = -1.0f; ///< SVM score threshold for retrieving strong negative examples.
 	double overlapThreshold = 0.3; ///< Maximum allowed overlap between negative examples and non-negative annotations.
+	double nmsOverlapThreshold = 1.0; ///< Maximum allowed overlap between hard negatives of the same image (1 disables the suppression, otherwise it should match the detector's).
 	double C = 1;
 	bool compensateImbalance = false; ///< Flag that indicates whether to adjust class weights to compensate for unbalanced data.
 	bool probabilistic = false; ///< Flag that indicates whether to compute logistic function parameters for probabilistic output.
+	FeatureCaching featureCaching = FeatureCaching::MEMORY; ///< Storage of the feature pyramids between bootstrapping rounds.
+	std::string featureCacheFilename = "featurecache"; ///< Name of the file the feature pyramids are spilled into (only used with FeatureCaching::FILE).
 };
 
 /**
@@ -162,11 +166,9 @@ private:
 
 	void collectInitialTrainingExamples(std::vector<LabeledImage> images);
 
-	void collectHardTrainingExamples(std::vector<LabeledImage> images);
+	void collectHardTrainingExamples();
 
-	void createHardNegativesDetector();
-
-	void collectTrainingExamples(std::vector<LabeledImage> images, bool initial);
+	void collectTrainingExamples(std::vector<LabeledImage> images);
 
 	/**
 	 * Adjusts the size and aspect ratio of the landmarks to fit the feature window size.
@@ -184,7 +186,7 @@ private:
 	 */
 	imageio::RectLandmark adjustSize(const imageio::RectLandmark& landmark) const;
 
-	void addMirroredTrainingExamples(const cv::Mat& image, const std::vector<imageio::RectLandmark>& landmarks, bool initial);
+	void addMirroredTrainingExamples(const cv::Mat& image, const std::vector<imageio::RectLandmark>& landmarks);
 
 	cv::Mat flipHorizontally(const cv::Mat& image);
 
@@ -192,9 +194,9 @@ private:
 
 	imageio::RectLandmark flipHorizontally(const imageio::RectLandmark& landmark, int imageWidth);
 
-	void addTrainingExamples(const cv::Mat& image, const std::vector<imageio::RectLandmark>& landmarks, bool initial);
+	void addTrainingExamples(const cv::Mat& image, const std::vector<imageio::RectLandmark>& landmarks);
 
-	void addTrainingExamples(const cv::Mat& image, const Annotations& annotations, bool initial);
+	void addTrainingExamples(const cv::Mat& image, const Annotations& annotations);
 
 	void setImage(const cv::Mat& image);
 
@@ -204,8 +206,6 @@ private:
 
 	cv::Rect createRandomBounds() const;
 
-	void addHardNegativeExamples(const std::vector<cv::Rect>& nonNegativeBoxes);
-
 	bool addNegativeIfNotOverlapping(cv::Rect candidate, const std::vector<cv::Rect>& nonNegativeBoxes);
 
 	bool isOverlapping(cv::Rect boxToTest, const std::vector<cv::Rect>& otherBoxes) const;
@@ -221,7 +221,6 @@ private:
 	bool printProgressInformation;
 	std::string printPrefix;
 	TrainingParams trainingParams;
-	std::shared_ptr<detection::NonMaximumSuppression> noSuppression;
 	FeatureParams featureParams;
 	double aspectRatio;
 	double aspectRatioInv;
@@ -229,7 +228,7 @@ private:
 	std::shared_ptr<imageprocessing::ImageFilter> filter;
 	std::shared_ptr<imageprocessing::extraction::AggregatedFeaturesExtractor> featureExtractor;
 	std::shared_ptr<libsvm::LibSvmClassifier> classifier;
-	std::shared_ptr<detection::AggregatedFeaturesDetector> hardNegativesDetector;
+	std::unique_ptr<HardNegativeMiner> hardNegativeMiner;
 	std::vector<cv::Mat> positiveTrainingExamples;
 	std::vector<cv::Mat> negativeTrainingExamples;
 	cv::Mat image;
@@ -17,6 +17,9 @@
 #include "imageprocessing/ChainedFilter.hpp"
 #include "imageprocessing/GrayscaleFilter.hpp"
 #include "imageprocessing/ImagePyramid.hpp"
+#include "imageprocessing/ImagePyramidLayer.hpp"
+#include "imageprocessing/LambdaEstimator.hpp"
+#include "imageprocessing/LambdaStore.hpp"
 #include "imageprocessing/extraction/AggregatedFeaturesExtractor.hpp"
 #include "imageprocessing/filtering/AggregationFilter.hpp"
 #include "imageprocessing/filtering/FhogAggregationFilter.hpp"
@@ -25,6 +28,8 @@
 #include "imageprocessing/filtering/GradientFilter.hpp"
 #include "imageprocessing/filtering/GradientHistogramFilter.hpp"
 #include "opencv2/highgui/highgui.hpp"
+#include <algorithm>
+#include <cctype>
 #include <chrono>
 #include <fstream>
 #include <iostream>
@@ -43,6 +48,7 @@ using cv::Size;
 using classification::SvmClassifier;
 using detection::AggregatedFeaturesDetector;
 using detection::NonMaximumSuppression;
+using detection::SimpleDetector;
 using imageio::DlibImageSource;
 using imageio::LabeledImageSource;
 using imageio::Landmark;
@@ -50,6 +56,8 @@ using imageprocessing::ChainedFilter;
 using imageprocessing::GrayscaleFilter;
 using imageprocessing::ImageFilter;
 using imageprocessing::ImagePyramid;
+using imageprocessing::LambdaEstimator;
+using imageprocessing::LambdaStore;
 using imageprocessing::extraction::AggregatedFeaturesExtractor;
 using imageprocessing::filtering::AggregationFilter;
 using imageprocessing::filtering::FhogAggregationFilter;
@@ -58,6 +66,7 @@ using imageprocessing::filtering::FpdwFeaturesFilter;
 using imageprocessing::filtering::GradientFilter;
 using imageprocessing::filtering::GradientHistogramFilter;
 using std::cerr;
+using std::chrono::duration;
 using std::chrono::duration_cast;
 using std::chrono::seconds;
 using std::chrono::steady_clock;
@@ -65,11 +74,12 @@ using std::cout;
 using std::endl;
 using std::invalid_argument;
 using std::make_shared;
+using std::pair;
 using std::shared_ptr;
 using std::string;
 using std::vector;
 
-enum class TaskType { TRAIN, TEST, SHOW };
+enum class TaskType { TRAIN, TEST, SHOW, BENCHMARK, CALIBRATE };
 
 class Features {
 public:
@@ -120,6 +130,7 @@ struct DetectionParams {
 	int octaveLayerCount; ///< Number of image pyramid layers per octave.
 	bool approximatePyramid; ///< Flag that indicates whether to approximate all but one image pyramid layer per octave.
 	double nmsOverlapThreshold; ///< Maximum allowed overlap between two detections.
+	ImagePyramid::Scaling pyramidScaling; ///< Strategy for computing the scaled images of the pyramid layers.
 };
 
 vector<LabeledImage> getLabeledImages(shared_ptr<LabeledImageSource> source, FeatureParams featureParams) {
@@ -155,14 +166,18 @@ shared_ptr<AggregatedFeaturesDetector> createDetector(
 		const shared_ptr<SvmClassifier>& svm, const Features& features, DetectionParams detectionParams) {
 	shared_ptr<NonMaximumSuppression> nms = make_shared<NonMaximumSuppression>(
 			detectionParams.nmsOverlapThreshold, NonMaximumSuppression::MaximumType::MAX_SCORE);
+	shared_ptr<AggregatedFeaturesExtractor> extractor;
 	if (features.hasImageFilter())
-		return make_shared<AggregatedFeaturesDetector>(features.createImageFilter(), features.createLayerFilter(),
-				features.params.cellSizeInPixels, features.params.windowSizeInCells, detectionParams.octaveLayerCount, svm, nms,
-				features.params.widthScaleFactorInv(), features.params.heightScaleFactorInv(), detectionParams.minWindowSizeInPixels.width);
+		extractor = make_shared<AggregatedFeaturesExtractor>(features.createImageFilter(), features.createLayerFilter(),
+				features.params.windowSizeInCells, features.params.cellSizeInPixels, detectionParams.octaveLayerCount,
+				detectionParams.minWindowSizeInPixels.width);
 	else
-		return make_shared<AggregatedFeaturesDetector>(features.createLayerFilter(),
-				features.params.cellSizeInPixels, features.params.windowSizeInCells, detectionParams.octaveLayerCount, svm, nms,
-				features.params.widthScaleFactorInv(), features.params.heightScaleFactorInv(), detectionParams.minWindowSizeInPixels.width);
+		extractor = make_shared<AggregatedFeaturesExtractor>(features.createLayerFilter(),
+				features.params.windowSizeInCells, features.params.cellSizeInPixels, detectionParams.octaveLayerCount,
+				detectionParams.minWindowSizeInPixels.width);
+	extractor->getFeaturePyramid()->setScaling(detectionParams.pyramidScaling);
+	return make_shared<AggregatedFeaturesDetector>(extractor, svm, nms,
+			features.params.widthScaleFactorInv(), features.params.heightScaleFactorInv());
 }
 
 shared_ptr<AggregatedFeaturesDetector> createApproximateDetector(
@@ -171,6 +186,7 @@ shared_ptr<AggregatedFeaturesDetector> createApproximateDetector(
 	if (features.hasImageFilter())
 		featurePyramid->addImageFilter(features.createImageFilter());
 	featurePyramid->addLayerFilter(features.createLayerFilter());
+	featurePyramid->setScaling(detectionParams.pyramidScaling);
 	auto extractor = make_shared<AggregatedFeaturesExtractor>(featurePyramid, features.params.windowSizeInCells,
 			features.params.cellSizeInPixels, true, detectionParams.minWindowSizeInPixels.width);
 	shared_ptr<NonMaximumSuppression> nms = make_shared<NonMaximumSuppression>(
@@ -190,6 +206,17 @@ shared_ptr<AggregatedFeaturesDetector> loadDetector(
 	return createDetector(svm, features, detectionParams);
 }
 
+vector<shared_ptr<SimpleDetector>> loadDetectors(
+		const string& filename, const Features& features, DetectionParams detectionParams, float threshold = 0) {
+	// one detector per evaluation thread, loaded up-front as detectors are not thread-safe
+	int count = std::max(1, cv::getNumThreads());
+	vector<shared_ptr<SimpleDetector>> detectors;
+	detectors.reserve(count);
+	for (int i = 0; i < count; ++i)
+		detectors.push_back(loadDetector(filename, features, detectionParams, threshold));
+	return detectors;
+}
+
 void setFeatures(DetectorTrainer& detectorTrainer, const Features& features) {
 	if (features.hasImageFilter())
 		detectorTrainer.setFeatures(features.params, features.createLayerFilter(), features.createImageFilter());
@@ -223,6 +250,62 @@ bool showDetections(const DetectorTester& tester, AggregatedFeaturesDetector& de
 	return true;
 }
 
+/**
+ * Measures the time it takes to create the image pyramids of the detection with each scaling strategy and compares
+ * the scaled images of their layers with those of the original strategy (RESIZE_FIRST). The layer filter is not
+ * applied, as its effort does not depend on the scaling strategy.
+ */
+void benchmarkPyramids(const Features& features, DetectionParams detectionParams, const vector<LabeledImage>& images) {
+	vector<pair<string, ImagePyramid::Scaling>> scalings = {
+			{ "resize first", ImagePyramid::Scaling::RESIZE_FIRST },
+			{ "halve first", ImagePyramid::Scaling::HALVE_FIRST },
+			{ "area", ImagePyramid::Scaling::AREA }
+	};
+	vector<shared_ptr<ImagePyramid>> pyramids;
+	vector<shared_ptr<AggregatedFeaturesExtractor>> extractors;
+	for (const pair<string, ImagePyramid::Scaling>& scaling : scalings) {
+		auto pyramid = make_shared<ImagePyramid>(static_cast<size_t>(detectionParams.octaveLayerCount), 0.5, 1);
+		if (features.hasImageFilter())
+			pyramid->addImageFilter(features.createImageFilter());
+		pyramid->setScaling(scaling.second);
+		// the extractor adjusts the minimum and maximum scale factor of the pyramid just like the detector does
+		extractors.push_back(make_shared<AggregatedFeaturesExtractor>(pyramid, features.params.windowSizeInCells,
+				features.params.cellSizeInPixels, true, detectionParams.minWindowSizeInPixels.width));
+		pyramids.push_back(pyramid);
+	}
+	vector<double> times(scalings.size(), 0);
+	vector<double> differenceSums(scalings.size(), 0);
+	vector<int> layerCounts(scalings.size(), 0);
+	for (const LabeledImage& image : images) {
+		for (size_t i = 0; i < scalings.size(); ++i) {
+			steady_clock::time_point start = steady_clock::now();
+			extractors[i]->update(image.image);
+			steady_clock::time_point end = steady_clock::now();
+			times[i] += duration_cast<duration<double, std::milli>>(end - start).count();
+		}
+		for (size_t i = 0; i < scalings.size(); ++i) {
+			for (const shared_ptr<ImagePyramidLayer>& layer : pyramids[i]->getLayers()) {
+				shared_ptr<ImagePyramidLayer> referenceLayer = pyramids[0]->getLayer(layer->getIndex());
+				if (!referenceLayer)
+					continue;
+				// sizes might differ by a pixel due to rounding, so only the common area is compared
+				const Mat& scaledImage = layer->getScaledImage();
+				const Mat& referenceImage = referenceLayer->getScaledImage();
+				Rect commonArea(0, 0, std::min(scaledImage.cols, referenceImage.cols), std::min(scaledImage.rows, referenceImage.rows));
+				double difference = cv::norm(scaledImage(commonArea), referenceImage(commonArea), cv::NORM_L1);
+				differenceSums[i] += difference / (commonArea.area() * scaledImage.channels());
+				++layerCounts[i];
+			}
+		}
+	}
+	cout << "=== Pyramid benchmark on " << images.size() << " images ===" << endl;
+	for (size_t i = 0; i < scalings.size(); ++i) {
+		cout << scalings[i].first << ": " << (times[i] / images.size()) << " ms per image, "
+				<< (layerCounts[i] / images.size()) << " layers per image, mean absolute difference to "
+				<< scalings[0].first << ": " << (layerCounts[i] > 0 ? differenceSums[i] / layerCounts[i] : 0) << endl;
+	}
+}
+
 TaskType getTaskType(const string& type) {
 	if (type == "train")
 		return TaskType::TRAIN;
@@ -230,7 +313,11 @@ TaskType getTaskType(const string& type) {
 		return TaskType::TEST;
 	if (type == "show")
 		return TaskType::SHOW;
-	throw invalid_argument("expected train/test/show, but was '" + (string)type + "'");
+	if (type == "benchmark")
+		return TaskType::BENCHMARK;
+	if (type == "calibrate")
+		return TaskType::CALIBRATE;
+	throw invalid_argument("expected train/test/show/benchmark/calibrate, but was '" + (string)type + "'");
 }
 
 FeatureParams getFeatureParams(const ptree& config) {
@@ -244,6 +331,30 @@ FeatureParams getFeatureParams(const ptree& config) {
 	return parameters;
 }
 
+void collectConfigEntries(const ptree& config, const string& prefix, vector<string>& entries) {
+	for (const ptree::value_type& child : config) {
+		string name = prefix + child.first;
+		if (child.second.empty()) {
+			string value = child.second.data();
+			std::replace_if(value.begin(), value.end(), [](char c) { return std::isspace(static_cast<unsigned char>(c)); }, '_');
+			entries.push_back(name + "=" + value);
+		} else {
+			collectConfigEntries(child.second, name + ".", entries);
+		}
+	}
+}
+
+string getLambdaKey(const ptree& featureConfig) {
+	// every feature parameter might change the channels, so the key consists of the whole (sorted) configuration
+	vector<string> entries;
+	collectConfigEntries(featureConfig, "", entries);
+	std::sort(entries.begin(), entries.end());
+	string key;
+	for (const string& entry : entries)
+		key += (key.empty() ? "" : ";") + entry;
+	return key;
+}
+
 shared_ptr<Features> getFeatures(const ptree& config) {
 	FeatureParams featureParams = getFeatureParams(config);
 	string type = config.get<string>("type");
@@ -257,6 +368,26 @@ shared_ptr<Features> getFeatures(const ptree& config) {
 	}
 }
 
+FeatureCaching getFeatureCaching(const string& caching) {
+	if (caching == "none")
+		return FeatureCaching::NONE;
+	if (caching == "memory")
+		return FeatureCaching::MEMORY;
+	if (caching == "file")
+		return FeatureCaching::FILE;
+	throw invalid_argument("expected none/memory/file, but was '" + caching + "'");
+}
+
+ImagePyramid::Scaling getPyramidScaling(const string& scaling) {
+	if (scaling == "resize")
+		return ImagePyramid::Scaling::RESIZE_FIRST;
+	if (scaling == "halve")
+		return ImagePyramid::Scaling::HALVE_FIRST;
+	if (scaling == "area")
+		return ImagePyramid::Scaling::AREA;
+	throw invalid_argument("expected resize/halve/area, but was '" + scaling + "'");
+}
+
 TrainingParams getTrainingParams(const ptree& config) {
 	TrainingParams parameters;
 	parameters.mirrorTrainingData = config.get<bool>("mirrorTrainingData");
@@ -266,9 +397,11 @@ TrainingParams getTrainingParams(const ptree& config) {
 	parameters.bootstrappingRounds = config.get<int>("bootstrappingRounds");
 	parameters.negativeScoreThreshold = config.get<float>("negativeScoreThreshold");
 	parameters.overlapThreshold = config.get<double>("overlapThreshold");
+	parameters.nmsOverlapThreshold = config.get<double>("nmsOverlapThreshold", parameters.nmsOverlapThreshold);
 	parameters.C = config.get<double>("C");
 	parameters.compensateImbalance = config.get<bool>("compensateImbalance");
 	parameters.probabilistic = config.get<bool>("probabilistic");
+	parameters.featureCaching = getFeatureCaching(config.get<string>("featureCaching", "memory"));
 	return parameters;
 }
 
@@ -279,6 +412,7 @@ DetectionParams getDetectionParams(const ptree& config) {
 	parameters.octaveLayerCount = config.get<int>("octaveLayerCount");
 	parameters.approximatePyramid = config.get<bool>("approximatePyramid");
 	parameters.nmsOverlapThreshold = config.get<double>("nmsOverlapThreshold");
+	parameters.pyramidScaling = getPyramidScaling(config.get<string>("pyramidScaling", "resize"));
 	return parameters;
 }
 
@@ -288,6 +422,8 @@ void printUsageInformation(string applicationName) {
 	cout << "  train: train detector(s)" << endl;
 	cout << "  test: test detector(s)" << endl;
 	cout << "  show: show detection results of detector(s)" << endl;
+	cout << "  benchmark: compare the time and results of creating image pyramids with different scaling strategies" << endl;
+	cout << "  calibrate: estimate the lambdas of the features for approximated image pyramids (setcount is ignored)" << endl;
 	cout << "directory: directory to create or use for loading and storing SVM and evaluation data" << endl;
 	cout << "images: DLib XML file of annotated images" << endl;
 	cout << "setcount: number of subsets for cross-validation (1 to use all images at once)" << endl;
@@ -297,6 +433,8 @@ void printUsageInformation(string applicationName) {
 	cout << "    trainingconfig: configuration file containing training parameters" << endl;
 	cout << "  test: detectionconfig" << endl;
 	cout << "  show: detectionconfig [threshold]" << endl;
+	cout << "  benchmark: detectionconfig" << endl;
+	cout << "  calibrate: none (lambdas are stored in the directory and used by test and show if approximatePyramid is set)" << endl;
 	cout << "    detectionconfig: configuration file containing detection parameters" << endl;
 	cout << "    threshold: SVM score threshold (optional, defaults to 0.0)" << endl;
 	cout << endl;
@@ -305,6 +443,8 @@ void printUsageInformation(string applicationName) {
 	cout << "Train single detector in existing directory, re-using configs: " << endl << "  " << applicationName << " train mydetector images.xml 1" << endl;
 	cout << "Evaluate detectors using cross-validation: " << endl << "  " << applicationName << " test mydetector images.xml 4 detectorconfig" << endl;
 	cout << "Show detections using cross-validation: " << endl << "  " << applicationName << " show mydetector images.xml 4 detectorconfig 0.5" << endl;
+	cout << "Compare image pyramid scaling strategies: " << endl << "  " << applicationName << " benchmark mydetector images.xml 1 detectorconfig" << endl;
+	cout << "Estimate lambdas for approximated image pyramids: " << endl << "  " << applicationName << " calibrate mydetector images.xml 1" << endl;
 }
 
 int main(int argc, char** argv) {
@@ -347,8 +487,9 @@ int main(int argc, char** argv) {
 			return 0;
 		}
 	} else {
-		if ((taskType == TaskType::TEST && argc != 6)
-				|| (taskType == TaskType::SHOW && argc < 6)) {
+		if (((taskType == TaskType::TEST || taskType == TaskType::BENCHMARK) && argc != 6)
+				|| (taskType == TaskType::SHOW && argc < 6)
+				|| (taskType == TaskType::CALIBRATE && argc != 5)) {
 			printUsageInformation(argv[0]);
 			return 0;
 		}
@@ -358,13 +499,22 @@ int main(int argc, char** argv) {
 		}
 		read_info((directory / "featureparams").string(), featureConfig);
 		read_info((directory / "trainingparams").string(), trainingConfig);
-		read_info(argv[5], detectionConfig);
+		if (taskType != TaskType::CALIBRATE)
+			read_info(argv[5], detectionConfig);
 	}
 	shared_ptr<Features> features = getFeatures(featureConfig);
+	path lambdaFile = directory / "lambdas";
+	string lambdaKey = getLambdaKey(featureConfig);
+	if (taskType != TaskType::CALIBRATE && exists(lambdaFile)) {
+		features->lambdas = LambdaStore(lambdaFile.string()).get(lambdaKey);
+		if (!features->lambdas.empty())
+			cout << "using lambdas of '" << lambdaKey << "' from " << lambdaFile.string() << endl;
+	}
 	vector<LabeledImage> imageSet = getLabeledImages(imageSource, features->params);
 
 	if (taskType == TaskType::TRAIN) {
 		TrainingParams trainingParams = getTrainingParams(trainingConfig);
+		trainingParams.featureCacheFilename = (directory / "featurecache").string();
 		DetectorTrainer detectorTrainer(true, "  ");
 		detectorTrainer.setTrainingParameters(trainingParams);
 		setFeatures(detectorTrainer, *features);
@@ -430,17 +580,13 @@ int main(int argc, char** argv) {
 		} else {
 			if (setCount == 1) { // no cross-validation, test on all images at once
 				path svmFile = directory / "svm";
-				shared_ptr<AggregatedFeaturesDetector> detector = loadDetector(
-						svmFile.string(), *features, detectionParams, -1.0f);
-				tester.evaluate(*detector, imageSet);
+				tester.evaluate(loadDetectors(svmFile.string(), *features, detectionParams, -1.0f), imageSet);
 			} else { // cross-validation, test on subsets
 				vector<vector<LabeledImage>> subsets = getSubsets(imageSet, setCount);
 				for (int testSetIndex = 0; testSetIndex < subsets.size(); ++testSetIndex) {
 					cout << "testing on subset " << (testSetIndex + 1) << endl;
 					path svmFile = directory / ("svm" + std::to_string(testSetIndex + 1));
-					shared_ptr<AggregatedFeaturesDetector> detector = loadDetector(
-							svmFile.string(), *features, detectionParams, -1.0f);
-					tester.evaluate(*detector, subsets[testSetIndex]);
+					tester.evaluate(loadDetectors(svmFile.string(), *features, detectionParams, -1.0f), subsets[testSetIndex]);
 				}
 			}
 			tester.storeData(evaluationDataFile.string());
@@ -475,6 +621,23 @@ int main(int argc, char** argv) {
 			}
 		}
 	}
+	else if (taskType == TaskType::BENCHMARK) {
+		DetectionParams detectionParams = getDetectionParams(detectionConfig);
+		benchmarkPyramids(*features, detectionParams, imageSet);
+	}
+	else if (taskType == TaskType::CALIBRATE) {
+		shared_ptr<ImageFilter> imageFilter = features->hasImageFilter() ? features->createImageFilter() : shared_ptr<ImageFilter>();
+		LambdaEstimator estimator(features->createLayerFilter(), imageFilter);
+		cout << "estimate lambdas of '" << lambdaKey << "' on " << imageSet.size() << " images" << endl;
+		for (const LabeledImage& image : imageSet)
+			estimator.add(image.image);
+		LambdaStore lambdaStore;
+		if (exists(lambdaFile))
+			lambdaStore.load(lambdaFile.string());
+		lambdaStore.set(lambdaKey, estimator.getLambdas());
+		lambdaStore.store(lambdaFile.string());
+		cout << "stored lambdas in " << lambdaFile.string() << endl;
+	}
 
 	return 0;
 }
@@ -0,0 +1,242 @@
+/*
+ * HardNegativeMiner.cpp
+ *
+ *  Created on: 18.10.2026
+ *      Author: poschmann
+ */
+
+#include "HardNegativeMiner.hpp"
+#include "classification/LinearKernel.hpp"
+#include "imageprocessing/ImagePyramid.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <iterator>
+#include <stdexcept>
+
+using classification::LinearKernel;
+using classification::SvmClassifier;
+using cv::Mat;
+using cv::Point;
+using cv::Rect;
+using imageprocessing::ImagePyramidLayer;
+using imageprocessing::extraction::AggregatedFeaturesExtractor;
+using std::invalid_argument;
+using std::make_shared;
+using std::runtime_error;
+using std::shared_ptr;
+using std::string;
+using std::vector;
+
+class HardNegativeMiner::MiningBody : public cv::ParallelLoopBody {
+public:
+
+	MiningBody(const HardNegativeMiner& miner, vector<vector<Mat>>& negativesPerImage) :
+			miner(miner), negativesPerImage(negativesPerImage) {}
+
+	void operator()(const cv::Range& range) const override {
+		std::ifstream cacheFile;
+		if (miner.caching == FeatureCaching::FILE)
+			cacheFile.open(miner.cacheFilename, std::ios::binary);
+		for (int i = range.start; i < range.end; ++i) {
+			const MiningImage& image = miner.images[i];
+			if (miner.caching == FeatureCaching::FILE) {
+				cacheFile.seekg(image.fileOffset);
+				negativesPerImage[i] = miner.mine(image, readLayers(cacheFile));
+			} else {
+				negativesPerImage[i] = miner.mine(image, image.layers);
+			}
+		}
+	}
+
+private:
+
+	const HardNegativeMiner& miner;
+	vector<vector<Mat>>& negativesPerImage;
+};
+
+HardNegativeMiner::HardNegativeMiner(shared_ptr<AggregatedFeaturesExtractor> featureExtractor,
+		FeatureCaching caching, string cacheFilename) :
+				featureExtractor(featureExtractor),
+				caching(caching),
+				cacheFilename(cacheFilename),
+				cacheFile(),
+				images(),
+				scoreFilter(CV_32F),
+				kernelSize(),
+				scoreThreshold(0),
+				maxNegativesPerImage(0),
+				overlapThreshold(0),
+				nmsOverlapThreshold(1) {
+	if (caching == FeatureCaching::FILE && cacheFilename.empty())
+		throw invalid_argument("HardNegativeMiner: the cache file name must not be empty when spilling features into a file");
+	scoreFilter.setAnchor(Point(0, 0));
+}
+
+HardNegativeMiner::~HardNegativeMiner() {
+	clear();
+}
+
+size_t HardNegativeMiner::getImageCount() const {
+	return images.size();
+}
+
+void HardNegativeMiner::clear() {
+	images.clear();
+	if (cacheFile.is_open()) {
+		cacheFile.close();
+		std::remove(cacheFilename.c_str());
+	}
+}
+
+void HardNegativeMiner::addImage(const Mat& image, const vector<Rect>& nonNegativeBoxes) {
+	MiningImage miningImage;
+	miningImage.fileOffset = 0;
+	miningImage.nonNegativeBoxes = nonNegativeBoxes;
+	if (caching == FeatureCaching::NONE) {
+		miningImage.image = image;
+	} else if (caching == FeatureCaching::MEMORY) {
+		miningImage.layers = featureExtractor->getFeaturePyramid()->getLayers();
+	} else { // caching == FeatureCaching::FILE
+		if (!cacheFile.is_open()) {
+			cacheFile.open(cacheFilename, std::ios::binary | std::ios::trunc);
+			if (!cacheFile)
+				throw runtime_error("HardNegativeMiner: could not open cache file '" + cacheFilename + "'");
+		}
+		miningImage.fileOffset = cacheFile.tellp();
+		writeLayers(featureExtractor->getFeaturePyramid()->getLayers());
+		if (!cacheFile)
+			throw runtime_error("HardNegativeMiner: could not write to cache file '" + cacheFilename + "'");
+	}
+	images.push_back(std::move(miningImage));
+}
+
+void HardNegativeMiner::writeLayers(const vector<shared_ptr<ImagePyramidLayer>>& layers) {
+	int layerCount = static_cast<int>(layers.size());
+	cacheFile.write(reinterpret_cast<const char*>(&layerCount), sizeof(layerCount));
+	for (const shared_ptr<ImagePyramidLayer>& layer : layers) {
+		int index = layer->getIndex();
+		double scale = layer->getScaleFactor();
+		double scaleX = layer->getScaledX(1.0);
+		double scaleY = layer->getScaledY(1.0);
+		const Mat& image = layer->getScaledImage();
+		int header[] = { image.rows, image.cols, image.type() };
+		cacheFile.write(reinterpret_cast<const char*>(&index), sizeof(index));
+		cacheFile.write(reinterpret_cast<const char*>(&scale), sizeof(scale));
+		cacheFile.write(reinterpret_cast<const char*>(&scaleX), sizeof(scaleX));
+		cacheFile.write(reinterpret_cast<const char*>(&scaleY), sizeof(scaleY));
+		cacheFile.write(reinterpret_cast<const char*>(header), sizeof(header));
+		size_t rowSize = image.cols * image.elemSize();
+		for (int row = 0; row < image.rows; ++row)
+			cacheFile.write(image.ptr<char>(row), rowSize);
+	}
+}
+
+vector<shared_ptr<ImagePyramidLayer>> HardNegativeMiner::readLayers(std::istream& stream) {
+	int layerCount = 0;
+	stream.read(reinterpret_cast<char*>(&layerCount), sizeof(layerCount));
+	vector<shared_ptr<ImagePyramidLayer>> layers;
+	layers.reserve(layerCount);
+	for (int i = 0; i < layerCount && stream; ++i) {
+		int index;
+		double scale, scaleX, scaleY;
+		int header[3];
+		stream.read(reinterpret_cast<char*>(&index), sizeof(index));
+		stream.read(reinterpret_cast<char*>(&scale), sizeof(scale));
+		stream.read(reinterpret_cast<char*>(&scaleX), sizeof(scaleX));
+		stream.read(reinterpret_cast<char*>(&scaleY), sizeof(scaleY));
+		stream.read(reinterpret_cast<char*>(header), sizeof(header));
+		Mat image(header[0], header[1], header[2]);
+		stream.read(reinterpret_cast<char*>(image.data), image.total() * image.elemSize());
+		layers.push_back(make_shared<ImagePyramidLayer>(index, scale, scaleX, scaleY, image));
+	}
+	return layers;
+}
+
+vector<Mat> HardNegativeMiner::mine(const SvmClassifier& svm,
+		float scoreThreshold, int maxNegativesPerImage, double overlapThreshold, double nmsOverlapThreshold) {
+	if (!dynamic_cast<LinearKernel*>(svm.getKernel().get()))
+		throw invalid_argument("HardNegativeMiner: the SVM must use a LinearKernel");
+	const Mat& weightVector = svm.getSupportVectors().front();
+	scoreFilter.setKernel(weightVector);
+	scoreFilter.setDelta(-svm.getBias());
+	kernelSize = weightVector.size();
+	this->scoreThreshold = scoreThreshold;
+	this->maxNegativesPerImage = maxNegativesPerImage;
+	this->overlapThreshold = overlapThreshold;
+	this->nmsOverlapThreshold = nmsOverlapThreshold;
+	vector<vector<Mat>> negativesPerImage(images.size());
+	if (caching == FeatureCaching::NONE) { // feature extractor is not thread-safe, so the images are processed sequentially
+		for (size_t i = 0; i < images.size(); ++i) {
+			featureExtractor->update(images[i].image);
+			negativesPerImage[i] = mine(images[i], featureExtractor->getFeaturePyramid()->getLayers());
+		}
+	} else {
+		if (cacheFile.is_open())
+			cacheFile.flush();
+		cv::parallel_for_(cv::Range(0, static_cast<int>(images.size())), MiningBody(*this, negativesPerImage));
+	}
+	vector<Mat> negatives;
+	for (vector<Mat>& imageNegatives : negativesPerImage)
+		std::move(imageNegatives.begin(), imageNegatives.end(), std::back_inserter(negatives));
+	return negatives;
+}
+
+vector<Mat> HardNegativeMiner::mine(const MiningImage& image, const vector<shared_ptr<ImagePyramidLayer>>& layers) const {
+	vector<Candidate> candidates;
+	Mat scoreMap;
+	for (size_t layerIndex = 0; layerIndex < layers.size(); ++layerIndex) {
+		const ImagePyramidLayer& layer = *layers[layerIndex];
+		scoreFilter.applyTo(layer.getScaledImage(), scoreMap);
+		int validHeight = scoreMap.rows - kernelSize.height + 1;
+		int validWidth = scoreMap.cols - kernelSize.width + 1;
+		for (int y = 0; y < validHeight; ++y) {
+			const float* scores = scoreMap.ptr<float>(y);
+			for (int x = 0; x < validWidth; ++x) {
+				if (scores[x] > scoreThreshold) {
+					Rect boundsInLayerCells(Point(x, y), kernelSize);
+					Rect boundsInImagePixels = featureExtractor->computeBoundsInImagePixels(boundsInLayerCells, layer);
+					if (!isOverlapping(boundsInImagePixels, image.nonNegativeBoxes, overlapThreshold))
+						candidates.push_back({scores[x], layerIndex, boundsInLayerCells, boundsInImagePixels});
+				}
+			}
+		}
+	}
+	size_t count = static_cast<size_t>(std::max(0, maxNegativesPerImage));
+	bool suppression = nmsOverlapThreshold < 1;
+	auto isStronger = [](const Candidate& a, const Candidate& b) {
+		return a.score > b.score;
+	};
+	if (suppression) // the number of candidates that remain after the suppression is not known in advance
+		std::sort(candidates.begin(), candidates.end(), isStronger);
+	else
+		std::partial_sort(candidates.begin(), candidates.begin() + std::min(count, candidates.size()), candidates.end(), isStronger);
+	vector<Rect> keptBounds;
+	vector<Mat> negatives;
+	for (const Candidate& candidate : candidates) {
+		if (negatives.size() >= count)
+			break;
+		if (suppression) {
+			if (isOverlapping(candidate.boundsInImagePixels, keptBounds, nmsOverlapThreshold))
+				continue;
+			keptBounds.push_back(candidate.boundsInImagePixels);
+		}
+		const Mat& layerCellImage = layers[candidate.layerIndex]->getScaledImage();
+		negatives.push_back(Mat(layerCellImage, candidate.boundsInLayerCells).clone());
+	}
+	return negatives;
+}
+
+bool HardNegativeMiner::isOverlapping(Rect boxToTest, const vector<Rect>& otherBoxes, double threshold) const {
+	for (Rect otherBox : otherBoxes) {
+		if (computeOverlap(boxToTest, otherBox) > threshold) {
+			return true;
+		}
+	}
+	return false;
+}
+
+double HardNegativeMiner::computeOverlap(Rect a, Rect b) const {
+	double intersectionArea = (a & b).area();
+	double unionArea = a.area() + b.area() - intersectionArea;
+	return intersectionArea / unionArea;
+}
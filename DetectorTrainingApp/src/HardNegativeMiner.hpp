@@ -0,0 +1,140 @@
+/*
+ * HardNegativeMiner.hpp
+ *
+ *  Created on: 18.10.2026
+ *      Author: poschmann
+ */
+
+#ifndef HARDNEGATIVEMINER_HPP_
+#define HARDNEGATIVEMINER_HPP_
+
+#include "classification/SvmClassifier.hpp"
+#include "imageprocessing/ConvolutionFilter.hpp"
+#include "imageprocessing/ImagePyramidLayer.hpp"
+#include "imageprocessing/extraction/AggregatedFeaturesExtractor.hpp"
+#include "opencv2/core/core.hpp"
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * Storage of the feature pyramids between bootstrapping rounds.
+ */
+enum class FeatureCaching {
+	NONE, ///< Feature pyramids are re-computed in each round (only the images are kept).
+	MEMORY, ///< Feature pyramids are computed once and kept in memory.
+	FILE ///< Feature pyramids are computed once and spilled into a binary file that is read in each round.
+};
+
+/**
+ * Miner of hard negative training examples for linear SVMs on aggregated features.
+ *
+ * The feature pyramid of each image is computed only once (unless caching is disabled) and re-scored with the
+ * weights of each bootstrapping round. The scoring of the images runs in parallel, only the strongest negatives
+ * of each image are kept.
+ */
+class HardNegativeMiner {
+public:
+
+	/**
+	 * Constructs a new hard negative miner.
+	 *
+	 * @param[in] featureExtractor Feature extractor whose pyramid is used for computing the features.
+	 * @param[in] caching Storage of the feature pyramids between rounds.
+	 * @param[in] cacheFilename Name of the file that the feature pyramids are spilled into (only used with FeatureCaching::FILE).
+	 */
+	HardNegativeMiner(std::shared_ptr<imageprocessing::extraction::AggregatedFeaturesExtractor> featureExtractor,
+			FeatureCaching caching, std::string cacheFilename = "");
+
+	~HardNegativeMiner();
+
+	HardNegativeMiner(const HardNegativeMiner&) = delete;
+
+	HardNegativeMiner& operator=(const HardNegativeMiner&) = delete;
+
+	/**
+	 * Adds an image whose feature pyramid was just computed by the feature extractor.
+	 *
+	 * @param[in] image Image the feature extractor was updated with.
+	 * @param[in] nonNegativeBoxes Bounding boxes that must not overlap with negative examples.
+	 */
+	void addImage(const cv::Mat& image, const std::vector<cv::Rect>& nonNegativeBoxes);
+
+	/**
+	 * Removes all images and their cached feature pyramids.
+	 */
+	void clear();
+
+	/**
+	 * Collects the hardest negative examples of each image, i.e. those with the highest score. The windows of an image
+	 * may be suppressed greedily in the order of their score, so a window is only kept if it does not overlap any of the
+	 * stronger windows already kept by more than the given non-maximum suppression threshold.
+	 *
+	 * @param[in] svm Linear SVM that is used for scoring the windows.
+	 * @param[in] scoreThreshold SVM score that must be exceeded for a window to be considered a hard negative.
+	 * @param[in] maxNegativesPerImage Maximum number of hard negatives per image.
+	 * @param[in] overlapThreshold Maximum allowed overlap between negative examples and non-negative bounding boxes.
+	 * @param[in] nmsOverlapThreshold Maximum allowed overlap between two negative examples of the same image (1 to disable the suppression).
+	 * @return Feature vectors of the hard negatives, ordered by image.
+	 */
+	std::vector<cv::Mat> mine(const classification::SvmClassifier& svm,
+			float scoreThreshold, int maxNegativesPerImage, double overlapThreshold, double nmsOverlapThreshold);
+
+	/**
+	 * @return Number of images.
+	 */
+	size_t getImageCount() const;
+
+private:
+
+	/**
+	 * Image with its cached feature pyramid and non-negative bounding boxes.
+	 */
+	struct MiningImage {
+		cv::Mat image; ///< Image (only kept if the feature pyramid is not cached).
+		std::vector<std::shared_ptr<imageprocessing::ImagePyramidLayer>> layers; ///< Feature pyramid layers (only with FeatureCaching::MEMORY).
+		std::streamoff fileOffset; ///< Position of the feature pyramid within the cache file (only with FeatureCaching::FILE).
+		std::vector<cv::Rect> nonNegativeBoxes; ///< Bounding boxes that must not overlap with negative examples.
+	};
+
+	/**
+	 * Window of a feature pyramid layer with its score.
+	 */
+	struct Candidate {
+		float score; ///< SVM score.
+		size_t layerIndex; ///< Index of the layer within the feature pyramid.
+		cv::Rect boundsInLayerCells; ///< Bounds of the window in layer cells.
+		cv::Rect boundsInImagePixels; ///< Bounds of the window in image pixels.
+	};
+
+	/**
+	 * Loop body that mines the hard negatives of a range of images.
+	 */
+	class MiningBody;
+
+	void writeLayers(const std::vector<std::shared_ptr<imageprocessing::ImagePyramidLayer>>& layers);
+
+	static std::vector<std::shared_ptr<imageprocessing::ImagePyramidLayer>> readLayers(std::istream& stream);
+
+	std::vector<cv::Mat> mine(const MiningImage& image,
+			const std::vector<std::shared_ptr<imageprocessing::ImagePyramidLayer>>& layers) const;
+
+	bool isOverlapping(cv::Rect boxToTest, const std::vector<cv::Rect>& otherBoxes, double threshold) const;
+
+	double computeOverlap(cv::Rect a, cv::Rect b) const;
+
+	std::shared_ptr<imageprocessing::extraction::AggregatedFeaturesExtractor> featureExtractor;
+	FeatureCaching caching;
+	std::string cacheFilename;
+	std::ofstream cacheFile;
+	std::vector<MiningImage> images;
+	imageprocessing::ConvolutionFilter scoreFilter; ///< Filter that computes the SVM scores of the current round.
+	cv::Size kernelSize; ///< Window size in cells.
+	float scoreThreshold; ///< Score threshold of the current round.
+	int maxNegativesPerImage; ///< Maximum number of hard negatives per image of the current round.
+	double overlapThreshold; ///< Maximum overlap with non-negatives of the current round.
+	double nmsOverlapThreshold; ///< Maximum overlap between the negatives of an image of the current round.
+};
+
+#endif /* HARDNEGATIVEMINER_HPP_ */
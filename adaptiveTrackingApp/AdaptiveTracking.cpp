@@ -55,6 +55,7 @@
 #include "classification/LinearKernel.hpp"
 #include "classification/SvmClassifier.hpp"
 #include "classification/AgeBasedExampleManagement.hpp"
+#include "classification/CachedConfidenceBasedExampleManagement.hpp"
 #include "classification/ConfidenceBasedExampleManagement.hpp"
 #include "classification/UnlimitedExampleManagement.hpp"
 #include "classification/FixedTrainableProbabilisticSvmClassifier.hpp"
@@ -318,6 +319,11 @@ unique_ptr<ExampleManagement> AdaptiveTracking::createExampleManagement(ptree& c
 		return unique_ptr<ExampleManagement>(new AgeBasedExampleManagement(config.get<size_t>("capacity"), config.get<size_t>("required")));
 	} else if (config.get_value<string>() == "confidencebased") {
 		return unique_ptr<ExampleManagement>(new ConfidenceBasedExampleManagement(classifier, positive, config.get<size_t>("capacity"), config.get<size_t>("required")));
+	} else if (config.get_value<string>() == "cachedconfidencebased") {
+		shared_ptr<TrainableSvmClassifier> svm = std::dynamic_pointer_cast<TrainableSvmClassifier>(classifier);
+		if (!svm)
+			throw invalid_argument("AdaptiveTracking: cached confidence based example management needs an SVM");
+		return unique_ptr<ExampleManagement>(new CachedConfidenceBasedExampleManagement(svm, positive, config.get<size_t>("capacity"), config.get<size_t>("required")));
 	} else {
 		throw invalid_argument("AdaptiveTracking: invalid example management type: " + config.get_value<string>());
 	}
@@ -333,7 +339,7 @@ shared_ptr<TrainableSvmClassifier> AdaptiveTracking::createLibSvmClassifier(ptre
 		optional<ptree&> negativesConfig = config.get_child_optional("staticNegativeExamples");
 		if (negativesConfig && negativesConfig->get_value<bool>()) {
 			trainableSvm->loadStaticNegatives(negativesConfig->get<string>("filename"),
-					negativesConfig->get<int>("amount"), negativesConfig->get<double>("scale"));
+					negativesConfig->get<int>("amount"), negativesConfig->get<double>("scale"), negativesConfig->get<bool>("random", false));
 		}
 		return trainableSvm;
 	} else if (config.get_value<string>() == "one-class") {
@@ -35,6 +35,13 @@
 #include <chrono>
 #include <memory>
 #include <iostream>
+#include <algorithm>
+#include <utility>
+#include <queue>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
 
 #include "opencv2/core/core.hpp"
 #include "opencv2/imgproc/imgproc.hpp"
@@ -60,6 +67,7 @@
 #include "fitting/AffineCameraEstimation.hpp"
 #include "fitting/OpenCVCameraEstimation.hpp"
 #include "fitting/LinearShapeFitting.hpp"
+#include "fitting/LinearShapeFitter.hpp"
 
 #include "render/SoftwareRenderer.hpp"
 #include "render/MeshUtils.hpp"
@@ -123,6 +131,269 @@ std::ostream& operator<<(std::ostream& os, const std::vector<T>& v)
 	return os;
 }
 
+/**
+ * An image with its landmarks (already mapped to the landmark identifiers of
+ * the model), read by the main thread and fitted by one of the worker threads.
+ */
+struct FittingJob {
+	path name;
+	Mat image;
+	LandmarkCollection landmarks;
+};
+
+/**
+ * A queue with a maximum size that passes the jobs from the reading thread to the
+ * fitting threads. push(...) blocks while the queue is full and pop(...) blocks while
+ * it is empty. After close() was called, pop(...) returns false as soon as it is empty.
+ */
+template<class T>
+class BoundedQueue
+{
+public:
+	explicit BoundedQueue(size_t capacity) : capacity(capacity), closed(false) {}
+
+	void push(T item)
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		notFull.wait(lock, [this]() { return queue.size() < capacity; });
+		queue.push(std::move(item));
+		notEmpty.notify_one();
+	}
+
+	bool pop(T& item)
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		notEmpty.wait(lock, [this]() { return !queue.empty() || closed; });
+		if (queue.empty()) {
+			return false;
+		}
+		item = std::move(queue.front());
+		queue.pop();
+		notFull.notify_one();
+		return true;
+	}
+
+	void close()
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		closed = true;
+		notEmpty.notify_all();
+	}
+
+private:
+	size_t capacity;
+	bool closed;
+	std::queue<T> queue;
+	std::mutex mutex;
+	std::condition_variable notFull;
+	std::condition_variable notEmpty;
+};
+
+/**
+ * Serializes the logging of the threads, because neither the logger factory nor the appenders are
+ * thread-safe. The logger has to be fetched from the factory before the worker threads are started.
+ * Everything else that might log while the workers are running (e.g. reading the images) has to
+ * lock the mutex, too.
+ */
+class SynchronizedLogger
+{
+public:
+	explicit SynchronizedLogger(Logger& logger) : logger(logger) {}
+
+	void info(const string& message)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		logger.info(message);
+	}
+
+	void error(const string& message)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		logger.error(message);
+	}
+
+	std::mutex& getMutex()
+	{
+		return mutex;
+	}
+
+private:
+	Logger& logger;
+	std::mutex mutex;
+};
+
+/**
+ * The time spent in each stage, summed up over all images and threads, in microseconds.
+ */
+struct StageTimings {
+	std::atomic<long long> reading{ 0 };
+	std::atomic<long long> camera{ 0 };
+	std::atomic<long long> shape{ 0 };
+	std::atomic<long long> rendering{ 0 };
+	std::atomic<long long> texture{ 0 };
+	std::atomic<long long> output{ 0 };
+};
+
+long long elapsedMicroseconds(std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * Fits the model to one image and writes the results to the output path.
+ * Everything except the shape fitter is shared between the threads and only read.
+ */
+void fitImage(const FittingJob& job, const morphablemodel::MorphableModel& morphableModel, const morphablemodel::PcaModel& shapeModel, fitting::LinearShapeFitter& shapeFitter, const ptree& config, const path& outputPath, float lambda, bool parallelRendering, StageTimings& timings, SynchronizedLogger& appLogger)
+{
+	auto start = std::chrono::steady_clock::now();
+	auto stageStart = start;
+	appLogger.info("Starting to process " + job.name.string());
+	const Mat& img = job.image;
+
+	vector<imageio::ModelLandmark> landmarks;
+	Mat landmarksImage = img.clone(); // blue rect = the used landmarks
+	for (const auto& lm : job.landmarks.getLandmarks()) {
+		lm->draw(landmarksImage);
+		landmarks.emplace_back(imageio::ModelLandmark(lm->getName(), lm->getPosition2D()));
+		cv::rectangle(landmarksImage, cv::Point(cvRound(lm->getX() - 2.0f), cvRound(lm->getY() - 2.0f)), cv::Point(cvRound(lm->getX() + 2.0f), cvRound(lm->getY() + 2.0f)), cv::Scalar(255, 0, 0));
+		//cv::putText(landmarksImage, lm->getName(), cv::Point(lm->getX(), lm->getY()), cv::FONT_HERSHEY_COMPLEX_SMALL, 0.5, cv::Scalar(0.0, 0.0, 255.0));
+	}
+
+	// Start affine camera estimation (Aldrian paper)
+	Mat affineCamLandmarksProjectionImage = landmarksImage.clone(); // the affine LMs are currently not used (don't know how to render without z-vals)
+
+	// Convert the landmarks to clip-space, and only convert the ones that exist in the model
+	vector<imageio::ModelLandmark> landmarksClipSpace;
+	for (const auto& lm : landmarks) {
+		if (shapeModel.landmarkExists(lm.getName())) {
+			cv::Vec2f clipCoords = render::utils::screenToClipSpace(lm.getPosition2D(), img.cols, img.rows);
+			landmarksClipSpace.push_back(imageio::ModelLandmark(lm.getName(), Vec3f(clipCoords[0], clipCoords[1], 0.0f), lm.isVisible()));
+		}
+	}
+
+	// Checked here, because the camera estimation would log the error itself, unsynchronized with the other threads
+	if (landmarksClipSpace.size() < 4) {
+		throw std::runtime_error("Number of landmarks that exist in the model needs to be equal to or larger than 4, but is " + lexical_cast<string>(landmarksClipSpace.size()) + ".");
+	}
+	Mat affineCam = fitting::estimateAffineCamera(landmarksClipSpace, morphableModel);
+
+	// Render the mean-face landmarks projected using the estimated camera:
+	// Todo/Note: Here we render all landmarks. Shouldn't we only render the ones that exist in the model? (see above, landmarksClipSpace)
+	for (const auto& lm : landmarks) {
+		Vec3f modelPoint;
+		try {
+			modelPoint = shapeModel.getMeanAtPoint(lm.getName());
+		}
+		catch (std::out_of_range& e) {
+			continue;
+		}
+		cv::Vec2f screenPoint = fitting::projectAffine(modelPoint, affineCam, img.cols, img.rows);
+		cv::circle(affineCamLandmarksProjectionImage, Point2f(screenPoint), 4.0f, Scalar(0.0f, 255.0f, 0.0f));
+	}
+	timings.camera += elapsedMicroseconds(stageStart);
+	stageStart = std::chrono::steady_clock::now();
+
+	// Estimate the shape coefficients:
+	// Detector variances: Should not be in pixels. Should be normalised by the IED. Normalise by the image dimensions is not a good idea either, it has nothing to do with it. See comment in fitShapeToLandmarksLinear().
+	// Let's just use the hopefully reasonably set default value for now (around 3 pixels)
+	vector<float> fittedCoeffs = shapeFitter.fit(affineCam, landmarksClipSpace, lambda);
+	timings.shape += elapsedMicroseconds(stageStart);
+	stageStart = std::chrono::steady_clock::now();
+
+	// Obtain the full mesh and render it using the estimated camera:
+	Mesh mesh = morphableModel.drawSample(fittedCoeffs, vector<float>()); // takes standard-normal (not-normalised) coefficients
+
+	render::SoftwareRenderer softwareRenderer(img.cols, img.rows);
+	softwareRenderer.doTiledRasterization = parallelRendering;
+	Mat fullAffineCam = fitting::calculateAffineZDirection(affineCam);
+	fullAffineCam.at<float>(2, 3) = fullAffineCam.at<float>(2, 2); // Todo: Find out and document why this is necessary!
+	fullAffineCam.at<float>(2, 2) = 1.0f;
+	softwareRenderer.doBackfaceCulling = true;
+	auto framebuffer = softwareRenderer.render(mesh, fullAffineCam); // hmm, do we have the z-test disabled?
+	Mat renderedModel = framebuffer.first.clone(); // we save that later, and the framebuffer gets overwritten
+	timings.rendering += elapsedMicroseconds(stageStart);
+	stageStart = std::chrono::steady_clock::now();
+
+	// Extract the texture
+	// Todo: check for if hasTexture, we can't do it if the model doesn't have texture coordinates
+	Mat textureMap = render::utils::extractTexture(mesh, fullAffineCam, img.cols, img.rows, img, framebuffer.second);
+	timings.texture += elapsedMicroseconds(stageStart);
+	stageStart = std::chrono::steady_clock::now();
+
+	// Save the extracted texture map (isomap):
+	path isomapFilename = outputPath / job.name.stem();
+	isomapFilename += "_isomap.png";
+	cv::imwrite(isomapFilename.string(), textureMap);
+	timings.output += elapsedMicroseconds(stageStart);
+	stageStart = std::chrono::steady_clock::now();
+
+	// Render the shape-model with the extracted texture from a frontal viewpoint:
+	float aspect = static_cast<float>(img.cols) / static_cast<float>(img.rows);
+	Mat frontalCam = render::utils::MatrixUtils::createOrthogonalProjectionMatrix(-1.0f * aspect, 1.0f * aspect, -1.0f, 1.0f, 0.1f, 100.0f) * render::utils::MatrixUtils::createScalingMatrix(1.0f / 120.0f, 1.0f / 120.0f, 1.0f / 120.0f);
+	softwareRenderer.enableTexturing(true);
+	auto texture = make_shared<render::Texture>();
+	texture->create(textureMap); // same as the written isomap (png is lossless), no need to read it again
+	softwareRenderer.setCurrentTexture(texture);
+	auto frFrontal = softwareRenderer.render(mesh, frontalCam);
+	timings.rendering += elapsedMicroseconds(stageStart);
+	stageStart = std::chrono::steady_clock::now();
+
+	// Write the fitting output files containing:
+	// - Camera parameters, fitting parameters, shape coefficients
+	ptree fittingFile;
+	fittingFile.put("camera", string("affine"));
+	fittingFile.put("camera.matrix", affineCameraMatrixToString(fullAffineCam));
+
+	fittingFile.put("imageWidth", img.cols);
+	fittingFile.put("imageHeight", img.rows);
+
+	fittingFile.put("fittingParameters.lambda", lambda);
+
+	fittingFile.put("textureMap", isomapFilename.filename().string());
+	fittingFile.put("model", config.get_child("morphableModel").get<string>("filename")); // This can throw, but the filename should really exist.
+
+	// alphas:
+	fittingFile.put("shapeCoefficients", "");
+	for (size_t i = 0; i < fittedCoeffs.size(); ++i) {
+		fittingFile.put("shapeCoefficients." + std::to_string(i), fittedCoeffs[i]);
+	}
+
+	// Save the fitting file
+	path fittingFileName = outputPath / job.name.stem();
+	fittingFileName += ".txt";
+	boost::property_tree::write_info(fittingFileName.string(), fittingFile);
+
+	// Additional optional output, as set in the config file:
+	if (config.get_child("output", ptree()).get<bool>("copyInputImage", false)) {
+		path outInputImage = outputPath / job.name.filename();
+		cv::imwrite(outInputImage.string(), img);
+	}
+	if (config.get_child("output", ptree()).get<bool>("landmarksImage", false)) {
+		path outLandmarksImage = outputPath / job.name.stem();
+		outLandmarksImage += "_landmarks.png";
+		cv::imwrite(outLandmarksImage.string(), affineCamLandmarksProjectionImage);
+	}
+	if (config.get_child("output", ptree()).get<bool>("writeObj", false)) {
+		path outMesh = outputPath / job.name.stem();
+		outMesh.replace_extension("obj");
+		Mesh::writeObj(mesh, outMesh.string());
+	}
+	if (config.get_child("output", ptree()).get<bool>("renderResult", false)) {
+		path outRenderResult = outputPath / job.name.stem();
+		outRenderResult += "_render.png";
+		cv::imwrite(outRenderResult.string(), renderedModel);
+	}
+	if (config.get_child("output", ptree()).get<bool>("frontalRendering", false)) {
+		path outFrontalRenderResult = outputPath / job.name.stem();
+		outFrontalRenderResult += "_render_frontal.png";
+		cv::imwrite(outFrontalRenderResult.string(), frFrontal.first);
+	}
+	timings.output += elapsedMicroseconds(stageStart);
+
+	int elapsed_mseconds = static_cast<int>(elapsedMicroseconds(start) / 1000);
+	appLogger.info("Finished processing " + job.name.string() + ". Elapsed time: " + lexical_cast<string>(elapsed_mseconds) + "ms.");
+}
+
 int main(int argc, char *argv[])
 {
 	#ifdef WIN32
@@ -140,6 +411,7 @@ int main(int argc, char *argv[])
 	string landmarkType;
 	path landmarkMappings;
 	path outputPath;
+	int numThreads;
 
 	try {
 		po::options_description desc("Allowed options");
@@ -160,6 +432,8 @@ int main(int argc, char *argv[])
 				"an optional mapping-file that maps from the input landmarks to landmark identifiers in the model's format")
 			("output,o", po::value<path>(&outputPath)->default_value("."),
 				"path to an output folder")
+			("threads,j", po::value<int>(&numThreads)->default_value(1),
+				"number of images that are fitted in parallel. The images are read in a separate thread.")
 		;
 
 		po::variables_map vm;
@@ -310,15 +584,17 @@ int main(int argc, char *argv[])
 		appLogger.error(error.what());
 		return EXIT_FAILURE;
 	}
+	// Checked here, because drawing a sample would log the error itself, unsynchronized with the worker threads
+	if (morphableModel.getShapeModel().getDataDimension() != morphableModel.getColorModel().getDataDimension()) {
+		appLogger.error("The number of vertices of the shape and color models are not the same.");
+		return EXIT_FAILURE;
+	}
 
 	// Create the output directory if it doesn't exist yet
 	if (!boost::filesystem::exists(outputPath)) {
 		boost::filesystem::create_directory(outputPath);
 	}
 	
-	std::chrono::time_point<std::chrono::system_clock> start, end;
-	Mat img;
-	vector<imageio::ModelLandmark> landmarks;
 	float lambda = config.get_child("fitting", ptree()).get<float>("lambda", 15.0f);
 
 	//LandmarkMapper landmarkMapper(landmarkMappings);
@@ -328,145 +604,87 @@ int main(int argc, char *argv[])
 		landmarkMapper = LandmarkMapper(landmarkMappings);
 	} // Ideas for a better solution: A flag in LandmarkMapper, or polymorphism (IdentityLandmarkMapper), or in Mapper, if mapping empty, return input?, or...?
 
-	while (labeledImageSource->next()) {
-		start = std::chrono::system_clock::now();
-		appLogger.info("Starting to process " + labeledImageSource->getName().string());
-		img = labeledImageSource->getImage();
-
-		LandmarkCollection lms = labeledImageSource->getLandmarks();
-		LandmarkCollection didLms;
-		if (!landmarkMappings.empty()) {
-			didLms = landmarkMapper.convert(lms);
-		}
-		else {
-			didLms = lms;
-		}
-
-		landmarks.clear();
-		Mat landmarksImage = img.clone(); // blue rect = the used landmarks
-		for (const auto& lm : didLms.getLandmarks()) {
-			lm->draw(landmarksImage);
-			landmarks.emplace_back(imageio::ModelLandmark(lm->getName(), lm->getPosition2D()));
-			cv::rectangle(landmarksImage, cv::Point(cvRound(lm->getX() - 2.0f), cvRound(lm->getY() - 2.0f)), cv::Point(cvRound(lm->getX() + 2.0f), cvRound(lm->getY() + 2.0f)), cv::Scalar(255, 0, 0));
-			//cv::putText(landmarksImage, lm->getName(), cv::Point(lm->getX(), lm->getY()), cv::FONT_HERSHEY_COMPLEX_SMALL, 0.5, cv::Scalar(0.0, 0.0, 255.0));
-		}
-
-		// Start affine camera estimation (Aldrian paper)
-		Mat affineCamLandmarksProjectionImage = landmarksImage.clone(); // the affine LMs are currently not used (don't know how to render without z-vals)
-
-		// Convert the landmarks to clip-space, and only convert the ones that exist in the model
-		vector<imageio::ModelLandmark> landmarksClipSpace;
-		for (const auto& lm : landmarks) {
-			if (morphableModel.getShapeModel().landmarkExists(lm.getName())) {
-				cv::Vec2f clipCoords = render::utils::screenToClipSpace(lm.getPosition2D(), img.cols, img.rows);
-				landmarksClipSpace.push_back(imageio::ModelLandmark(lm.getName(), Vec3f(clipCoords[0], clipCoords[1], 0.0f), lm.isVisible()));
+	// The main thread reads the images and landmarks while the worker threads fit them. The model is
+	// only loaded once and shared by all threads, every thread has its own shape fitter with cached basis.
+	// From now on, all logging has to go through the synchronized logger.
+	SynchronizedLogger synchronizedLogger(Loggers->getLogger("fitter"));
+	int numWorkers = std::max(numThreads, 1);
+	bool parallelRendering = numWorkers == 1; // otherwise, the images are already fitted in parallel
+	const morphablemodel::PcaModel shapeModel = morphableModel.getShapeModel();
+	BoundedQueue<FittingJob> jobs(2 * numWorkers);
+	StageTimings timings;
+	std::atomic<int> numFitted(0);
+	int numImages = 0;
+	auto batchStart = std::chrono::steady_clock::now();
+	vector<std::thread> workers;
+	for (int i = 0; i < numWorkers; ++i) {
+		workers.emplace_back([&]() {
+			fitting::LinearShapeFitter shapeFitter(morphableModel); // caches the basis of the landmarks between the images
+			FittingJob job;
+			while (jobs.pop(job)) {
+				try {
+					fitImage(job, morphableModel, shapeModel, shapeFitter, config, outputPath, lambda, parallelRendering, timings, synchronizedLogger);
+					++numFitted;
+				}
+				catch (const std::exception& e) {
+					synchronizedLogger.error("Error processing " + job.name.string() + ": " + e.what());
+				}
 			}
-		}
-
-		Mat affineCam = fitting::estimateAffineCamera(landmarksClipSpace, morphableModel);
+		});
+	}
 
-		// Render the mean-face landmarks projected using the estimated camera:
-		// Todo/Note: Here we render all landmarks. Shouldn't we only render the ones that exist in the model? (see above, landmarksClipSpace)
-		for (const auto& lm : landmarks) {
-			Vec3f modelPoint;
-			try {
-				modelPoint = morphableModel.getShapeModel().getMeanAtPoint(lm.getName());
-			}
-			catch (std::out_of_range& e) {
-				continue;
+	try {
+		while (true) {
+			auto start = std::chrono::steady_clock::now();
+			FittingJob job;
+			{
+				std::lock_guard<std::mutex> lock(synchronizedLogger.getMutex()); // the image and landmark sources might log
+				if (!labeledImageSource->next()) {
+					break;
+				}
+				job.name = labeledImageSource->getName();
+				job.image = labeledImageSource->getImage();
+				LandmarkCollection lms = labeledImageSource->getLandmarks();
+				if (!landmarkMappings.empty()) {
+					job.landmarks = landmarkMapper.convert(lms);
+				}
+				else {
+					job.landmarks = lms;
+				}
 			}
-			cv::Vec2f screenPoint = fitting::projectAffine(modelPoint, affineCam, img.cols, img.rows);
-			cv::circle(affineCamLandmarksProjectionImage, Point2f(screenPoint), 4.0f, Scalar(0.0f, 255.0f, 0.0f));
+			timings.reading += elapsedMicroseconds(start);
+			++numImages;
+			jobs.push(std::move(job)); // blocks while all workers are busy and the queue is full
 		}
-
-		// Estimate the shape coefficients:
-		// Detector variances: Should not be in pixels. Should be normalised by the IED. Normalise by the image dimensions is not a good idea either, it has nothing to do with it. See comment in fitShapeToLandmarksLinear().
-		// Let's just use the hopefully reasonably set default value for now (around 3 pixels)
-		vector<float> fittedCoeffs = fitting::fitShapeToLandmarksLinear(morphableModel, affineCam, landmarksClipSpace, lambda);
-
-		// Obtain the full mesh and render it using the estimated camera:
-		Mesh mesh = morphableModel.drawSample(fittedCoeffs, vector<float>()); // takes standard-normal (not-normalised) coefficients
-
-		render::SoftwareRenderer softwareRenderer(img.cols, img.rows);
-		Mat fullAffineCam = fitting::calculateAffineZDirection(affineCam);
-		fullAffineCam.at<float>(2, 3) = fullAffineCam.at<float>(2, 2); // Todo: Find out and document why this is necessary!
-		fullAffineCam.at<float>(2, 2) = 1.0f;
-		softwareRenderer.doBackfaceCulling = true;
-		auto framebuffer = softwareRenderer.render(mesh, fullAffineCam); // hmm, do we have the z-test disabled?
-		Mat renderedModel = framebuffer.first.clone(); // we save that later, and the framebuffer gets overwritten
-
-		// Extract the texture
-		// Todo: check for if hasTexture, we can't do it if the model doesn't have texture coordinates
-		Mat textureMap = render::utils::extractTexture(mesh, fullAffineCam, img.cols, img.rows, img, framebuffer.second);
-
-		// Save the extracted texture map (isomap):
-		path isomapFilename = outputPath / labeledImageSource->getName().stem();
-		isomapFilename += "_isomap.png";
-		cv::imwrite(isomapFilename.string(), textureMap);
-
-		// Render the shape-model with the extracted texture from a frontal viewpoint:
-		float aspect = static_cast<float>(img.cols) / static_cast<float>(img.rows);
-		Mat frontalCam = render::utils::MatrixUtils::createOrthogonalProjectionMatrix(-1.0f * aspect, 1.0f * aspect, -1.0f, 1.0f, 0.1f, 100.0f) * render::utils::MatrixUtils::createScalingMatrix(1.0f / 120.0f, 1.0f / 120.0f, 1.0f / 120.0f);
-		softwareRenderer.enableTexturing(true);
-		auto texture = make_shared<render::Texture>();
-		texture->createFromFile(isomapFilename.string());
-		softwareRenderer.setCurrentTexture(texture);
-		auto frFrontal = softwareRenderer.render(mesh, frontalCam);
-
-		// Write the fitting output files containing:
-		// - Camera parameters, fitting parameters, shape coefficients
-		ptree fittingFile;
-		fittingFile.put("camera", string("affine"));
-		fittingFile.put("camera.matrix", affineCameraMatrixToString(fullAffineCam));
-
-		fittingFile.put("imageWidth", img.cols);
-		fittingFile.put("imageHeight", img.rows);
-
-		fittingFile.put("fittingParameters.lambda", lambda);
-
-		fittingFile.put("textureMap", isomapFilename.filename().string());
-		fittingFile.put("model", config.get_child("morphableModel").get<string>("filename")); // This can throw, but the filename should really exist.
-
-		// alphas:
-		fittingFile.put("shapeCoefficients", "");
-		for (size_t i = 0; i < fittedCoeffs.size(); ++i) {
-			fittingFile.put("shapeCoefficients." + std::to_string(i), fittedCoeffs[i]);
+	}
+	catch (...) {
+		// the workers have to be joined before they are destroyed, otherwise std::terminate would be called
+		jobs.close();
+		for (auto& worker : workers) {
+			worker.join();
 		}
+		throw;
+	}
+	jobs.close();
+	for (auto& worker : workers) {
+		worker.join();
+	}
 
-		// Save the fitting file
-		path fittingFileName = outputPath / labeledImageSource->getName().stem();
-		fittingFileName += ".txt";
-		boost::property_tree::write_info(fittingFileName.string(), fittingFile);
-
-		// Additional optional output, as set in the config file:
-		if (config.get_child("output", ptree()).get<bool>("copyInputImage", false)) {
-			path outInputImage = outputPath / labeledImageSource->getName().filename();
-			cv::imwrite(outInputImage.string(), img);
-		}
-		if (config.get_child("output", ptree()).get<bool>("landmarksImage", false)) {
-			path outLandmarksImage = outputPath / labeledImageSource->getName().stem();
-			outLandmarksImage += "_landmarks.png";
-			cv::imwrite(outLandmarksImage.string(), affineCamLandmarksProjectionImage);
+	long long batchTime = elapsedMicroseconds(batchStart);
+	appLogger.info("Fitted " + lexical_cast<string>(numFitted.load()) + " of " + lexical_cast<string>(numImages) + " images in " + lexical_cast<string>(batchTime / 1000) + "ms using " + lexical_cast<string>(numWorkers) + " thread(s).");
+	if (numImages > 0) {
+		// The stages of the workers overlap, so their sum can be larger than the elapsed time
+		const vector<std::pair<string, long long>> stages = {
+			{ "Reading images and landmarks", timings.reading.load() },
+			{ "Camera estimation", timings.camera.load() },
+			{ "Shape fitting", timings.shape.load() },
+			{ "Rendering", timings.rendering.load() },
+			{ "Texture extraction", timings.texture.load() },
+			{ "Writing the output", timings.output.load() }
+		};
+		for (const auto& stage : stages) {
+			appLogger.info(stage.first + ": " + lexical_cast<string>(stage.second / 1000) + "ms in total, " + lexical_cast<string>(stage.second / 1000.0 / numImages) + "ms per image.");
 		}
-		if (config.get_child("output", ptree()).get<bool>("writeObj", false)) {
-			path outMesh = outputPath / labeledImageSource->getName().stem();
-			outMesh.replace_extension("obj");
-			Mesh::writeObj(mesh, outMesh.string());
-		}
-		if (config.get_child("output", ptree()).get<bool>("renderResult", false)) {
-			path outRenderResult = outputPath / labeledImageSource->getName().stem();
-			outRenderResult += "_render.png";
-			cv::imwrite(outRenderResult.string(), renderedModel);
-		}
-		if (config.get_child("output", ptree()).get<bool>("frontalRendering", false)) {
-			path outFrontalRenderResult = outputPath / labeledImageSource->getName().stem();
-			outFrontalRenderResult += "_render_frontal.png";
-			cv::imwrite(outFrontalRenderResult.string(), frFrontal.first);
-		}
-
-		end = std::chrono::system_clock::now();
-		int elapsed_mseconds = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
-		appLogger.info("Finished processing. Elapsed time: " + lexical_cast<string>(elapsed_mseconds)+"ms.");
 	}
 	return 0;
 }
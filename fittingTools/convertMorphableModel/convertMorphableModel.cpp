@@ -0,0 +1,140 @@
+/*
+ * convertMorphableModel.cpp
+ *
+ *  Created on: 18.10.2026
+ *      Author: Patrik Huber
+ */
+
+#ifdef WIN32
+	#include <SDKDDKVer.h>
+#endif
+
+#include "morphablemodel/MorphableModel.hpp"
+
+#include "logging/LoggerFactory.hpp"
+
+#ifdef WIN32
+	#define BOOST_ALL_DYN_LINK	// Link against the dynamic boost lib. Seems to be necessary because we use /MD, i.e. link to the dynamic CRT.
+	#define BOOST_ALL_NO_LIB	// Don't use the automatic library linking by boost with VS2010 (#pragma ...). Instead, we specify everything in cmake.
+#endif
+#include "boost/program_options.hpp"
+#include "boost/algorithm/string.hpp"
+#include "boost/filesystem.hpp"
+
+#include <iostream>
+#include <string>
+#include <memory>
+#include <exception>
+
+namespace po = boost::program_options;
+using logging::Logger;
+using logging::LoggerFactory;
+using logging::LogLevel;
+using morphablemodel::MorphableModel;
+using boost::filesystem::path;
+using std::cout;
+using std::endl;
+using std::string;
+using std::make_shared;
+
+/**
+ * Converts a Morphable Model in the Surrey (.scm) or statismo (.h5) format
+ * into the binary format that is memory-mapped by MorphableModel::loadBinaryModel.
+ * The result is loaded again and compared to the original model.
+ */
+int main(int argc, char *argv[])
+{
+	string verboseLevelConsole;
+	path inputFilename, vertexMappingFilename, isomapFilename, outputFilename;
+
+	try {
+		po::options_description desc("Allowed options");
+		desc.add_options()
+			("help,h",
+				"produce help message")
+			("verbose,v", po::value<string>(&verboseLevelConsole)->implicit_value("DEBUG")->default_value("INFO", "show messages with INFO loglevel or below."),
+				"specify the verbosity of the console output: PANIC, ERROR, WARN, INFO, DEBUG or TRACE")
+			("input,i", po::value<path>(&inputFilename)->required(),
+				"the model to convert, a .scm or statismo .h5 file")
+			("vertex-mapping,m", po::value<path>(&vertexMappingFilename),
+				"the landmark to vertex-id mapping of a .scm model")
+			("isomap,t", po::value<path>(&isomapFilename),
+				"the isomap of a .scm model, used for the texture coordinates")
+			("output,o", po::value<path>(&outputFilename)->required(),
+				"the binary model file to write (.bin)")
+			;
+
+		po::variables_map vm;
+		po::store(po::command_line_parser(argc, argv).options(desc).run(), vm);
+		if (vm.count("help")) {
+			cout << "Usage: convertMorphableModel [options]\n";
+			cout << desc;
+			return EXIT_SUCCESS;
+		}
+		po::notify(vm);
+
+	}
+	catch (po::error& e) {
+		cout << "Error while parsing command-line arguments: " << e.what() << endl;
+		cout << "Use --help to display a list of options." << endl;
+		return EXIT_SUCCESS;
+	}
+
+	LogLevel logLevel;
+	if (boost::iequals(verboseLevelConsole, "PANIC")) logLevel = LogLevel::Panic;
+	else if (boost::iequals(verboseLevelConsole, "ERROR")) logLevel = LogLevel::Error;
+	else if (boost::iequals(verboseLevelConsole, "WARN")) logLevel = LogLevel::Warn;
+	else if (boost::iequals(verboseLevelConsole, "INFO")) logLevel = LogLevel::Info;
+	else if (boost::iequals(verboseLevelConsole, "DEBUG")) logLevel = LogLevel::Debug;
+	else if (boost::iequals(verboseLevelConsole, "TRACE")) logLevel = LogLevel::Trace;
+	else {
+		cout << "Error: Invalid LogLevel." << endl;
+		return EXIT_FAILURE;
+	}
+
+	Loggers->getLogger("morphablemodel").addAppender(make_shared<logging::ConsoleAppender>(logLevel));
+	Loggers->getLogger("convertMorphableModel").addAppender(make_shared<logging::ConsoleAppender>(logLevel));
+	Logger appLogger = Loggers->getLogger("convertMorphableModel");
+
+	appLogger.debug("Verbose level for console output: " + logging::logLevelToString(logLevel));
+
+	MorphableModel morphableModel;
+	try {
+		if (inputFilename.extension().string() == ".scm") {
+			morphableModel = MorphableModel::loadScmModel(inputFilename, vertexMappingFilename, isomapFilename);
+		}
+		else if (inputFilename.extension().string() == ".h5") {
+			morphableModel = MorphableModel::loadStatismoModel(inputFilename);
+		}
+		else {
+			appLogger.error("Unknown file extension of the input model. Neither .scm nor .h5.");
+			return EXIT_FAILURE;
+		}
+	}
+	catch (std::exception& e) {
+		appLogger.error("Error loading the Morphable Model: " + string(e.what()));
+		return EXIT_FAILURE;
+	}
+	appLogger.info("Loaded " + inputFilename.string() + ", writing the binary model.");
+
+	try {
+		morphableModel.saveBinaryModel(outputFilename);
+		MorphableModel binaryModel = MorphableModel::loadBinaryModel(outputFilename);
+		// The binary model has to contain exactly the same data:
+		if (cv::norm(morphableModel.getShapeModel().getMean(), binaryModel.getShapeModel().getMean(), cv::NORM_INF) != 0.0
+			|| cv::norm(morphableModel.getShapeModel().getNormalizedPcaBasis(), binaryModel.getShapeModel().getNormalizedPcaBasis(), cv::NORM_INF) != 0.0
+			|| cv::norm(morphableModel.getColorModel().getMean(), binaryModel.getColorModel().getMean(), cv::NORM_INF) != 0.0
+			|| cv::norm(morphableModel.getColorModel().getNormalizedPcaBasis(), binaryModel.getColorModel().getNormalizedPcaBasis(), cv::NORM_INF) != 0.0
+			|| morphableModel.getShapeModel().getTriangleList() != binaryModel.getShapeModel().getTriangleList()) {
+			appLogger.error("The written binary model differs from the original model.");
+			return EXIT_FAILURE;
+		}
+	}
+	catch (std::exception& e) {
+		appLogger.error("Error writing the binary model: " + string(e.what()));
+		return EXIT_FAILURE;
+	}
+	appLogger.info("Wrote and verified " + outputFilename.string() + ".");
+
+	return EXIT_SUCCESS;
+}
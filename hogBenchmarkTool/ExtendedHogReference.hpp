@@ -0,0 +1,47 @@
+/*
+ * ExtendedHogReference.hpp
+ *
+ *  Created on: 18.10.2026
+ *      Author: poschmann
+ */
+
+#ifndef EXTENDEDHOGREFERENCE_HPP_
+#define EXTENDEDHOGREFERENCE_HPP_
+
+#include "opencv2/core/core.hpp"
+
+/**
+ * Reference implementation of ExtendedHogFilter::createDescriptors, the nested loops that computed the normalizers
+ * of each block four times (once per cell). Kept unchanged to verify that the current implementation is bit-identical.
+ * It is defined in its own translation unit that includes the same headers as the filter, so sqrt resolves to the
+ * same overload.
+ *
+ * @param[in] histograms Row vector containing the histogram values of the cells in row-major order.
+ * @param[out] descriptors Row vector containing the descriptors of the cells in row-major order.
+ * @param[in] binCount Bin count of the histograms.
+ * @param[in] signedAndUnsigned Flag that indicates whether signed and unsigned gradients should be used.
+ * @param[in] cellRowCount Row count of the cell grid.
+ * @param[in] cellColumnCount Column count of the cell grid.
+ * @param[in] alpha Truncation threshold of the orientation bin values (applied after normalization).
+ */
+void createDescriptorsReference(const cv::Mat& histograms, cv::Mat& descriptors,
+		int binCount, bool signedAndUnsigned, int cellRowCount, int cellColumnCount, float alpha);
+
+/**
+ * Reference implementation of CompleteExtendedHogFilter::buildDescriptors, the nested loops that computed the
+ * normalizers of each block four times (once per cell). Kept unchanged to verify that the current implementation
+ * is bit-identical.
+ *
+ * @param[in,out] descriptors The descriptors (initially containing the histogram data) of each cell.
+ * @param[in] cellRowCount The cell row count.
+ * @param[in] cellColumnCount The cell column count.
+ * @param[in] descriptorSize The value count of the descriptors.
+ * @param[in] binCount The amount of bins inside the histogram.
+ * @param[in] signedGradients Flag that indicates whether signed gradients (360°) are used.
+ * @param[in] unsignedGradients Flag that indicates whether unsigned gradients (180°) are used.
+ * @param[in] alpha Truncation threshold of the orientation bin values (applied after normalization).
+ */
+void buildDescriptorsReference(cv::Mat& descriptors, size_t cellRowCount, size_t cellColumnCount, size_t descriptorSize,
+		size_t binCount, bool signedGradients, bool unsignedGradients, float alpha);
+
+#endif /* EXTENDEDHOGREFERENCE_HPP_ */
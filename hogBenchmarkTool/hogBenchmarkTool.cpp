@@ -0,0 +1,260 @@
+/*
+ * hogBenchmarkTool.cpp
+ *
+ *  Created on: 18.10.2026
+ *      Author: poschmann
+ */
+
+#include "ExtendedHogReference.hpp"
+#include "imageprocessing/ExtendedHogFilter.hpp"
+#include "imageprocessing/CompleteExtendedHogFilter.hpp"
+#include "boost/program_options.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+using imageprocessing::ExtendedHogFilter;
+using imageprocessing::CompleteExtendedHogFilter;
+using cv::Mat;
+using std::make_shared;
+using std::shared_ptr;
+using std::string;
+using std::vector;
+using std::pair;
+using std::cout;
+using std::endl;
+
+namespace po = boost::program_options;
+
+/**
+ * Grants access to the private descriptor functions of the extended HOG filters.
+ */
+class HogBenchmark {
+public:
+
+	static void createDescriptors(const Mat& histograms, Mat& descriptors,
+			int binCount, bool signedAndUnsigned, int cellRowCount, int cellColumnCount, float alpha) {
+		ExtendedHogFilter::createDescriptors(histograms, descriptors, binCount, signedAndUnsigned, cellRowCount, cellColumnCount, alpha);
+	}
+
+	static void buildDescriptors(const CompleteExtendedHogFilter& filter, Mat& descriptors,
+			size_t cellRowCount, size_t cellColumnCount, size_t descriptorSize) {
+		filter.buildDescriptors(descriptors, cellRowCount, cellColumnCount, descriptorSize);
+	}
+};
+
+typedef std::chrono::steady_clock Clock;
+
+/**
+ * Creates random cell histograms. Some bins and cells are empty, so the truncation and the normalization of
+ * empty blocks are covered, too.
+ *
+ * @param[in] cellRowCount Row count of the cell grid.
+ * @param[in] cellColumnCount Column count of the cell grid.
+ * @param[in] binCount Bin count of the histograms.
+ * @param[in] generator Random number generator.
+ * @return Matrix with one row of histogram values per cell.
+ */
+Mat createHistograms(int cellRowCount, int cellColumnCount, int binCount, std::mt19937& generator) {
+	std::uniform_real_distribution<float> valueDistribution(0.f, 10.f);
+	std::bernoulli_distribution emptyBin(0.3);
+	std::bernoulli_distribution emptyCell(0.05);
+	Mat histograms(cellRowCount * cellColumnCount, binCount, CV_32F);
+	for (int cellIndex = 0; cellIndex < histograms.rows; ++cellIndex) {
+		float* values = histograms.ptr<float>(cellIndex);
+		bool empty = emptyCell(generator);
+		for (int binIndex = 0; binIndex < binCount; ++binIndex)
+			values[binIndex] = empty || emptyBin(generator) ? 0.f : valueDistribution(generator);
+	}
+	return histograms;
+}
+
+/**
+ * Creates the initial descriptors of CompleteExtendedHogFilter, which contain the histograms in their first values.
+ */
+Mat createInitialDescriptors(const Mat& histograms, int cellRowCount, int cellColumnCount, int descriptorSize) {
+	Mat descriptors = Mat::zeros(cellRowCount, cellColumnCount, CV_32FC(descriptorSize));
+	for (int cellIndex = 0; cellIndex < histograms.rows; ++cellIndex) {
+		const float* histogramValues = histograms.ptr<float>(cellIndex);
+		float* descriptor = descriptors.ptr<float>(cellIndex / cellColumnCount, cellIndex % cellColumnCount);
+		std::copy(histogramValues, histogramValues + histograms.cols, descriptor);
+	}
+	return descriptors;
+}
+
+/**
+ * Determines whether two matrices have the same size, type and bits.
+ */
+bool isIdentical(const Mat& a, const Mat& b) {
+	if (a.size() != b.size() || a.type() != b.type())
+		return false;
+	size_t rowSize = a.cols * a.elemSize();
+	for (int row = 0; row < a.rows; ++row) {
+		if (std::memcmp(a.ptr(row), b.ptr(row), rowSize) != 0)
+			return false;
+	}
+	return true;
+}
+
+double toMilliseconds(Clock::duration duration) {
+	return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+void printTimes(const string& name, Clock::duration referenceTime, Clock::duration currentTime, int iterations) {
+	double referenceMilliseconds = toMilliseconds(referenceTime) / iterations;
+	double currentMilliseconds = toMilliseconds(currentTime) / iterations;
+	cout << std::left << std::setw(52) << name << std::right << std::fixed
+			<< std::setprecision(3) << std::setw(10) << referenceMilliseconds << "ms"
+			<< std::setprecision(3) << std::setw(10) << currentMilliseconds << "ms"
+			<< std::setprecision(2) << std::setw(8) << referenceMilliseconds / currentMilliseconds << 'x' << endl;
+}
+
+/**
+ * Compares ExtendedHogFilter::createDescriptors to the reference implementation.
+ */
+bool checkExtendedHog(int cellRowCount, int cellColumnCount, int binCount, bool signedAndUnsigned, float alpha, std::mt19937& generator) {
+	Mat histograms = createHistograms(cellRowCount, cellColumnCount, binCount, generator);
+	Mat referenceDescriptors, descriptors;
+	createDescriptorsReference(histograms, referenceDescriptors, binCount, signedAndUnsigned, cellRowCount, cellColumnCount, alpha);
+	HogBenchmark::createDescriptors(histograms, descriptors, binCount, signedAndUnsigned, cellRowCount, cellColumnCount, alpha);
+	return isIdentical(referenceDescriptors, descriptors);
+}
+
+/**
+ * Compares CompleteExtendedHogFilter::buildDescriptors to the reference implementation.
+ */
+bool checkCompleteExtendedHog(int cellRowCount, int cellColumnCount, int binCount, bool signedGradients, bool unsignedGradients,
+		float alpha, const CompleteExtendedHogFilter& filter, std::mt19937& generator) {
+	int descriptorSize = binCount + (signedGradients && unsignedGradients ? binCount / 2 : 0) + 4;
+	Mat histograms = createHistograms(cellRowCount, cellColumnCount, binCount, generator);
+	Mat referenceDescriptors = createInitialDescriptors(histograms, cellRowCount, cellColumnCount, descriptorSize);
+	Mat descriptors = referenceDescriptors.clone();
+	buildDescriptorsReference(referenceDescriptors, cellRowCount, cellColumnCount, descriptorSize, binCount, signedGradients, unsignedGradients, alpha);
+	HogBenchmark::buildDescriptors(filter, descriptors, cellRowCount, cellColumnCount, descriptorSize);
+	return isIdentical(referenceDescriptors, descriptors);
+}
+
+void benchmarkExtendedHog(const string& name, int cellRowCount, int cellColumnCount, int binCount, bool signedAndUnsigned,
+		float alpha, int iterations, std::mt19937& generator) {
+	Mat histograms = createHistograms(cellRowCount, cellColumnCount, binCount, generator);
+	Mat descriptors;
+	Clock::time_point start = Clock::now();
+	for (int i = 0; i < iterations; ++i)
+		createDescriptorsReference(histograms, descriptors, binCount, signedAndUnsigned, cellRowCount, cellColumnCount, alpha);
+	Clock::duration referenceTime = Clock::now() - start;
+	start = Clock::now();
+	for (int i = 0; i < iterations; ++i)
+		HogBenchmark::createDescriptors(histograms, descriptors, binCount, signedAndUnsigned, cellRowCount, cellColumnCount, alpha);
+	Clock::duration currentTime = Clock::now() - start;
+	printTimes(name, referenceTime, currentTime, iterations);
+}
+
+void benchmarkCompleteExtendedHog(const string& name, int cellRowCount, int cellColumnCount, int binCount, bool signedGradients,
+		bool unsignedGradients, float alpha, const CompleteExtendedHogFilter& filter, int iterations, std::mt19937& generator) {
+	int descriptorSize = binCount + (signedGradients && unsignedGradients ? binCount / 2 : 0) + 4;
+	Mat histograms = createHistograms(cellRowCount, cellColumnCount, binCount, generator);
+	Mat initialDescriptors = createInitialDescriptors(histograms, cellRowCount, cellColumnCount, descriptorSize);
+	Mat descriptors;
+	// the descriptors are built in-place, so the histograms have to be restored before each iteration (not measured)
+	Clock::duration referenceTime = Clock::duration::zero();
+	for (int i = 0; i < iterations; ++i) {
+		initialDescriptors.copyTo(descriptors);
+		Clock::time_point start = Clock::now();
+		buildDescriptorsReference(descriptors, cellRowCount, cellColumnCount, descriptorSize, binCount, signedGradients, unsignedGradients, alpha);
+		referenceTime += Clock::now() - start;
+	}
+	Clock::duration currentTime = Clock::duration::zero();
+	for (int i = 0; i < iterations; ++i) {
+		initialDescriptors.copyTo(descriptors);
+		Clock::time_point start = Clock::now();
+		HogBenchmark::buildDescriptors(filter, descriptors, cellRowCount, cellColumnCount, descriptorSize);
+		currentTime += Clock::now() - start;
+	}
+	printTimes(name, referenceTime, currentTime, iterations);
+}
+
+/**
+ * Verifies that the descriptors of ExtendedHogFilter and CompleteExtendedHogFilter are bit-identical to those of
+ * the reference implementations (for several grid sizes including single rows and columns) and measures the time
+ * of both implementations.
+ */
+int main(int argc, char *argv[]) {
+	int cellRowCount;
+	int cellColumnCount;
+	int binCount;
+	float alpha;
+	int iterations;
+	unsigned int seed;
+	try {
+		po::options_description description("Allowed options");
+		description.add_options()
+			("help,h", "produce help message")
+			("rows,r", po::value<int>(&cellRowCount)->default_value(60), "cell row count of the measured grid")
+			("cols,c", po::value<int>(&cellColumnCount)->default_value(80), "cell column count of the measured grid")
+			("bins,b", po::value<int>(&binCount)->default_value(18), "bin count of the histograms (must be even)")
+			("alpha,a", po::value<float>(&alpha)->default_value(0.2f), "truncation threshold of the normalized bin values")
+			("iterations,n", po::value<int>(&iterations)->default_value(100), "number of measured iterations")
+			("seed,s", po::value<unsigned int>(&seed)->default_value(42), "seed of the random histograms");
+		po::variables_map variables;
+		po::store(po::parse_command_line(argc, argv, description), variables);
+		if (variables.count("help")) {
+			cout << "Usage: hogBenchmarkTool [options]" << endl;
+			cout << description;
+			return EXIT_SUCCESS;
+		}
+		po::notify(variables);
+		if (cellRowCount <= 0 || cellColumnCount <= 0 || binCount <= 0 || binCount % 2 != 0 || iterations <= 0)
+			throw po::error("the grid size, bin count and iterations must be greater than zero and the bin count must be even");
+	} catch (po::error& e) {
+		cout << "Error while parsing command-line arguments: " << e.what() << endl;
+		cout << "Use --help to display a list of options." << endl;
+		return EXIT_FAILURE;
+	}
+
+	std::mt19937 generator(seed);
+	vector<pair<int, int>> gridSizes = { { 1, 1 }, { 1, 7 }, { 7, 1 }, { 2, 2 }, { 5, 9 }, { cellRowCount, cellColumnCount } };
+	vector<pair<bool, bool>> gradients = { { true, true }, { true, false }, { false, true } };
+	bool identical = true;
+
+	for (bool signedAndUnsigned : { true, false }) {
+		string name = string("ExtendedHogFilter") + (signedAndUnsigned ? " (signed and unsigned)" : " (plain)");
+		for (const pair<int, int>& gridSize : gridSizes) {
+			if (!checkExtendedHog(gridSize.first, gridSize.second, binCount, signedAndUnsigned, alpha, generator)) {
+				cout << name << ": descriptors of " << gridSize.first << "x" << gridSize.second << " cells differ from the reference" << endl;
+				identical = false;
+			}
+		}
+	}
+	for (const pair<bool, bool>& gradient : gradients) {
+		auto filter = make_shared<CompleteExtendedHogFilter>(8, binCount, gradient.first, gradient.second, false, true, alpha);
+		string name = string("CompleteExtendedHogFilter") + (gradient.first ? (gradient.second ? " (signed and unsigned)" : " (signed)") : " (unsigned)");
+		for (const pair<int, int>& gridSize : gridSizes) {
+			if (!checkCompleteExtendedHog(gridSize.first, gridSize.second, binCount, gradient.first, gradient.second, alpha, *filter, generator)) {
+				cout << name << ": descriptors of " << gridSize.first << "x" << gridSize.second << " cells differ from the reference" << endl;
+				identical = false;
+			}
+		}
+	}
+	if (!identical)
+		return EXIT_FAILURE;
+	cout << "Descriptors are bit-identical to the reference implementations." << endl << endl;
+
+	cout << "Time per call for " << cellRowCount << "x" << cellColumnCount << " cells with " << binCount << " bins (reference, current, speed-up):" << endl;
+	for (bool signedAndUnsigned : { true, false }) {
+		string name = string("ExtendedHogFilter::createDescriptors") + (signedAndUnsigned ? " (s+u)" : " (plain)");
+		benchmarkExtendedHog(name, cellRowCount, cellColumnCount, binCount, signedAndUnsigned, alpha, iterations, generator);
+	}
+	for (const pair<bool, bool>& gradient : gradients) {
+		auto filter = make_shared<CompleteExtendedHogFilter>(8, binCount, gradient.first, gradient.second, false, true, alpha);
+		string name = string("CompleteExtendedHogFilter::buildDescriptors") + (gradient.first ? (gradient.second ? " (s+u)" : " (s)") : " (u)");
+		benchmarkCompleteExtendedHog(name, cellRowCount, cellColumnCount, binCount, gradient.first, gradient.second, alpha, *filter, iterations, generator);
+	}
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,90 @@
+/*
+ * CachedConfidenceBasedExampleManagement.hpp
+ *
+ *  Created on: 18.10.2026
+ *      Author: poschmann
+ */
+
+#ifndef CACHEDCONFIDENCEBASEDEXAMPLEMANAGEMENT_HPP_
+#define CACHEDCONFIDENCEBASEDEXAMPLEMANAGEMENT_HPP_
+
+#include "classification/VectorBasedExampleManagement.hpp"
+#include <utility>
+
+namespace classification {
+
+class TrainableSvmClassifier;
+
+/**
+ * Example storage that, like ConfidenceBasedExampleManagement, replaces the training examples that have the
+ * highest confidence when reaching maximum size, but keeps the confidences of the stored training examples
+ * between calls to add. The confidences are only re-computed after the SVM was changed, which is done for all
+ * examples at once using a matrix that contains the feature vectors as consecutive rows. In case of a linear
+ * kernel, this boils down to a single matrix-vector multiplication. The first training examples will not be
+ * replaced (keeps the first example by default).
+ */
+class CachedConfidenceBasedExampleManagement : public VectorBasedExampleManagement {
+public:
+
+	/**
+	 * Constructs a new cached confidence based example management.
+	 *
+	 * @param[in] classifier SVM for computing the confidences of the training examples.
+	 * @param[in] positive Flag that indicates whether this set contains positive training examples.
+	 * @param[in] capacity Maximum amount of stored training examples.
+	 * @param[in] requiredSize Minimum amount of training examples required for training.
+	 */
+	CachedConfidenceBasedExampleManagement(const std::shared_ptr<TrainableSvmClassifier>& classifier,
+			bool positive, size_t capacity, size_t requiredSize = 1);
+
+	virtual ~CachedConfidenceBasedExampleManagement() {}
+
+	/**
+	 * Changes the number of initial training examples that should never be replaced.
+	 *
+	 * @param[in] keep The new number of initial training examples to never replace.
+	 */
+	void setFirstExamplesToKeep(size_t keep);
+
+	void add(const std::vector<cv::Mat>& newExamples);
+
+	void clear();
+
+private:
+
+	/**
+	 * Copies feature vectors into the rows of a matrix, converting them to single precision floating point values.
+	 *
+	 * @param[in] vectors Feature vectors.
+	 * @param[in,out] matrix Matrix with one row per feature vector.
+	 * @param[in] offset Index of the row the first feature vector is copied into.
+	 */
+	static void copyRows(const std::vector<cv::Mat>& vectors, cv::Mat& matrix, int offset = 0);
+
+	/**
+	 * Updates the SVM parameters and the scores of the stored training examples if the SVM changed since the last call.
+	 */
+	void updateScores();
+
+	/**
+	 * Computes the scores of feature vectors, which are high for confident classifications (positive or negative
+	 * depending on the type of stored training examples).
+	 *
+	 * @param[in] featureRows Matrix with one feature vector per row.
+	 * @return Scores of the feature vectors.
+	 */
+	std::vector<double> computeScores(const cv::Mat& featureRows) const;
+
+	const std::shared_ptr<TrainableSvmClassifier> classifier; ///< SVM for computing the confidences of the training examples.
+	bool positive; ///< Flag that indicates whether this set contains positive training examples.
+	size_t keep; ///< Number of initial training examples that are never replaced.
+	size_t capacity; ///< Maximum amount of stored training examples.
+	cv::Mat features; ///< Feature vectors of the stored training examples (one per row, single precision).
+	std::vector<double> scores; ///< Scores of the stored training examples.
+	size_t revision; ///< Revision of the SVM the scores were computed with.
+	cv::Mat supportVectors; ///< Support vectors of the SVM (one per row, single precision).
+	cv::Mat weights; ///< Weight vector of the SVM (only in case of a linear kernel).
+};
+
+} /* namespace classification */
+#endif /* CACHEDCONFIDENCEBASEDEXAMPLEMANAGEMENT_HPP_ */
@@ -0,0 +1,106 @@
+/*
+ * FeatureVectorStore.hpp
+ *
+ *  Created on: 18.10.2026
+ *      Author: poschmann
+ */
+
+#ifndef FEATUREVECTORSTORE_HPP_
+#define FEATUREVECTORSTORE_HPP_
+
+#include "opencv2/core/core.hpp"
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace classification {
+
+/**
+ * Read access to a binary file of feature vectors that was written by FeatureVectorStoreWriter.
+ *
+ * The file consists of a header (magic number, version, dimensions, count) followed by the values of all
+ * feature vectors as consecutive single precision floating point numbers in native byte order. Because every
+ * vector has the same size, single vectors can be accessed without reading the whole file. If the file is
+ * memory-mapped, the vectors are returned without copying.
+ */
+class FeatureVectorStore {
+public:
+
+	/**
+	 * Opens a feature vector store.
+	 *
+	 * @param[in] filename Name of the file.
+	 * @param[in] memoryMapped Flag that indicates whether the file should be memory-mapped instead of being read on demand.
+	 */
+	explicit FeatureVectorStore(const std::string& filename, bool memoryMapped = true);
+
+	~FeatureVectorStore();
+
+	FeatureVectorStore(const FeatureVectorStore&) = delete;
+
+	FeatureVectorStore& operator=(const FeatureVectorStore&) = delete;
+
+	/**
+	 * Determines whether a file is a feature vector store by checking its magic number.
+	 *
+	 * @param[in] filename Name of the file.
+	 * @return True if the file is a feature vector store, false otherwise (e.g. if it is a text file).
+	 */
+	static bool isStore(const std::string& filename);
+
+	/**
+	 * @return The number of feature vectors.
+	 */
+	size_t size() const {
+		return count;
+	}
+
+	/**
+	 * @return The number of values per feature vector.
+	 */
+	int getDimensions() const {
+		return dimensions;
+	}
+
+	/**
+	 * Retrieves a feature vector. In case of a memory-mapped file, the returned row vector refers to the mapped
+	 * memory and is only valid as long as this store exists. Otherwise the vector is read from the file.
+	 *
+	 * @param[in] index Index of the feature vector.
+	 * @return Row vector of type CV_32F.
+	 */
+	cv::Mat get(size_t index) const;
+
+	/**
+	 * Selects indices of feature vectors without repetition. The indices are ordered, so the vectors can be read
+	 * sequentially.
+	 *
+	 * @param[in] count Number of indices to select, will be capped to the number of feature vectors.
+	 * @param[in] generator Random number generator used for selecting the indices.
+	 * @return Ascending indices of randomly selected feature vectors.
+	 */
+	std::vector<size_t> sample(size_t count, std::mt19937& generator) const;
+
+	static const char magic[4]; ///< Magic number at the beginning of each file.
+	static const uint32_t version = 1; ///< Version of the file format.
+	static const std::streamoff headerSize = 20; ///< Size of the header in bytes.
+
+private:
+
+	/**
+	 * Memory mapping of the file.
+	 */
+	struct Mapping;
+
+	std::unique_ptr<Mapping> mapping; ///< Memory mapping of the file (null if the file is read on demand).
+	mutable std::ifstream file; ///< File that is read on demand (only if not memory-mapped).
+	const float* values; ///< Values of the memory-mapped feature vectors.
+	int dimensions; ///< The number of values per feature vector.
+	size_t count; ///< The number of feature vectors.
+};
+
+} /* namespace classification */
+#endif /* FEATUREVECTORSTORE_HPP_ */
@@ -0,0 +1,73 @@
+/*
+ * FeatureVectorStoreWriter.hpp
+ *
+ *  Created on: 18.10.2026
+ *      Author: poschmann
+ */
+
+#ifndef FEATUREVECTORSTOREWRITER_HPP_
+#define FEATUREVECTORSTOREWRITER_HPP_
+
+#include "opencv2/core/core.hpp"
+#include <fstream>
+#include <string>
+
+namespace classification {
+
+/**
+ * Writer of binary feature vector files that can be read by FeatureVectorStore. All feature vectors must have
+ * the same number of values, which are converted to single precision floating point numbers.
+ */
+class FeatureVectorStoreWriter {
+public:
+
+	/**
+	 * Creates a new feature vector file, overwriting any existing file of the same name.
+	 *
+	 * @param[in] filename Name of the file.
+	 */
+	explicit FeatureVectorStoreWriter(const std::string& filename);
+
+	/**
+	 * Completes the file if it was not closed before.
+	 */
+	~FeatureVectorStoreWriter();
+
+	FeatureVectorStoreWriter(const FeatureVectorStoreWriter&) = delete;
+
+	FeatureVectorStoreWriter& operator=(const FeatureVectorStoreWriter&) = delete;
+
+	/**
+	 * Appends a feature vector.
+	 *
+	 * @param[in] vector Feature vector with an arbitrary shape and depth that has as many values as the previous ones.
+	 */
+	void add(const cv::Mat& vector);
+
+	/**
+	 * Completes the header and closes the file.
+	 */
+	void close();
+
+	/**
+	 * @return The number of feature vectors written so far.
+	 */
+	size_t size() const {
+		return count;
+	}
+
+private:
+
+	/**
+	 * Writes the header containing the current dimensions and count.
+	 */
+	void writeHeader();
+
+	std::ofstream file; ///< The file stream.
+	int dimensions; ///< The number of values per feature vector (zero before the first vector was added).
+	size_t count; ///< The number of feature vectors written so far.
+	cv::Mat row; ///< Buffer for the conversion of feature vectors.
+};
+
+} /* namespace classification */
+#endif /* FEATUREVECTORSTOREWRITER_HPP_ */
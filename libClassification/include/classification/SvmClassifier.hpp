@@ -113,6 +113,13 @@ public:
 		return coefficients;
 	}
 
+	/**
+	 * @return The number of times the parameters of this SVM were changed, may be used to detect changes.
+	 */
+	size_t getRevision() const {
+		return revision;
+	}
+
 private:
 
 	/**
@@ -164,6 +171,7 @@ private:
 
 	std::vector<cv::Mat> supportVectors; ///< The support vectors.
 	std::vector<float> coefficients; ///< The coefficients of the support vectors.
+	size_t revision; ///< The number of times the parameters were changed.
 };
 
 } /* namespace classification */
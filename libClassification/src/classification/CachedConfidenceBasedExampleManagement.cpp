@@ -0,0 +1,159 @@
+/*
+ * CachedConfidenceBasedExampleManagement.cpp
+ *
+ *  Created on: 18.10.2026
+ *      Author: poschmann
+ */
+
+#include "classification/CachedConfidenceBasedExampleManagement.hpp"
+#include "classification/TrainableSvmClassifier.hpp"
+#include "classification/SvmClassifier.hpp"
+#include "classification/LinearKernel.hpp"
+#include <algorithm>
+#include <functional>
+
+using cv::Mat;
+using std::pair;
+using std::make_pair;
+using std::vector;
+using std::shared_ptr;
+
+namespace classification {
+
+CachedConfidenceBasedExampleManagement::CachedConfidenceBasedExampleManagement(
+		const shared_ptr<TrainableSvmClassifier>& classifier, bool positive, size_t capacity, size_t requiredSize) :
+				VectorBasedExampleManagement(capacity, requiredSize),
+				classifier(classifier),
+				positive(positive),
+				keep(1),
+				capacity(capacity),
+				features(),
+				scores(),
+				revision(static_cast<size_t>(-1)),
+				supportVectors(),
+				weights() {
+	scores.reserve(capacity);
+}
+
+void CachedConfidenceBasedExampleManagement::setFirstExamplesToKeep(size_t keep) {
+	this->keep = keep;
+}
+
+void CachedConfidenceBasedExampleManagement::clear() {
+	examples.clear();
+	scores.clear();
+}
+
+void CachedConfidenceBasedExampleManagement::add(const vector<Mat>& newExamples) {
+	if (newExamples.empty())
+		return;
+	updateScores();
+	Mat newFeatures(static_cast<int>(newExamples.size()), static_cast<int>(newExamples.front().total() * newExamples.front().channels()), CV_32F);
+	copyRows(newExamples, newFeatures);
+	vector<double> newScores = computeScores(newFeatures);
+	if (features.empty())
+		features.create(static_cast<int>(capacity), newFeatures.cols, CV_32F);
+
+	// heap of replaceable existing training examples with the highest confidence on top
+	vector<pair<double, size_t>> existingConfidences;
+	existingConfidences.reserve(examples.size());
+	for (size_t i = keep; i < examples.size(); ++i)
+		existingConfidences.push_back(make_pair(scores[i], i));
+	std::make_heap(existingConfidences.begin(), existingConfidences.end());
+	// heap of new training examples with the lowest confidence on top
+	vector<pair<double, size_t>> newConfidences;
+	newConfidences.reserve(newExamples.size());
+	for (size_t i = 0; i < newExamples.size(); ++i)
+		newConfidences.push_back(make_pair(newScores[i], i));
+	std::greater<pair<double, size_t>> lowestOnTop;
+	std::make_heap(newConfidences.begin(), newConfidences.end(), lowestOnTop);
+
+	// add new examples until there is no more space, then replace existing examples that have higher confidence than new examples
+	while (examples.size() < capacity && !newConfidences.empty()) {
+		std::pop_heap(newConfidences.begin(), newConfidences.end(), lowestOnTop);
+		size_t newIndex = newConfidences.back().second;
+		newConfidences.pop_back();
+		newFeatures.row(newIndex).copyTo(features.row(static_cast<int>(examples.size())));
+		examples.push_back(newExamples[newIndex]);
+		scores.push_back(newScores[newIndex]);
+	}
+	while (!existingConfidences.empty() && !newConfidences.empty()
+			&& newConfidences.front().first < existingConfidences.front().first) {
+		std::pop_heap(existingConfidences.begin(), existingConfidences.end());
+		std::pop_heap(newConfidences.begin(), newConfidences.end(), lowestOnTop);
+		size_t existingIndex = existingConfidences.back().second;
+		size_t newIndex = newConfidences.back().second;
+		existingConfidences.pop_back();
+		newConfidences.pop_back();
+		newFeatures.row(newIndex).copyTo(features.row(existingIndex));
+		examples[existingIndex] = newExamples[newIndex];
+		scores[existingIndex] = newScores[newIndex];
+	}
+}
+
+void CachedConfidenceBasedExampleManagement::copyRows(const vector<Mat>& vectors, Mat& matrix, int offset) {
+	for (size_t i = 0; i < vectors.size(); ++i) {
+		const Mat& vector = vectors[i];
+		Mat row = matrix.row(offset + i);
+		if (vector.isContinuous())
+			vector.reshape(1, 1).convertTo(row, CV_32F);
+		else
+			vector.clone().reshape(1, 1).convertTo(row, CV_32F);
+	}
+}
+
+void CachedConfidenceBasedExampleManagement::updateScores() {
+	const SvmClassifier& svm = *classifier->getSvm();
+	if (revision == svm.getRevision())
+		return;
+	revision = svm.getRevision();
+	const vector<Mat>& vectors = svm.getSupportVectors();
+	const vector<float>& coefficients = svm.getCoefficients();
+	if (vectors.empty()) {
+		supportVectors = Mat();
+		weights = Mat();
+	} else {
+		supportVectors.create(static_cast<int>(vectors.size()), static_cast<int>(vectors.front().total() * vectors.front().channels()), CV_32F);
+		copyRows(vectors, supportVectors);
+		if (dynamic_cast<const LinearKernel*>(svm.getKernel().get())) {
+			// collapse the support vectors into a single weight vector
+			weights = Mat::zeros(1, supportVectors.cols, CV_32F);
+			for (int i = 0; i < supportVectors.rows; ++i)
+				cv::scaleAdd(supportVectors.row(i), coefficients[i], weights, weights);
+		} else {
+			weights = Mat();
+		}
+	}
+	if (!examples.empty())
+		scores = computeScores(features.rowRange(0, static_cast<int>(examples.size())));
+}
+
+vector<double> CachedConfidenceBasedExampleManagement::computeScores(const Mat& featureRows) const {
+	const SvmClassifier& svm = *classifier->getSvm();
+	double sign = positive ? 1 : -1;
+	vector<double> scores(featureRows.rows, -sign * svm.getBias());
+	if (featureRows.rows == 0 || supportVectors.empty())
+		return scores;
+	if (!weights.empty()) {
+		Mat distances;
+		cv::gemm(featureRows, weights, 1, Mat(), 0, distances, cv::GEMM_2_T);
+		for (int i = 0; i < featureRows.rows; ++i)
+			scores[i] += sign * distances.at<float>(i, 0);
+	} else {
+		const Kernel& kernel = *svm.getKernel();
+		const vector<float>& coefficients = svm.getCoefficients();
+		for (int i = 0; i < featureRows.rows; ++i) {
+			// headers without the sub-matrix flag, as kernels expect arguments with identical flags
+			Mat feature(1, featureRows.cols, CV_32F, const_cast<float*>(featureRows.ptr<float>(i)));
+			double distance = 0;
+			for (int j = 0; j < supportVectors.rows; ++j) {
+				Mat supportVector(1, supportVectors.cols, CV_32F, const_cast<float*>(supportVectors.ptr<float>(j)));
+				distance += coefficients[j] * kernel.compute(feature, supportVector);
+			}
+			scores[i] += sign * distance;
+		}
+	}
+	return scores;
+}
+
+} /* namespace classification */
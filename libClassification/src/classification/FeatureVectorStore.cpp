@@ -0,0 +1,100 @@
+/*
+ * FeatureVectorStore.cpp
+ *
+ *  Created on: 18.10.2026
+ *      Author: poschmann
+ */
+
+#include "classification/FeatureVectorStore.hpp"
+#include "boost/interprocess/file_mapping.hpp"
+#include "boost/interprocess/mapped_region.hpp"
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+#include <stdexcept>
+
+using cv::Mat;
+using std::string;
+using std::vector;
+using std::invalid_argument;
+using std::runtime_error;
+
+namespace classification {
+
+const char FeatureVectorStore::magic[4] = { 'F', 'V', 'S', 'T' };
+
+struct FeatureVectorStore::Mapping {
+	Mapping(const string& filename, std::streamoff offset, size_t size) :
+			file(filename.c_str(), boost::interprocess::read_only),
+			region(file, boost::interprocess::read_only, offset, size) {}
+	boost::interprocess::file_mapping file;
+	boost::interprocess::mapped_region region;
+};
+
+FeatureVectorStore::FeatureVectorStore(const string& filename, bool memoryMapped) :
+		mapping(), file(), values(nullptr), dimensions(0), count(0) {
+	std::ifstream headerFile(filename, std::ios::binary);
+	if (!headerFile)
+		throw runtime_error("FeatureVectorStore: could not open file '" + filename + "'");
+	char fileMagic[4];
+	uint32_t fileVersion, fileDimensions;
+	uint64_t fileCount;
+	headerFile.read(fileMagic, sizeof(fileMagic));
+	headerFile.read(reinterpret_cast<char*>(&fileVersion), sizeof(fileVersion));
+	headerFile.read(reinterpret_cast<char*>(&fileDimensions), sizeof(fileDimensions));
+	headerFile.read(reinterpret_cast<char*>(&fileCount), sizeof(fileCount));
+	if (!headerFile || std::memcmp(fileMagic, magic, sizeof(magic)) != 0)
+		throw invalid_argument("FeatureVectorStore: '" + filename + "' is no feature vector store");
+	if (fileVersion != version)
+		throw invalid_argument("FeatureVectorStore: unsupported version of '" + filename + "'");
+	headerFile.close();
+	dimensions = static_cast<int>(fileDimensions);
+	count = static_cast<size_t>(fileCount);
+	if (memoryMapped) {
+		if (count > 0) {
+			mapping.reset(new Mapping(filename, headerSize, count * dimensions * sizeof(float)));
+			values = static_cast<const float*>(mapping->region.get_address());
+		}
+	} else {
+		file.open(filename, std::ios::binary);
+		if (!file)
+			throw runtime_error("FeatureVectorStore: could not open file '" + filename + "'");
+	}
+}
+
+FeatureVectorStore::~FeatureVectorStore() {}
+
+bool FeatureVectorStore::isStore(const string& filename) {
+	std::ifstream file(filename, std::ios::binary);
+	char fileMagic[4];
+	file.read(fileMagic, sizeof(fileMagic));
+	return file && std::memcmp(fileMagic, magic, sizeof(magic)) == 0;
+}
+
+Mat FeatureVectorStore::get(size_t index) const {
+	if (index >= count)
+		throw invalid_argument("FeatureVectorStore: index out of range");
+	if (values)
+		return Mat(1, dimensions, CV_32F, const_cast<float*>(values + index * dimensions));
+	Mat vector(1, dimensions, CV_32F);
+	file.seekg(headerSize + static_cast<std::streamoff>(index * dimensions * sizeof(float)));
+	file.read(reinterpret_cast<char*>(vector.ptr<float>()), dimensions * sizeof(float));
+	if (!file)
+		throw runtime_error("FeatureVectorStore: could not read feature vector");
+	return vector;
+}
+
+vector<size_t> FeatureVectorStore::sample(size_t count, std::mt19937& generator) const {
+	count = std::min(count, this->count);
+	vector<size_t> indices(this->count);
+	std::iota(indices.begin(), indices.end(), 0);
+	for (size_t i = 0; i < count; ++i) { // partial Fisher-Yates shuffle
+		std::uniform_int_distribution<size_t> distribution(i, indices.size() - 1);
+		std::swap(indices[i], indices[distribution(generator)]);
+	}
+	indices.resize(count);
+	std::sort(indices.begin(), indices.end());
+	return indices;
+}
+
+} /* namespace classification */
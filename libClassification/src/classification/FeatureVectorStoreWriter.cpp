@@ -0,0 +1,63 @@
+/*
+ * FeatureVectorStoreWriter.cpp
+ *
+ *  Created on: 18.10.2026
+ *      Author: poschmann
+ */
+
+#include "classification/FeatureVectorStoreWriter.hpp"
+#include "classification/FeatureVectorStore.hpp"
+#include <stdexcept>
+
+using cv::Mat;
+using std::string;
+using std::invalid_argument;
+using std::runtime_error;
+
+namespace classification {
+
+FeatureVectorStoreWriter::FeatureVectorStoreWriter(const string& filename) :
+		file(filename, std::ios::binary | std::ios::trunc), dimensions(0), count(0), row() {
+	if (!file)
+		throw runtime_error("FeatureVectorStoreWriter: could not create file '" + filename + "'");
+	writeHeader();
+}
+
+FeatureVectorStoreWriter::~FeatureVectorStoreWriter() {
+	if (file.is_open())
+		close();
+}
+
+void FeatureVectorStoreWriter::add(const Mat& vector) {
+	int vectorDimensions = static_cast<int>(vector.total() * vector.channels());
+	if (dimensions == 0)
+		dimensions = vectorDimensions;
+	else if (vectorDimensions != dimensions)
+		throw invalid_argument("FeatureVectorStoreWriter: all feature vectors must have the same number of values");
+	if (vector.isContinuous())
+		vector.reshape(1, 1).convertTo(row, CV_32F);
+	else
+		vector.clone().reshape(1, 1).convertTo(row, CV_32F);
+	file.write(reinterpret_cast<const char*>(row.ptr<float>()), dimensions * sizeof(float));
+	if (!file)
+		throw runtime_error("FeatureVectorStoreWriter: could not write feature vector");
+	++count;
+}
+
+void FeatureVectorStoreWriter::close() {
+	file.seekp(0);
+	writeHeader();
+	file.close();
+}
+
+void FeatureVectorStoreWriter::writeHeader() {
+	uint32_t version = FeatureVectorStore::version;
+	uint32_t fileDimensions = static_cast<uint32_t>(dimensions);
+	uint64_t fileCount = static_cast<uint64_t>(count);
+	file.write(FeatureVectorStore::magic, sizeof(FeatureVectorStore::magic));
+	file.write(reinterpret_cast<const char*>(&version), sizeof(version));
+	file.write(reinterpret_cast<const char*>(&fileDimensions), sizeof(fileDimensions));
+	file.write(reinterpret_cast<const char*>(&fileCount), sizeof(fileCount));
+}
+
+} /* namespace classification */
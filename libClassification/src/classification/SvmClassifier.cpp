@@ -31,7 +31,7 @@ using std::runtime_error;
 namespace classification {
 
 SvmClassifier::SvmClassifier(shared_ptr<Kernel> kernel) :
-		VectorMachineClassifier(kernel), supportVectors(), coefficients() {}
+		VectorMachineClassifier(kernel), supportVectors(), coefficients(), revision(0) {}
 
 bool SvmClassifier::classify(const Mat& featureVector) const {
 	return classify(computeHyperplaneDistance(featureVector));
@@ -63,6 +63,7 @@ void SvmClassifier::setSvmParameters(vector<Mat> supportVectors, vector<float> c
 	this->supportVectors = supportVectors;
 	this->coefficients = coefficients;
 	this->bias = bias;
+	++revision;
 }
 
 void SvmClassifier::store(std::ofstream& file) {
@@ -52,6 +52,18 @@ public:
 
 	void evaluate(std::shared_ptr<imageprocessing::VersionedImage> image, std::vector<std::shared_ptr<Sample>>& samples);
 
+	/**
+	 * Changes whether the feature extractor only computes features within the bounds of the samples when evaluating
+	 * several samples at once. Must only be enabled if the feature extractor is not used for anything else. Pyramid
+	 * based feature extractors with layer filters need to know the padding of the region of interest (see
+	 * ImagePyramid::setRegionOfInterestPadding), otherwise they refuse the region of interest.
+	 *
+	 * @param[in] restrictToSamples Flag that indicates whether features are only computed within the bounds of the samples.
+	 */
+	void setRestrictToSamples(bool restrictToSamples) {
+		this->restrictToSamples = restrictToSamples;
+	}
+
 private:
 
 	std::shared_ptr<imageprocessing::FeatureExtractor> featureExtractor; ///< The feature extractor.
@@ -59,6 +71,7 @@ private:
 	std::shared_ptr<classification::ProbabilisticSvmClassifier> svm; ///< The slower SVM.
 	//std::shared_ptr<imageprocessing::OverlapElimination> oe; ///< The overlap elimination algorithm. TODO
 	mutable std::unordered_map<std::shared_ptr<imageprocessing::Patch>, std::pair<bool, double>> cache; ///< The cache of the WVM classification results.
+	bool restrictToSamples; ///< Flag that indicates whether features are only computed within the bounds of the evaluated samples.
 };
 
 } /* namespace condensation */
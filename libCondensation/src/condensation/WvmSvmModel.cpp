@@ -23,6 +23,7 @@ using classification::ProbabilisticWvmClassifier;
 using classification::ProbabilisticSvmClassifier;
 using detection::ClassifiedPatch;
 using boost::make_indirect_iterator;
+using cv::Rect;
 using std::pair;
 using std::vector;
 using std::greater;
@@ -34,9 +35,11 @@ namespace condensation {
 
 WvmSvmModel::WvmSvmModel(shared_ptr<FeatureExtractor> featureExtractor,
 		shared_ptr<ProbabilisticWvmClassifier> wvm, shared_ptr<ProbabilisticSvmClassifier> svm) :
-		featureExtractor(featureExtractor), wvm(wvm), svm(svm), cache() {}
+		featureExtractor(featureExtractor), wvm(wvm), svm(svm), cache(), restrictToSamples(false) {}
 
 void WvmSvmModel::update(shared_ptr<VersionedImage> image) {
+	if (restrictToSamples) // single samples might be anywhere
+		featureExtractor->setRegionOfInterest(Rect());
 	cache.clear();
 	featureExtractor->update(image);
 }
@@ -67,7 +70,16 @@ void WvmSvmModel::evaluate(Sample& sample) const {
 }
 
 void WvmSvmModel::evaluate(shared_ptr<VersionedImage> image, vector<shared_ptr<Sample>>& samples) {
-	update(image);
+	if (restrictToSamples && !samples.empty()) {
+		Rect sampleBounds = samples.front()->getBounds();
+		for (const shared_ptr<Sample>& sample : samples)
+			sampleBounds |= sample->getBounds();
+		featureExtractor->setRegionOfInterest(sampleBounds);
+		cache.clear();
+		featureExtractor->update(image);
+	} else {
+		update(image);
+	}
 	vector<shared_ptr<ClassifiedPatch>> remainingPatches;
 	unordered_map<shared_ptr<Patch>, vector<Sample*>> patch2samples;
 	for (shared_ptr<Sample> sample : samples) {
@@ -10,6 +10,7 @@
 #define SLIDINGWINDOWDETECTOR_HPP_
 
 #include "detection/Detector.hpp"
+#include "imageprocessing/PatchBatch.hpp"
 
 namespace classification {
 	class ProbabilisticClassifier;
@@ -25,11 +26,51 @@ namespace detection {
 
 /**
  * Detector that runs over an image with a sliding window of a fixed size and uses a classifier to classify every patch.
+ *
+ * The windows are extracted into a batch that is re-used between detections to avoid allocations, so a detector
+ * must not be used by several threads at the same time (not even the const member functions). The returned patches
+ * are copies and stay valid after the next detection.
  * TODO: What do we do with BinaryClassifier/ProbabilisticClassifier? Do we also make two different SlidingWindowDetectors?
  */
 class SlidingWindowDetector : public Detector {
 public:
 
+	/**
+	 * Classifier output of every sliding window position of a pyramid layer.
+	 */
+	struct ProbabilityMap {
+		int layerIndex;        ///< The index of the pyramid layer.
+		double scaleFactor;    ///< The scale factor of the pyramid layer compared to the original image.
+		cv::Size windowSize;   ///< The size of the windows in the original image.
+		cv::Point firstCenter; ///< The center of the top-left window in the original image.
+		cv::Point2d step;      ///< The distance between the centers of adjacent windows in the original image.
+		Mat probabilities;     ///< The probability of each window (CV_32FC1), one element per position.
+		Mat positives;         ///< Flags that indicate positively classified windows (CV_8UC1, 255 if positive, 0 otherwise).
+
+		/**
+		 * Determines the center of a window in the original image.
+		 *
+		 * @param[in] row The row of the window inside the map.
+		 * @param[in] col The column of the window inside the map.
+		 * @return The center of the window in the original image.
+		 */
+		cv::Point getCenter(int row, int col) const {
+			return cv::Point(cvRound(firstCenter.x + col * step.x), cvRound(firstCenter.y + row * step.y));
+		}
+
+		/**
+		 * Determines the bounds of a window in the original image.
+		 *
+		 * @param[in] row The row of the window inside the map.
+		 * @param[in] col The column of the window inside the map.
+		 * @return The bounds of the window in the original image.
+		 */
+		Rect getBounds(int row, int col) const {
+			cv::Point center = getCenter(row, col);
+			return Rect(center.x - windowSize.width / 2, center.y - windowSize.height / 2, windowSize.width, windowSize.height);
+		}
+	};
+
 	/**
 	 * Constructs a new sliding window detector.
 	 *
@@ -80,13 +121,24 @@ public:
 	 */
 	vector<shared_ptr<ClassifiedPatch>> detect(shared_ptr<VersionedImage> image);
 
+	/**
+	 * Processes the image in a sliding window fashion and return a probability map for each scale. The windows of
+	 * all layers are extracted into one batch and the maps are sized by the patch grid of each layer reported by the
+	 * feature extractor. The windows are classified in parallel, distributing the rows of each map across threads,
+	 * so the classifier must be safe to use concurrently.
+	 *
+	 * @param[in] image The image to process.
+	 * @return A probability map for each scale, beginning from the largest layer (smallest windows).
+	 */
+	vector<ProbabilityMap> calculateProbabilityMaps(const Mat& image);
+
 	/**
 	 * Processes the image in a sliding window fashion and return a probability map for each scale.
 	 *
 	 * @param[in] image The image to process.
-	 * @return A probability map for each scale.
+	 * @return A probability map for each scale, beginning from the largest layer (smallest windows).
 	 */
-	vector<Mat> calculateProbabilityMaps(const Mat& image);
+	vector<ProbabilityMap> calculateProbabilityMaps(shared_ptr<VersionedImage> image);
 
 	// Todo: I think we shouldn't expose this function, because the featureExtractor is not up-to-date, as
 	// long as detect(...) is not called? Why was this needed in the first place?
@@ -97,16 +149,27 @@ public:
 private:
 
 	/**
-	 * Classifies each image patch extracted by a sliding window approach.
+	 * Classifies each image patch extracted by a sliding window approach. Not thread-safe, as the extracted patches
+	 * are written into the shared batch.
 	 *
 	 * @return TODO
 	 */
 	vector<shared_ptr<ClassifiedPatch>> detect() const;
 
+	/**
+	 * Classifies the windows of each pyramid layer of the current image.
+	 *
+	 * @return A probability map for each scale.
+	 */
+	vector<ProbabilityMap> calculateProbabilityMaps() const;
+
+	class RowClassification; ///< Classifies the windows of a range of map rows, used with cv::parallel_for_.
+
 	shared_ptr<ProbabilisticClassifier> classifier;	///< The classifier that is used to evaluate every step of the sliding window.
 	shared_ptr<PyramidFeatureExtractor> featureExtractor;	///< The image pyramid based feature extractor.
 	int stepSizeX;	///< The step-size in pixels which the detector should move forward in x direction in every step. Default 1.
 	int stepSizeY;	///< The step-size in pixels which the detector should move forward in y direction in every step. Default 1.
+	mutable imageprocessing::PatchBatch patchBatch;	///< The patches of the last detection, re-used to avoid allocations (makes the detection non-reentrant).
 
 };
 
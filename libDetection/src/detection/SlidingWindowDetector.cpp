@@ -16,6 +16,8 @@
 #include "opencv2/core/core.hpp"
 #include "opencv2/imgproc/imgproc.hpp"
 #include "opencv2/highgui/highgui.hpp"
+#include <algorithm>
+#include <stdexcept>
 
 using imageprocessing::PyramidFeatureExtractor;
 using imagelogging::ImageLogger;
@@ -24,6 +26,36 @@ using std::make_shared;
 
 namespace detection {
 
+class SlidingWindowDetector::RowClassification : public cv::ParallelLoopBody {
+public:
+
+	RowClassification(const ProbabilisticClassifier& classifier, const imageprocessing::PatchBatch& patches,
+			size_t firstIndex, Mat& probabilities, Mat& positives) :
+					classifier(classifier), patches(patches), firstIndex(firstIndex),
+					probabilities(probabilities), positives(positives) {}
+
+	void operator()(const cv::Range& range) const override {
+		for (int row = range.start; row < range.end; ++row) {
+			float* probability = probabilities.ptr<float>(row);
+			uchar* positive = positives.ptr<uchar>(row);
+			size_t index = firstIndex + static_cast<size_t>(row) * probabilities.cols;
+			for (int col = 0; col < probabilities.cols; ++col, ++index) {
+				pair<bool, double> result = classifier.getProbability(patches[index].getData());
+				probability[col] = static_cast<float>(result.second);
+				positive[col] = result.first ? 255 : 0;
+			}
+		}
+	}
+
+private:
+
+	const ProbabilisticClassifier& classifier;
+	const imageprocessing::PatchBatch& patches;
+	size_t firstIndex;
+	Mat& probabilities;
+	Mat& positives;
+};
+
 SlidingWindowDetector::SlidingWindowDetector(shared_ptr<ProbabilisticClassifier> classifier, shared_ptr<PyramidFeatureExtractor> featureExtractor, int stepSizeX, int stepSizeY) :
 		classifier(classifier), featureExtractor(featureExtractor), stepSizeX(stepSizeX), stepSizeY(stepSizeY)
 {
@@ -67,12 +99,12 @@ vector<shared_ptr<ClassifiedPatch>> SlidingWindowDetector::detect(const Mat& ima
 	imageLogger.intermediate(scalesImage, bind(drawRects, scalesImage, patchSizes), "00scales"); // Note: Another option: We could "send" the logger the scale-info here. It could then draw it into the output image, depending on a config-flag if it should draw it. Optimally: Only get & send the scale-info if loglevel>xyz... i.e. the info is actually outputted. But that kind of is another concept than the current loglevels, e.g. it is a separate switch...
 
 	vector<shared_ptr<ClassifiedPatch>> classifiedPatches;
-	vector<shared_ptr<Patch>> pyramidPatches = featureExtractor->extract(stepSizeX, stepSizeY, roi);
+	featureExtractor->extract(patchBatch, stepSizeX, stepSizeY, roi);
 
-	for (unsigned int i = 0; i < pyramidPatches.size(); ++i) {
-		pair<bool, double> res = classifier->getProbability(pyramidPatches[i]->getData());
-		if(res.first==true)
-			classifiedPatches.push_back(make_shared<ClassifiedPatch>(pyramidPatches[i], res));
+	for (const Patch& patch : patchBatch) {
+		pair<bool, double> res = classifier->getProbability(patch.getData());
+		if(res.first==true) // the data of the batch is overwritten with the next detection, so the patch is copied
+			classifiedPatches.push_back(make_shared<ClassifiedPatch>(make_shared<Patch>(patch), res));
 	}
 	return classifiedPatches;
 }
@@ -87,23 +119,66 @@ vector<shared_ptr<ClassifiedPatch>> SlidingWindowDetector::detect(shared_ptr<Ver
 vector<shared_ptr<ClassifiedPatch>> SlidingWindowDetector::detect() const
 {
 	vector<shared_ptr<ClassifiedPatch>> classifiedPatches;
-	vector<shared_ptr<Patch>> pyramidPatches = featureExtractor->extract(stepSizeX, stepSizeY);
+	featureExtractor->extract(patchBatch, stepSizeX, stepSizeY);
 
-	for (unsigned int i = 0; i < pyramidPatches.size(); ++i) {
-		pair<bool, double> res = classifier->getProbability(pyramidPatches[i]->getData());
-		if(res.first==true)
-			classifiedPatches.push_back(make_shared<ClassifiedPatch>(pyramidPatches[i], res));
+	for (const Patch& patch : patchBatch) {
+		pair<bool, double> res = classifier->getProbability(patch.getData());
+		if(res.first==true) // the data of the batch is overwritten with the next detection, so the patch is copied
+			classifiedPatches.push_back(make_shared<ClassifiedPatch>(make_shared<Patch>(patch), res));
 	}
 	return classifiedPatches;
 }
 
-vector<Mat> SlidingWindowDetector::calculateProbabilityMaps(const Mat& image)
+vector<SlidingWindowDetector::ProbabilityMap> SlidingWindowDetector::calculateProbabilityMaps(const Mat& image)
 {
-	//for(auto currentPyramidLayer : featureExtractor->getPyramid()->getLayers()) {
-		//Mat tmp = currentPyramidLayer->getScaledImage();
-	//}
-	vector<Mat> tmp;
-	return tmp;
+	featureExtractor->update(image);
+	return calculateProbabilityMaps();
+}
+
+vector<SlidingWindowDetector::ProbabilityMap> SlidingWindowDetector::calculateProbabilityMaps(shared_ptr<VersionedImage> image)
+{
+	featureExtractor->update(image);
+	return calculateProbabilityMaps();
+}
+
+vector<SlidingWindowDetector::ProbabilityMap> SlidingWindowDetector::calculateProbabilityMaps() const
+{
+	// the windows of all layers are extracted into the batch at once, ordered by layer and row by row within each layer
+	featureExtractor->extract(patchBatch, stepSizeX, stepSizeY);
+	vector<pair<int, cv::Size>> gridSizes = featureExtractor->getPatchGridSizes(stepSizeX, stepSizeY);
+	vector<pair<int, double>> layerScales = featureExtractor->getLayerScales();
+	size_t patchCount = 0;
+	for (const pair<int, cv::Size>& gridSize : gridSizes)
+		patchCount += gridSize.second.area();
+	if (patchCount != patchBatch.size())
+		throw std::runtime_error("SlidingWindowDetector: the number of extracted windows does not match the grid sizes of the layers");
+
+	vector<ProbabilityMap> probabilityMaps;
+	size_t firstIndex = 0;
+	for (const pair<int, cv::Size>& gridSize : gridSizes) {
+		int rows = gridSize.second.height;
+		int cols = gridSize.second.width;
+		if (rows == 0 || cols == 0)
+			continue;
+		auto layerScale = std::find_if(layerScales.begin(), layerScales.end(), [&](const pair<int, double>& scale) {
+			return scale.first == gridSize.first;
+		});
+		const Patch& firstPatch = patchBatch[firstIndex];
+		ProbabilityMap probabilityMap;
+		probabilityMap.layerIndex = gridSize.first;
+		probabilityMap.scaleFactor = layerScale != layerScales.end() ? layerScale->second : 0;
+		probabilityMap.windowSize = cv::Size(firstPatch.getWidth(), firstPatch.getHeight());
+		probabilityMap.firstCenter = cv::Point(firstPatch.getX(), firstPatch.getY());
+		probabilityMap.step.x = cols > 1 ? static_cast<double>(patchBatch[firstIndex + cols - 1].getX() - firstPatch.getX()) / (cols - 1) : 0;
+		probabilityMap.step.y = rows > 1 ? static_cast<double>(patchBatch[firstIndex + (rows - 1) * cols].getY() - firstPatch.getY()) / (rows - 1) : 0;
+		probabilityMap.probabilities.create(rows, cols, CV_32FC1);
+		probabilityMap.positives.create(rows, cols, CV_8UC1);
+		cv::parallel_for_(cv::Range(0, rows), RowClassification(*classifier, patchBatch, firstIndex,
+				probabilityMap.probabilities, probabilityMap.positives));
+		probabilityMaps.push_back(probabilityMap);
+		firstIndex += static_cast<size_t>(rows) * cols;
+	}
+	return probabilityMaps;
 }
 
 } /* namespace detection */
@@ -32,7 +32,7 @@ namespace fitting {
  * @param[in] vertexIds An optional list of vertex ids if not all given imagePoints have a corresponding point in the model. TODO: Should this better be a map that is used in addition to the standard lookup?
  * @return A 3x4 affine camera matrix (the third row is [0, 0, 0, 1]).
  */
-cv::Mat estimateAffineCamera(std::vector<imageio::ModelLandmark> imagePoints, morphablemodel::MorphableModel morphableModel, std::vector<int> vertexIds=std::vector<int>());
+cv::Mat estimateAffineCamera(const std::vector<imageio::ModelLandmark>& imagePoints, const morphablemodel::MorphableModel& morphableModel, std::vector<int> vertexIds=std::vector<int>());
 
 /**
  * Takes a 3x4 affine camera matrix, calculates the
@@ -0,0 +1,81 @@
+/*
+ * LinearShapeFitter.hpp
+ *
+ *  Created on: 18.10.2026
+ *      Author: Patrik Huber
+ */
+#pragma once
+
+#ifndef LINEARSHAPEFITTER_HPP_
+#define LINEARSHAPEFITTER_HPP_
+
+#include "morphablemodel/MorphableModel.hpp"
+
+#include "imageio/ModelLandmark.hpp"
+
+#include "opencv2/core/core.hpp"
+
+#include "boost/optional.hpp"
+
+#include <string>
+#include <vector>
+
+namespace fitting {
+
+/**
+ * Linear, closed-form fitting of the shape of a Morphable Model to landmarks, the same as
+ * fitShapeToLandmarksLinear(...), but suited for fitting many images or video frames.
+ *
+ * The rows of the normalized PCA basis and of the mean belonging to the landmarks are
+ * gathered once and cached until the set of landmark identifiers changes. The camera is
+ * not placed into a block-diagonal matrix, instead its 3x3 part is applied to all landmark
+ * blocks of the basis with a single matrix multiplication. The regularised normal equations
+ * (numCoefficients x numCoefficients) are solved with a Cholesky decomposition.
+ *
+ * Not thread-safe, every thread should use its own fitter.
+ */
+class LinearShapeFitter {
+public:
+
+	/**
+	 * Constructs a new linear shape fitter.
+	 *
+	 * @param[in] morphableModel The Morphable Model whose shape (coefficients) are fitted.
+	 */
+	explicit LinearShapeFitter(const morphablemodel::MorphableModel& morphableModel);
+
+	/**
+	 * Fits the shape coefficients, see fitShapeToLandmarksLinear(...) for details.
+	 *
+	 * @param[in] affineCameraMatrix A 3x4 affine camera matrix from world to clip-space.
+	 * @param[in] landmarks 2D landmarks from an image, given in clip-coordinates.
+	 * @param[in] lambda The regularisation parameter (weight of the prior towards the mean).
+	 * @param[in] numCoefficientsToFit How many shape-coefficients to fit (all others will stay 0).
+	 * @param[in] detectorStandardDeviation The 2D standard deviation of the landmark detector used.
+	 * @param[in] modelStandardDeviation The 3D standard deviation of each corresponding point (vertex) in the 3D model.
+	 * @return The fitted shape-coefficients (alphas).
+	 */
+	std::vector<float> fit(cv::Mat affineCameraMatrix, const std::vector<imageio::ModelLandmark>& landmarks, float lambda=20.0f, boost::optional<int> numCoefficientsToFit=boost::optional<int>(), boost::optional<float> detectorStandardDeviation=boost::optional<float>(), boost::optional<float> modelStandardDeviation=boost::optional<float>());
+
+private:
+
+	/**
+	 * Gathers the basis and mean rows of the landmarks if they differ from the cached ones.
+	 *
+	 * @param[in] landmarks The landmarks whose vertices are needed.
+	 */
+	void updateLandmarkSubset(const std::vector<imageio::ModelLandmark>& landmarks);
+
+	morphablemodel::PcaModel shapeModel; ///< The shape model (shares the basis with the Morphable Model).
+	std::vector<std::string> landmarkIdentifiers; ///< Identifiers of the landmarks whose basis and mean are cached.
+	cv::Mat basis; ///< 3 x (L * m) CV_64F, row k contains the k-th coordinate rows of the normalized basis of all L landmarks.
+	cv::Mat mean; ///< 3 x L CV_64F, column i contains the mean of landmark i.
+	cv::Mat projectedBasis; ///< Buffer for the basis multiplied with the camera matrix.
+	cv::Mat projectedMean; ///< Buffer for the mean multiplied with the camera matrix.
+	cv::Mat normalMatrix; ///< Buffer for the regularised normal equation matrix.
+	cv::Mat rightHandSide; ///< Buffer for the right hand side of the normal equations.
+	cv::Mat coefficients; ///< Buffer for the solution of the normal equations.
+};
+
+} /* namespace fitting */
+#endif /* LINEARSHAPEFITTER_HPP_ */
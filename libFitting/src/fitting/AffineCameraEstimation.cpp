@@ -23,18 +23,19 @@ using std::vector;
 
 namespace fitting {
 
-Mat estimateAffineCamera(vector<imageio::ModelLandmark> imagePoints, MorphableModel morphableModel, vector<int> vertexIds/*=std::vector<int>()*/)
+Mat estimateAffineCamera(const vector<imageio::ModelLandmark>& imagePoints, const MorphableModel& morphableModel, vector<int> vertexIds/*=std::vector<int>()*/)
 {
 	// Note/TODO: If this function is called with invalid imagePoints, i.e. landmark id's that are not in the 3DMM, nothing throws. Something, somewhere, should happen.
 	// Todo: Currently, the optional vertexIds are not used
 
 	Mat matImagePoints; // will be numCorrespondences x 2, CV_32FC1
 	Mat matModelPoints; // will be numCorrespondences x 3, CV_32FC1
+	const morphablemodel::PcaModel shapeModel = morphableModel.getShapeModel(); // returns a copy, so only get it once
 	// Use the point only if it is available in the model:
 	for (const auto& landmark : imagePoints) {
 		Vec3f tmp;
 		try {
-			tmp = morphableModel.getShapeModel().getMeanAtPoint(landmark.getName());
+			tmp = shapeModel.getMeanAtPoint(landmark.getName());
 		}
 		catch (std::out_of_range& e) {
 			continue;
@@ -0,0 +1,100 @@
+/*
+ * LinearShapeFitter.cpp
+ *
+ *  Created on: 18.10.2026
+ *      Author: Patrik Huber
+ */
+
+#include "fitting/LinearShapeFitter.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+using morphablemodel::MorphableModel;
+using imageio::ModelLandmark;
+using cv::Mat;
+using std::string;
+using std::vector;
+using std::invalid_argument;
+
+namespace fitting {
+
+LinearShapeFitter::LinearShapeFitter(const MorphableModel& morphableModel) : shapeModel(morphableModel.getShapeModel())
+{
+}
+
+vector<float> LinearShapeFitter::fit(Mat affineCameraMatrix, const vector<ModelLandmark>& landmarks, float lambda/*=20.0f*/, boost::optional<int> numCoefficientsToFit/*=boost::optional<int>()*/, boost::optional<float> detectorStandardDeviation/*=boost::optional<float>()*/, boost::optional<float> modelStandardDeviation/*=boost::optional<float>()*/)
+{
+	if (affineCameraMatrix.rows != 3 || affineCameraMatrix.cols != 4)
+		throw invalid_argument("LinearShapeFitter: the affine camera matrix must be 3x4");
+	int numShapePc = shapeModel.getNumberOfPrincipalComponents();
+	int numCoeffsToFit = std::min(numCoefficientsToFit.get_value_or(numShapePc), numShapePc);
+	if (landmarks.empty() || numCoeffsToFit <= 0)
+		return vector<float>(numShapePc, 0.0f);
+	updateLandmarkSubset(landmarks);
+	int numLandmarks = static_cast<int>(landmarks.size());
+
+	Mat camera;
+	affineCameraMatrix.convertTo(camera, CV_64F);
+	// Instead of the block diagonal matrix P, the 3x3 part of the camera is applied to all landmarks at once:
+	// Row r of projectedBasis contains the r-th row of (C * V_i) for all landmarks i. Reshaped to 3L x m, the
+	// rows are ordered by coordinate instead of by landmark, which does not change A^t * A or A^t * b.
+	Mat rotation = camera.colRange(0, 3);
+	cv::gemm(rotation, basis, 1.0, cv::noArray(), 0.0, projectedBasis);
+	Mat A = projectedBasis.reshape(1, 3 * numLandmarks).colRange(0, numCoeffsToFit);
+	// b = P * v_bar - y, with the homogeneous coordinate of y being 1
+	cv::gemm(rotation, mean, 1.0, cv::noArray(), 0.0, projectedMean);
+	for (int i = 0; i < numLandmarks; ++i) {
+		projectedMean.at<double>(0, i) += camera.at<double>(0, 3) - landmarks[i].getX();
+		projectedMean.at<double>(1, i) += camera.at<double>(1, 3) - landmarks[i].getY();
+		projectedMean.at<double>(2, i) += camera.at<double>(2, 3) - 1.0;
+	}
+	Mat b = projectedMean.reshape(1, 3 * numLandmarks);
+
+	// The variances: Add the 2D and 3D standard deviations, see fitShapeToLandmarksLinear(...).
+	// Omega is a multiple of the identity, so it is applied as a scalar.
+	double sigma_2D_3D = detectorStandardDeviation.get_value_or(0.003f) + modelStandardDeviation.get_value_or(0.0f);
+	double omega = 1.0 / (sigma_2D_3D * sigma_2D_3D);
+
+	// (A^t * Omega * A + lambda * I) * c_s = -A^t * Omega * b
+	cv::mulTransposed(A, normalMatrix, true, cv::noArray(), omega, CV_64F);
+	for (int i = 0; i < numCoeffsToFit; ++i)
+		normalMatrix.at<double>(i, i) += lambda;
+	cv::gemm(A, b, -omega, cv::noArray(), 0.0, rightHandSide, cv::GEMM_1_T);
+	// The matrix is positive definite for lambda > 0. Otherwise it might be singular, then the pseudo-inverse is used.
+	if (!cv::solve(normalMatrix, rightHandSide, coefficients, cv::DECOMP_CHOLESKY))
+		cv::solve(normalMatrix, rightHandSide, coefficients, cv::DECOMP_SVD);
+
+	vector<float> c_s(numShapePc, 0.0f); // Note/Todo: We get coefficients ~ N(0, sigma) I think. They are not multiplied with the eigenvalues.
+	for (int i = 0; i < numCoeffsToFit; ++i)
+		c_s[i] = static_cast<float>(coefficients.at<double>(i));
+	return c_s;
+}
+
+void LinearShapeFitter::updateLandmarkSubset(const vector<ModelLandmark>& landmarks)
+{
+	bool isCached = landmarks.size() == landmarkIdentifiers.size();
+	for (size_t i = 0; isCached && i < landmarks.size(); ++i)
+		isCached = landmarks[i].getName() == landmarkIdentifiers[i];
+	if (isCached)
+		return;
+
+	int numLandmarks = static_cast<int>(landmarks.size());
+	int numShapePc = shapeModel.getNumberOfPrincipalComponents();
+	landmarkIdentifiers.clear();
+	basis.create(3, numLandmarks * numShapePc, CV_64F);
+	mean.create(3, numLandmarks, CV_64F);
+	for (int i = 0; i < numLandmarks; ++i) {
+		const string& identifier = landmarks[i].getName();
+		Mat basisRows = shapeModel.getNormalizedPcaBasis(identifier); // 3 x m
+		cv::Vec3f modelMean = shapeModel.getMeanAtPoint(identifier);
+		for (int k = 0; k < 3; ++k) {
+			Mat basisBlock = basis.row(k).colRange(i * numShapePc, (i + 1) * numShapePc);
+			basisRows.row(k).convertTo(basisBlock, CV_64F);
+			mean.at<double>(k, i) = modelMean[k];
+		}
+		landmarkIdentifiers.push_back(identifier);
+	}
+}
+
+} /* namespace fitting */
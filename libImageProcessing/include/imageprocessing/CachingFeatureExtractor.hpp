@@ -86,6 +86,8 @@ public:
 
 	std::shared_ptr<Patch> extract(int x, int y, int width, int height) const;
 
+	void setRegionOfInterest(cv::Rect roi);
+
 private:
 
 	std::shared_ptr<Patch> extractSharing(int x, int y, int width, int height) const;
@@ -17,6 +17,10 @@ namespace imageprocessing {
 /**
  * Pyramid feature extractor that builds upon another pyramid feature extractor and stores the extracted patches
  * for later extractions.
+ *
+ * When the image changes, only the patches overlapping the changed regions reported by the underlying extractor
+ * are removed from the cache (see ImagePyramid::enableChangeDetection). If the changes are unknown, the whole
+ * cache is cleared.
  */
 class CachingPyramidFeatureExtractor : public PyramidFeatureExtractor {
 private:
@@ -39,6 +43,20 @@ private:
 			return x == other.x && y == other.y;
 		}
 
+		/**
+		 * @return The x-coordinate of the patch inside the layer.
+		 */
+		int getX() const {
+			return x;
+		}
+
+		/**
+		 * @return The y-coordinate of the patch inside the layer.
+		 */
+		int getY() const {
+			return y;
+		}
+
 		/**
 		 * Hash function for keys.
 		 */
@@ -56,6 +74,11 @@ private:
 
 	/**
 	 * Layer of the cache representing a layer of the image pyramid.
+	 *
+	 * The patches are either stored in a hash map or, if the layer is dense, in an array that is indexed by the
+	 * position inside the layer, together with a bitmap that tells which positions are cached. In the latter case,
+	 * the data of stored copies is placed into contiguous chunks of memory. Positions outside of the array are
+	 * stored in the hash map.
 	 */
 	class CacheLayer {
 	public:
@@ -63,15 +86,19 @@ private:
 		/**
 		 * Default constructor.
 		 */
-		CacheLayer() : index(-1), scaleFactor(0), cache() {}
+		CacheLayer() : index(-1), scaleFactor(0), gridSize(0, 0), cache(), patches(), valid(), chunkIndices(), chunks(), chunkUsages(), chunkRow(0) {}
 
 		/**
 		 * Constructs a new cache layer.
 		 *
 		 * @param[in] index The index of this layer (0 is the original sized layer).
 		 * @param[in] scaleFactor The scale factor of this layer compared to the original image.
+		 * @param[in] gridSize The size of the array of positions, empty if the patches should be stored in a hash map.
 		 */
-		CacheLayer(int index, double scaleFactor) : index(index), scaleFactor(scaleFactor) {}
+		CacheLayer(int index, double scaleFactor, cv::Size gridSize = cv::Size(0, 0)) :
+				index(index), scaleFactor(scaleFactor), gridSize(gridSize), cache(),
+				patches(gridSize.area()), valid(gridSize.area(), false), chunkIndices(gridSize.area(), -1),
+				chunks(), chunkUsages(), chunkRow(0) {}
 
 		/**
 		 * @return The index of this layer (0 is the original sized layer).
@@ -80,6 +107,13 @@ private:
 			return index;
 		}
 
+		/**
+		 * @return The scale factor of this layer compared to the original image.
+		 */
+		double getScaleFactor() {
+			return scaleFactor;
+		}
+
 		/**
 		 * Computes the scaled representation of an original value (coordinate, size, ...) and rounds accordingly.
 		 *
@@ -91,17 +125,87 @@ private:
 		}
 
 		/**
-		 * @return The cache.
+		 * Looks up a cached patch.
+		 *
+		 * @param[in] x The x-coordinate of the patch inside the layer.
+		 * @param[in] y The y-coordinate of the patch inside the layer.
+		 * @return Pointer to the cached (possibly empty) patch or nullptr if there is no patch cached at the position.
 		 */
-		std::unordered_map<CacheKey, std::shared_ptr<Patch>, CacheKey::hash>& getCache() {
-			return cache;
-		}
+		std::shared_ptr<Patch>* find(int x, int y);
+
+		/**
+		 * Stores a patch.
+		 *
+		 * @param[in] x The x-coordinate of the patch inside the layer.
+		 * @param[in] y The y-coordinate of the patch inside the layer.
+		 * @param[in] patch The patch that is shared with the cache (may be empty).
+		 */
+		void store(int x, int y, const std::shared_ptr<Patch>& patch);
+
+		/**
+		 * Stores a copy of a patch.
+		 *
+		 * @param[in] x The x-coordinate of the patch inside the layer.
+		 * @param[in] y The y-coordinate of the patch inside the layer.
+		 * @param[in] patch The patch whose copy is stored.
+		 */
+		void storeCopy(int x, int y, const Patch& patch);
+
+		/**
+		 * Removes the patches that overlap any of the given regions.
+		 *
+		 * @param[in] regions The regions inside the layer.
+		 * @param[in] patchSize The size of the patches inside the layer.
+		 */
+		void remove(const std::vector<cv::Rect>& regions, cv::Size patchSize);
+
+		/**
+		 * Removes all patches.
+		 */
+		void clear();
 
 	private:
 
+		/**
+		 * Determines whether a position is part of the array.
+		 *
+		 * @param[in] x The x-coordinate of the patch inside the layer.
+		 * @param[in] y The y-coordinate of the patch inside the layer.
+		 * @return True if the patch at the position is stored in the array, false if it is stored in the hash map.
+		 */
+		bool isInGrid(int x, int y) const {
+			return x >= 0 && y >= 0 && x < gridSize.width && y < gridSize.height;
+		}
+
+		/**
+		 * Provides memory for the data of a stored copy.
+		 *
+		 * @param[in] data The data that should be copied.
+		 * @param[out] chunkIndex The index of the chunk the memory belongs to.
+		 * @return Matrix of the same size and type as the data that refers to a chunk of contiguous memory.
+		 */
+		cv::Mat allocate(const cv::Mat& data, int& chunkIndex);
+
+		/**
+		 * Removes the patch at a position of the array. Releases the chunk of memory of its data if the chunk is
+		 * not used anymore.
+		 *
+		 * @param[in] position The index of the position inside the array.
+		 */
+		void remove(int position);
+
+		static const int chunkRowCount = 256; ///< The number of patches whose data fit into a chunk of memory.
+
 		int index;          ///< The index of this layer (0 is the original sized layer).
 		double scaleFactor; ///< The scale factor of this layer compared to the original image.
-		std::unordered_map<CacheKey, std::shared_ptr<Patch>, CacheKey::hash> cache; ///< The cache.
+		cv::Size gridSize;  ///< The size of the array of positions (empty if all patches are stored in the hash map).
+		std::unordered_map<CacheKey, std::shared_ptr<Patch>, CacheKey::hash> cache; ///< The cache of positions outside of the array.
+		std::vector<std::shared_ptr<Patch>> patches; ///< The cached patches of the positions inside the array, row by row.
+		std::vector<bool> valid;  ///< Flags that indicate which positions of the array are cached.
+		std::vector<int> chunkIndices; ///< The indices of the chunks containing the data of the patches of the array (-1 if none).
+		std::vector<cv::Mat> chunks; ///< Chunks of memory containing the data of stored copies, one row per patch (empty if released).
+		std::vector<int> chunkUsages; ///< The number of cached patches whose data is inside each chunk.
+		int chunkRow;             ///< The next free row of the last chunk.
 	};
 
 public:
@@ -115,7 +219,23 @@ public:
 	 */
 	enum class Strategy { SHARING, COPYING, INPUT_COPYING, OUTPUT_COPYING };
 
-	explicit CachingPyramidFeatureExtractor(std::shared_ptr<PyramidFeatureExtractor> extractor, Strategy strategy = Strategy::COPYING);
+	/**
+	 * Storage of the cached patches.
+	 * HASHING - hash map per layer, the memory grows with the number of cached patches
+	 * DENSE - array per layer that is indexed by the position, the memory of each layer is allocated once and the
+	 *         data of stored copies is kept in contiguous chunks, suited for dense access (e.g. sliding windows)
+	 */
+	enum class Storage { HASHING, DENSE };
+
+	/**
+	 * Constructs a new caching pyramid feature extractor.
+	 *
+	 * @param[in] extractor The underlying feature extractor.
+	 * @param[in] strategy The caching strategy (copies of patches will be stored vs. patches will be shared).
+	 * @param[in] storage The storage of the cached patches.
+	 */
+	explicit CachingPyramidFeatureExtractor(std::shared_ptr<PyramidFeatureExtractor> extractor,
+			Strategy strategy = Strategy::COPYING, Storage storage = Storage::HASHING);
 
 	using FeatureExtractor::update;
 
@@ -123,9 +243,14 @@ public:
 
 	std::shared_ptr<Patch> extract(int x, int y, int width, int height) const;
 
+	void setRegionOfInterest(cv::Rect roi);
+
 	std::vector<std::shared_ptr<Patch>> extract(int stepX, int stepY, cv::Rect roi = cv::Rect(),
 			int firstLayer = -1, int lastLayer = -1, int stepLayer = 1) const;
 
+	std::vector<std::pair<int, cv::Size>> getPatchGridSizes(int stepX, int stepY, cv::Rect roi = cv::Rect(),
+			int firstLayer = -1, int lastLayer = -1, int stepLayer = 1) const;
+
 	std::shared_ptr<Patch> extract(int layer, int x, int y) const;
 
 	int getLayerIndex(int width, int height) const {
@@ -164,6 +289,10 @@ public:
 		return extractor->getPatchSizes();
 	}
 
+	bool getChangedRegions(int layer, std::vector<cv::Rect>& regions) const {
+		return extractor->getChangedRegions(layer, regions);
+	}
+
 private:
 
 	/**
@@ -171,6 +300,12 @@ private:
 	 */
 	void buildCache();
 
+	/**
+	 * Removes the patches that might have changed with the last update from the cache. Re-builds the cache if the
+	 * layers changed.
+	 */
+	void invalidateCache();
+
 	std::shared_ptr<Patch> extractSharing(CacheLayer& layer, int x, int y) const;
 
 	std::shared_ptr<Patch> extractCopying(CacheLayer& layer, int x, int y) const;
@@ -183,6 +318,7 @@ private:
 	mutable std::vector<CacheLayer> cache; ///< The current cache of stored patches.
 	mutable int firstCacheIndex;           ///< The index of the first stored cache layer.
 	Strategy strategy; ///< The caching strategy (copies of patches will be stored vs. patches will be shared).
+	Storage storage; ///< The storage of the cached patches.
 	Version version; ///< The version.
 };
 
@@ -50,6 +50,12 @@ public:
 	std::vector<std::shared_ptr<Patch>> extract(int stepX, int stepY, cv::Rect roi = cv::Rect(),
 			int firstLayer = -1, int lastLayer = -1, int stepLayer = 1) const;
 
+	void extract(PatchBatch& batch, int stepX, int stepY, cv::Rect roi = cv::Rect(),
+			int firstLayer = -1, int lastLayer = -1, int stepLayer = 1) const;
+
+	std::vector<std::pair<int, cv::Size>> getPatchGridSizes(int stepX, int stepY, cv::Rect roi = cv::Rect(),
+			int firstLayer = -1, int lastLayer = -1, int stepLayer = 1) const;
+
 	std::vector<std::pair<int, double>> getLayerScales() const;
 
 protected:
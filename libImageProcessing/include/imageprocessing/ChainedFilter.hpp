@@ -16,7 +16,8 @@ namespace imageprocessing {
 
 /**
  * Image filter that applies several filters in order. The result of a filter is used as input of the following filter,
- * the result of the last filter is the result of the whole filter chain.
+ * the result of the last filter is the result of the whole filter chain. Only the last filter writes into the
+ * given output image, so its memory is re-used if it has the size and type of the result.
  */
 class ChainedFilter : public ImageFilter {
 public:
@@ -57,12 +58,21 @@ public:
 	 */
 	void add(std::shared_ptr<ImageFilter> filter);
 
+	/**
+	 * @return True if there are no filters, so the result is a copy of the image.
+	 */
+	bool empty() const {
+		return filters.empty();
+	}
+
 	using ImageFilter::applyTo;
 
 	cv::Mat applyTo(const cv::Mat& image, cv::Mat& filtered) const;
 
 	void applyInPlace(cv::Mat& image) const;
 
+	void collectInstances(std::vector<const ImageFilter*>& instances) const;
+
 private:
 
 	std::vector<std::shared_ptr<ImageFilter>> filters; ///< The filters in order of application.
@@ -12,6 +12,8 @@
 #include <vector>
 #include <array>
 
+class HogBenchmark;
+
 namespace imageprocessing {
 
 /**
@@ -35,6 +37,8 @@ namespace imageprocessing {
 class CompleteExtendedHogFilter : public ImageFilter {
 public:
 
+	friend class ::HogBenchmark; ///< Tool that compares the descriptors to a reference implementation.
+
 	/**
 	 * Constructs a new complete extended HOG filter.
 	 *
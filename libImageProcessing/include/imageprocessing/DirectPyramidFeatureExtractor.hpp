@@ -111,6 +111,25 @@ public:
 	virtual std::vector<std::shared_ptr<Patch>> extract(int stepX, int stepY, cv::Rect roi = cv::Rect(),
 			int firstLayer = -1, int lastLayer = -1, int stepLayer = 1) const;
 
+	/**
+	 * Extracts several patches from the layers of the corresponding image pyramid into a batch. The patch data is
+	 * written into the arena of the batch, so no memory is allocated if the batch has been used before with the
+	 * same number of patches.
+	 *
+	 * @param[out] batch The batch that is filled with the extracted patches.
+	 * @param[in] stepX The step size in x-direction in pixels (will be the same absolute value in all pyramid layers).
+	 * @param[in] stepY The step size in y-direction in pixels (will be the same absolute value in all pyramid layers).
+	 * @param[in] roi The region of interest inside the original image (region will be scaled accordingly to the layers).
+	 * @param[in] firstLayer The index of the first layer to extract patches from.
+	 * @param[in] lastLayer The index of the last layer to extract patches from.
+	 * @param[in] stepLayer The step size for proceeding to the next layer (values greater than one will skip layers).
+	 */
+	virtual void extract(PatchBatch& batch, int stepX, int stepY, cv::Rect roi = cv::Rect(),
+			int firstLayer = -1, int lastLayer = -1, int stepLayer = 1) const;
+
+	virtual std::vector<std::pair<int, cv::Size>> getPatchGridSizes(int stepX, int stepY, cv::Rect roi = cv::Rect(),
+			int firstLayer = -1, int lastLayer = -1, int stepLayer = 1) const;
+
 	/**
 	 * Extracts a single patch from a layer of the corresponding image pyramid.
 	 *
@@ -147,6 +166,10 @@ public:
 
 	std::vector<cv::Size> getPatchSizes() const;
 
+	bool getChangedRegions(int layer, std::vector<cv::Rect>& regions) const;
+
+	void setRegionOfInterest(cv::Rect roi);
+
 	/**
 	 * @return The image pyramid.
 	 */
@@ -236,6 +259,30 @@ private:
 	 */
 	std::shared_ptr<Patch> extract(const ImagePyramidLayer& layer, const cv::Rect bounds) const;
 
+	/**
+	 * Determines the layers to extract patches from and the areas that are covered by the patches.
+	 *
+	 * @param[in] stepX The step size in x-direction in pixels.
+	 * @param[in] stepY The step size in y-direction in pixels.
+	 * @param[in] roi The region of interest inside the original image.
+	 * @param[in] firstLayer The index of the first layer to extract patches from.
+	 * @param[in] lastLayer The index of the last layer to extract patches from.
+	 * @param[in] stepLayer The step size for proceeding to the next layer.
+	 * @return Pairs of the layers and the scaled regions of interest inside them.
+	 */
+	std::vector<std::pair<std::shared_ptr<ImagePyramidLayer>, cv::Rect>> getLayerAreas(int stepX, int stepY, cv::Rect roi,
+			int firstLayer, int lastLayer, int stepLayer) const;
+
+	/**
+	 * Determines the number of patch positions along one dimension of an area.
+	 *
+	 * @param[in] areaSize The size of the area.
+	 * @param[in] patchSize The size of the patches.
+	 * @param[in] step The step size.
+	 * @return The number of patch positions.
+	 */
+	size_t getPositionCount(int areaSize, int patchSize, int step) const;
+
 	std::shared_ptr<ImagePyramid> pyramid; ///< The image pyramid.
 	int patchWidth;  ///< The width of the image data of the extracted patches.
 	int patchHeight; ///< The height of the image data of the extracted patches.
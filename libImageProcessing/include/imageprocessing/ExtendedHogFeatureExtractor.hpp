@@ -99,6 +99,8 @@ public:
 
 	std::shared_ptr<Patch> extract(int x, int y, int width, int height) const;
 
+	void setRegionOfInterest(cv::Rect roi);
+
 	/**
 	 * @return The image pyramid.
 	 */
@@ -11,6 +11,8 @@
 #include "imageprocessing/HistogramFilter.hpp"
 #include <vector>
 
+class HogBenchmark;
+
 namespace imageprocessing {
 
 /**
@@ -33,6 +35,8 @@ namespace imageprocessing {
 class ExtendedHogFilter : public HistogramFilter {
 public:
 
+	friend class ::HogBenchmark; ///< Tool that compares the descriptors to a reference implementation.
+
 	/**
 	 * Constructs a new extended HOG filter with square cells and blocks.
 	 *
@@ -74,10 +78,22 @@ public:
 		return cellHeight;
 	}
 
+	/**
+	 * Computes the normalizers of all blocks of 2x2 cells given the squared gradient energies of the cells. The cell
+	 * grid is virtually extended by one cell in each direction, repeating the energies of the border cells. The cell
+	 * at (row, col) is normalized by the blocks at (row, col), (row, col + 1), (row + 1, col) and (row + 1, col + 1).
+	 *
+	 * @param[in] energies Squared gradient energies of the cells (CV_32FC1).
+	 * @param[out] normalizers Inverse norms of the blocks, having one row and column more than the energies (CV_32FC1).
+	 * @param[in] eps The small value being added to the squared norms to prevent division by zero.
+	 */
+	static void computeBlockNormalizers(const cv::Mat& energies, cv::Mat& normalizers, float eps);
+
 private:
 
 	/**
-	 * Creates cell descriptors based on a grid of cell histograms.
+	 * Creates cell descriptors based on a grid of cell histograms. The block normalizers are computed once for the
+	 * whole grid, then the descriptors are written row by row.
 	 *
 	 * @param[in] histograms Row vector containing the histogram values of the cells in row-major order.
 	 * @param[out] descriptors Row vector containing the descriptors of the cells in row-major order.
@@ -87,8 +103,8 @@ private:
 	 * @param[in] cellCols Column count of the cell grid.
 	 * @param[in] alpha Truncation threshold of the orientation bin values (applied after normalization).
 	 */
-	void createDescriptors(const cv::Mat& histograms, cv::Mat& descriptors,
-			int bins, bool signedAndUnsigned, int cellRows, int cellCols, float alpha) const;
+	static void createDescriptors(const cv::Mat& histograms, cv::Mat& descriptors,
+			int bins, bool signedAndUnsigned, int cellRows, int cellCols, float alpha);
 
 	int binCount;   ///< The amount of bins inside the histogram.
 	int cellWidth;  ///< The preferred width of the cells in pixels (actual width might deviate).
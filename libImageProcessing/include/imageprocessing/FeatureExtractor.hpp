@@ -51,6 +51,16 @@ public:
 	 * @return A pointer to the patch (with its feature vector) that might be empty if the patch could not be created.
 	 */
 	virtual std::shared_ptr<Patch> extract(int x, int y, int width, int height) const = 0;
+
+	/**
+	 * Restricts the computation of features with the next updates to a region of interest, e.g. the bounds of all
+	 * samples of a tracker. Patches that are not completely inside the region of interest must not be extracted
+	 * afterwards, as their features may be incomplete. Coordinates stay the same as without a region of interest.
+	 * Feature extractors that do not compute features in advance ignore the region of interest.
+	 *
+	 * @param[in] roi Region of interest in the image, an empty rectangle to compute the features of the whole image.
+	 */
+	virtual void setRegionOfInterest(cv::Rect roi) {}
 };
 
 } /* namespace imageprocessing */
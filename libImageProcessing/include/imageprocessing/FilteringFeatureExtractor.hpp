@@ -46,10 +46,14 @@ public:
 	std::shared_ptr<Patch> extract(int x, int y, int width, int height) const {
 		std::shared_ptr<Patch> patch = extractor->extract(x, y, width, height);
 		if (patch)
-			patchFilter->applyInPlace(patch->getData());
+			patchFilter->applyInPlace(patch->getWritableData());
 		return patch;
 	}
 
+	void setRegionOfInterest(cv::Rect roi) {
+		extractor->setRegionOfInterest(roi);
+	}
+
 private:
 
 	std::shared_ptr<FeatureExtractor> extractor; ///< The underlying feature extractor.
@@ -46,7 +46,7 @@ public:
 	std::shared_ptr<Patch> extract(int x, int y, int width, int height) const {
 		std::shared_ptr<Patch> patch = extractor->extract(x, y, width, height);
 		if (patch)
-			patchFilter->applyInPlace(patch->getData());
+			patchFilter->applyInPlace(patch->getWritableData());
 		return patch;
 	}
 
@@ -54,14 +54,19 @@ public:
 			int firstLayer = -1, int lastLayer = -1, int stepLayer = 1) const {
 		std::vector<std::shared_ptr<Patch>> patches = extractor->extract(stepX, stepY, roi, firstLayer, lastLayer, stepLayer);
 		for (std::shared_ptr<Patch>& patch : patches)
-			patchFilter->applyInPlace(patch->getData());
+			patchFilter->applyInPlace(patch->getWritableData());
 		return patches;
 	}
 
+	std::vector<std::pair<int, cv::Size>> getPatchGridSizes(int stepX, int stepY, cv::Rect roi = cv::Rect(),
+			int firstLayer = -1, int lastLayer = -1, int stepLayer = 1) const {
+		return extractor->getPatchGridSizes(stepX, stepY, roi, firstLayer, lastLayer, stepLayer);
+	}
+
 	std::shared_ptr<Patch> extract(int layer, int x, int y) const {
 		std::shared_ptr<Patch> patch = extractor->extract(layer, x, y);
 		if (patch)
-			patchFilter->applyInPlace(patch->getData());
+			patchFilter->applyInPlace(patch->getWritableData());
 		return patch;
 	}
 
@@ -101,6 +106,14 @@ public:
 		return extractor->getPatchSizes();
 	}
 
+	bool getChangedRegions(int layer, std::vector<cv::Rect>& regions) const {
+		return extractor->getChangedRegions(layer, regions);
+	}
+
+	void setRegionOfInterest(cv::Rect roi) {
+		extractor->setRegionOfInterest(roi);
+	}
+
 private:
 
 	std::shared_ptr<PyramidFeatureExtractor> extractor; ///< The underlying feature extractor.
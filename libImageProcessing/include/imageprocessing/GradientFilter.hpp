@@ -9,6 +9,7 @@
 #define GRADIENTFILTER_HPP_
 
 #include "imageprocessing/ImageFilter.hpp"
+#include <algorithm>
 
 namespace imageprocessing {
 
@@ -34,6 +35,13 @@ public:
 
 	void applyInPlace(cv::Mat& image) const;
 
+	/**
+	 * @return The number of neighboring pixels in each direction that influence the gradient of a pixel.
+	 */
+	int getSupport() const {
+		return std::max(1, kernelSize / 2) + blurKernelSize / 2;
+	}
+
 private:
 
 	/**
@@ -9,6 +9,7 @@
 #define IMAGEFILTER_HPP_
 
 #include "opencv2/core/core.hpp"
+#include <vector>
 
 namespace imageprocessing {
 
@@ -54,6 +55,17 @@ public:
 	virtual void applyInPlace(cv::Mat& image) const {
 		image = applyTo(image);
 	}
+
+	/**
+	 * Adds this filter and the filters it delegates to to a list. Filters that apply other (possibly shared)
+	 * filters have to override this, so filters that are used by several concurrently applied branches can be
+	 * detected, as some filters keep internal buffers and must not be applied by several threads at the same time.
+	 *
+	 * @param[in,out] instances List the filter instances are added to.
+	 */
+	virtual void collectInstances(std::vector<const ImageFilter*>& instances) const {
+		instances.push_back(this);
+	}
 };
 
 } /* namespace imageprocessing */
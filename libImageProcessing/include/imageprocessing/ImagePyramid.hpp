@@ -29,6 +29,17 @@ class ChainedFilter;
 class ImagePyramid {
 public:
 
+	/**
+	 * Strategy for computing the scaled images of the layers from the filtered source image.
+	 * RESIZE_FIRST - each layer of the first octave is resized from the image, the subsequent octaves are halved (pyrDown) from those
+	 *                (default, the layers of the other strategies differ numerically from these)
+	 * HALVE_FIRST - the image is halved (pyrDown) until reaching the first octave containing layers up to the maximum scale factor,
+	 *               then the layers of that octave are resized and the subsequent octaves are halved as with RESIZE_FIRST
+	 * AREA - like HALVE_FIRST, but the halving averages blocks of 2x2 pixels (area interpolation) instead of Gaussian smoothing,
+	 *        which is faster, but smooths less
+	 */
+	enum class Scaling { RESIZE_FIRST, HALVE_FIRST, AREA };
+
 	/**
 	 * Creates an (empty) image pyramid.
 	 *
@@ -59,6 +70,7 @@ public:
 	 * @param[in] minScaleFactor The minimum scale factor (the scale factor of the smallest scaled (last) image is bigger or equal).
 	 * @param[in] maxScaleFactor The maximum scale factor (the scale factor of the biggest scaled (first) image is less or equal).
 	 * @param[in] lambdas Coefficients for power law scaling. Must be empty or have as many elements as there are image channels.
+	 *                    If empty, they are estimated from each new image (see LambdaEstimator for estimating them once).
 	 * @return Image pyramid that approximates layers and must be updated with an image before further use.
 	 */
 	static std::shared_ptr<ImagePyramid> createApproximated(int octaveLayerCount,
@@ -73,6 +85,7 @@ public:
 	 * @param[in] pyramid Sparse image pyramid with few layers per octave (possibly only one).
 	 * @param[in] octaveLayerCount The number of layers per octave.
 	 * @param[in] lambdas Coefficients for power law scaling. Must be empty or have as many elements as there are image channels.
+	 *                    If empty, they are estimated from each new image (see LambdaEstimator for estimating them once).
 	 * @return Image pyramid that uses the given sparse pyramid as its source and approximates additional layers.
 	 */
 	static std::shared_ptr<ImagePyramid> createApproximated(
@@ -242,6 +255,7 @@ public:
 		if (sourcePyramid)
 			sourcePyramid->setMinScaleFactor(scaleFactor);
 		minScaleFactor = scaleFactor;
+		previousImage.release(); // the layers change, so the next image must not be compared to the previous one
 	}
 
 	/**
@@ -260,6 +274,7 @@ public:
 		if (sourcePyramid)
 			sourcePyramid->setMaxScaleFactor(scaleFactor);
 		maxScaleFactor = scaleFactor;
+		previousImage.release(); // the layers change, so the next image must not be compared to the previous one
 	}
 
 	/**
@@ -276,12 +291,118 @@ public:
 		this->lambdas = lambdas;
 	}
 
+	/**
+	 * @return The strategy for computing the scaled images of the layers.
+	 */
+	Scaling getScaling() const {
+		return scaling;
+	}
+
+	/**
+	 * Changes the strategy for computing the scaled images of the layers. Only has an effect if this pyramid has an
+	 * image as its source, but is passed on to the source pyramid otherwise.
+	 *
+	 * @param[in] scaling The new strategy for computing the scaled images of the layers.
+	 */
+	void setScaling(Scaling scaling) {
+		if (sourcePyramid)
+			sourcePyramid->setScaling(scaling);
+		this->scaling = scaling;
+		previousImage.release(); // the layers change, so the next image must not be compared to the previous one
+	}
+
+	/**
+	 * Enables the change-aware update for videos with mostly static content. A new source image is compared
+	 * block-wise to the image the layers were created from. If no block changed, then the layers are kept and the
+	 * version of this pyramid stays the same. Otherwise the layers are re-created and the changed regions can be
+	 * retrieved by getChangedRegions(), so caches of extracted features may keep the features outside of them. If
+	 * too many blocks changed, then the whole image is considered changed. If this pyramid's source is another
+	 * pyramid, then change detection is enabled for that pyramid, too.
+	 *
+	 * @param[in] blockSize Width and height of the compared blocks in pixels of the original image.
+	 * @param[in] margin Support of the image and layer filters in layer pixels, changed regions of the layers are extended by it.
+	 * @param[in] maxChangedFraction Fraction of changed blocks above which the whole image is considered changed.
+	 * @param[in] threshold Absolute difference of pixel values up to which a pixel is not considered changed.
+	 */
+	void enableChangeDetection(int blockSize, int margin, double maxChangedFraction = 0.5, double threshold = 0);
+
+	/**
+	 * Disables the change-aware update, so each new source image re-creates all layers.
+	 */
+	void disableChangeDetection();
+
+	/**
+	 * Determines the regions of a layer that changed with the last update. Outside of those regions, the scaled
+	 * image of the layer is considered to be the same as before the update.
+	 *
+	 * @param[in] index The index of the pyramid layer.
+	 * @param[out] regions The changed regions inside the scaled image of the layer.
+	 * @return True if the changed regions are known, false if the whole layer must be considered changed.
+	 */
+	bool getChangedRegions(int index, std::vector<cv::Rect>& regions) const;
+
+	/**
+	 * Restricts the layer filters to a region of interest, e.g. the area covered by the samples of a tracker. The
+	 * layers keep their full size, so coordinates are the same as without a region of interest, but the filtered
+	 * values are only computed inside the padded region of interest and are zero outside of it. The region of
+	 * interest is passed on to the source pyramid. Changing it forces the next update to re-create the layers.
+	 *
+	 * If there are layer filters, then the padding must be set before (see setRegionOfInterestPadding), because
+	 * the values at the border of the region would differ from those of the whole layers otherwise. If layers are
+	 * approximated, then the lambdas must be set, because the channel means would depend on the region.
+	 *
+	 * @param[in] roi Region of interest in the original image, an empty rectangle to filter the whole layers.
+	 */
+	void setRegionOfInterest(cv::Rect roi);
+
+	/**
+	 * @return The region of interest in the original image (empty if the whole layers are filtered).
+	 */
+	cv::Rect getRegionOfInterest() const {
+		return regionOfInterest;
+	}
+
+	/**
+	 * Changes how the region of interest is extended inside the layers before applying the layer filters. The
+	 * padding is passed on to the source pyramid.
+	 *
+	 * @param[in] padding Support of the layer filters in layer pixels, the region of interest is extended by it.
+	 * @param[in] granularity Alignment of the region in layer pixels, e.g. the cell size of a filter computing cell histograms.
+	 */
+	void setRegionOfInterestPadding(int padding, int granularity = 1);
+
 private:
 
+	/**
+	 * Compares a new source image block-wise to the image the layers were created from and determines the changed
+	 * regions. Remembers the new image if the layers have to be re-created.
+	 *
+	 * @param[in] image The new source image.
+	 * @return True if the layers have to be re-created, false if nothing changed.
+	 */
+	bool detectChanges(const cv::Mat& image);
+
 	void createLayers(const cv::Mat& image);
 
+	/**
+	 * Halves the size of an image according to the scaling strategy.
+	 *
+	 * @param[in] image The image.
+	 * @param[out] halvedImage The image with half the width and height (rounded up).
+	 */
+	void halve(const cv::Mat& image, cv::Mat& halvedImage) const;
+
 	void createLayers(const ImagePyramid& pyramid);
 
+	/**
+	 * Applies the layer filter to a scaled image. If there is a region of interest, then only the padded region of
+	 * interest is filtered and the result is placed into an otherwise zero image.
+	 *
+	 * @param[in] scaledImage The scaled image of a layer.
+	 * @return The filtered image of the layer.
+	 */
+	cv::Mat applyLayerFilter(const cv::Mat& scaledImage) const;
+
 	std::vector<double> estimateLambdas(const std::vector<std::shared_ptr<ImagePyramidLayer>>& layers) const;
 
 	std::vector<double> estimateLambdas(const ImagePyramidLayer& layer1, const ImagePyramidLayer& layer2) const;
@@ -301,11 +422,26 @@ private:
 	int firstLayer; ///< The index of the first stored pyramid layer.
 	std::vector<std::shared_ptr<ImagePyramidLayer>> layers; ///< The pyramid layers.
 	std::vector<double> lambdas; ///< Coefficients for power law scaling (only used when approximating layers).
+	Scaling scaling; ///< The strategy for computing the scaled images of the layers.
 
 	std::shared_ptr<VersionedImage> sourceImage; ///< The source image.
 	std::shared_ptr<ImagePyramid> sourcePyramid; ///< The source pyramid.
 	Version version; ///< The version.
 
+	static const int resamplingMargin = 3; ///< Amount of layer pixels a change spreads due to scaling the image.
+	int changeBlockSize; ///< Width and height of the compared blocks (zero if change detection is disabled).
+	int changeMargin; ///< Support of the image and layer filters in layer pixels.
+	double maxChangedFraction; ///< Fraction of changed blocks above which the whole image is considered changed.
+	double changeThreshold; ///< Absolute difference of pixel values up to which a pixel is not considered changed.
+	cv::Mat previousImage; ///< The source image the layers were created from (only if change detection is enabled).
+	Version sourceVersion; ///< The version of the source image that was compared last.
+	bool changedCompletely; ///< Flag that indicates whether the whole image is considered changed with the last update.
+	std::vector<cv::Rect> changedRegions; ///< The changed regions of the original image (if not changed completely).
+
+	cv::Rect regionOfInterest; ///< Region of interest in the original image the layer filters are restricted to (empty for the whole image).
+	int regionOfInterestPadding; ///< Amount of layer pixels the region of interest is extended by (negative if unknown).
+	int regionOfInterestGranularity; ///< Alignment of the region of interest in layer pixels.
+
 	std::shared_ptr<ChainedFilter> imageFilter; ///< Filter that is applied to the image before down-scaling.
 	std::shared_ptr<ChainedFilter> layerFilter; ///< Filter that is applied to the down-scaled images of the layers.
 };
@@ -46,6 +46,10 @@ public:
 		return patch;
 	}
 
+	void setRegionOfInterest(cv::Rect roi) {
+		extractor->setRegionOfInterest(roi);
+	}
+
 private:
 
 	std::shared_ptr<FeatureExtractor> extractor; ///< The underlying feature extractor.
@@ -0,0 +1,83 @@
+/*
+ * LambdaEstimator.hpp
+ *
+ *  Created on: 18.10.2026
+ *      Author: poschmann
+ */
+
+#ifndef LAMBDAESTIMATOR_HPP_
+#define LAMBDAESTIMATOR_HPP_
+
+#include "imageprocessing/ImageFilter.hpp"
+#include "opencv2/core/core.hpp"
+#include <memory>
+#include <vector>
+
+namespace imageprocessing {
+
+/**
+ * Estimates the coefficients (lambdas) of the power law that describes how the channel means of filtered images
+ * change with the scale of the image. These are needed for approximating the layers of an image pyramid (see
+ * ImagePyramid::createApproximated) without having to estimate them from each new image.
+ *
+ * For each sample image, the layer filter is applied to the image and to several scaled versions of it within one
+ * octave. The ratios of the channel means of the scaled versions to those of the image are averaged over all sample
+ * images, then a lambda is fitted to the averaged ratios of each channel using least squares in log space.
+ *
+ * The estimation is based on "Fast Feature Pyramids for Object Detection" by Dollár et al.,
+ * IEEE Transactions on Pattern Analysis and Machine Intelligence, 2014.
+ */
+class LambdaEstimator {
+public:
+
+	/**
+	 * Constructs a new lambda estimator.
+	 *
+	 * @param[in] layerFilter Filter that computes the channels on the scaled images.
+	 * @param[in] imageFilter Filter that is applied to the images before scaling (may be empty).
+	 * @param[in] scaleCount Number of scales within one octave the channel means are compared at.
+	 */
+	explicit LambdaEstimator(std::shared_ptr<ImageFilter> layerFilter,
+			std::shared_ptr<ImageFilter> imageFilter = std::shared_ptr<ImageFilter>(), int scaleCount = 8);
+
+	/**
+	 * Adds the channel mean ratios of a sample image to the estimation.
+	 *
+	 * @param[in] image The sample image.
+	 */
+	void add(const cv::Mat& image);
+
+	/**
+	 * @return The number of sample images that were added.
+	 */
+	int getImageCount() const {
+		return imageCount;
+	}
+
+	/**
+	 * Estimates the lambdas based on the sample images that were added so far.
+	 *
+	 * @return Coefficients for power law scaling, one per channel.
+	 */
+	std::vector<double> getLambdas() const;
+
+private:
+
+	/**
+	 * Computes the mean of each channel of an image.
+	 *
+	 * @param[in] image The image.
+	 * @return The mean of each channel.
+	 */
+	std::vector<double> computeChannelMeans(const cv::Mat& image) const;
+
+	std::shared_ptr<ImageFilter> layerFilter; ///< Filter that computes the channels on the scaled images.
+	std::shared_ptr<ImageFilter> imageFilter; ///< Filter that is applied to the images before scaling (may be empty).
+	std::vector<double> scaleFactors; ///< The scale factors the channel means are compared at.
+	std::vector<std::vector<double>> ratioSums; ///< The sums of the channel mean ratios per scale factor and channel.
+	std::vector<std::vector<int>> ratioCounts; ///< The number of summed ratios per scale factor and channel.
+	int imageCount; ///< The number of sample images that were added.
+};
+
+} /* namespace imageprocessing */
+#endif /* LAMBDAESTIMATOR_HPP_ */
@@ -0,0 +1,83 @@
+/*
+ * LambdaStore.hpp
+ *
+ *  Created on: 18.10.2026
+ *      Author: poschmann
+ */
+
+#ifndef LAMBDASTORE_HPP_
+#define LAMBDASTORE_HPP_
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace imageprocessing {
+
+/**
+ * Persistent storage of power law coefficients (lambdas) for approximating image pyramid layers. The lambdas are
+ * keyed by a description of the filter configuration that computes the channels (e.g. "fhog9-cell8"), so lambdas
+ * that were estimated once (see LambdaEstimator) can be re-used by all approximated pyramids using that configuration.
+ *
+ * The file contains a line per key, consisting of the key, the number of lambdas and the lambdas themselves.
+ */
+class LambdaStore {
+public:
+
+	/**
+	 * Constructs a new empty lambda store.
+	 */
+	LambdaStore();
+
+	/**
+	 * Constructs a new lambda store containing the lambdas of a file.
+	 *
+	 * @param[in] filename The name of the file to load the lambdas from.
+	 */
+	explicit LambdaStore(const std::string& filename);
+
+	/**
+	 * Determines whether there are lambdas for a filter configuration.
+	 *
+	 * @param[in] key Description of the filter configuration.
+	 * @return True if there are lambdas for the filter configuration, false otherwise.
+	 */
+	bool contains(const std::string& key) const;
+
+	/**
+	 * Retrieves the lambdas of a filter configuration.
+	 *
+	 * @param[in] key Description of the filter configuration.
+	 * @return The lambdas of the filter configuration, empty if there are none.
+	 */
+	std::vector<double> get(const std::string& key) const;
+
+	/**
+	 * Changes the lambdas of a filter configuration.
+	 *
+	 * @param[in] key Description of the filter configuration, must not contain whitespace.
+	 * @param[in] lambdas The lambdas of the filter configuration.
+	 */
+	void set(const std::string& key, const std::vector<double>& lambdas);
+
+	/**
+	 * Loads the lambdas of a file, replacing those of equal keys.
+	 *
+	 * @param[in] filename The name of the file to load the lambdas from.
+	 */
+	void load(const std::string& filename);
+
+	/**
+	 * Stores all lambdas into a file.
+	 *
+	 * @param[in] filename The name of the file to store the lambdas into.
+	 */
+	void store(const std::string& filename) const;
+
+private:
+
+	std::map<std::string, std::vector<double>> lambdas; ///< The lambdas of each filter configuration.
+};
+
+} /* namespace imageprocessing */
+#endif /* LAMBDASTORE_HPP_ */
@@ -17,6 +17,11 @@ namespace imageprocessing {
 /**
  * Image filter that applies several filters on the input image and combines the results by merging the result's channels
  * into a single image. The size and depth of the filter results have to be equal.
+ *
+ * The filters are applied concurrently, unless a filter instance is used more than once, including the filters
+ * inside of composite filters like ChainedFilter (some filters use internal buffers and must not be applied by
+ * several threads at the same time). The channels are merged row-wise
+ * in parallel as well.
  */
 class ParallelFilter : public ImageFilter {
 public:
@@ -61,8 +66,31 @@ public:
 
 	cv::Mat applyTo(const cv::Mat& image, cv::Mat& filtered) const;
 
+	void collectInstances(std::vector<const ImageFilter*>& instances) const;
+
+	/**
+	 * Merges the channels of several images into a single image, distributing the rows across threads. The
+	 * merged image is only re-allocated if its size or type does not fit.
+	 *
+	 * @param[in] images Images of the same size and depth.
+	 * @param[out] merged Image containing the channels of all images.
+	 * @throws std::invalid_argument If there are no images or they differ in size or depth.
+	 */
+	static void merge(const std::vector<cv::Mat>& images, cv::Mat& merged);
+
 private:
 
+	class FilterApplication; ///< Applies a range of the filters, used with cv::parallel_for_.
+	class ChannelMerger; ///< Merges the channels of a range of rows, used with cv::parallel_for_.
+
+	/**
+	 * Determines whether each filter instance (including the ones inside of composite filters) is used only once,
+	 * so the filters can be applied concurrently.
+	 *
+	 * @return True if there are no duplicate filters, false otherwise.
+	 */
+	bool hasDistinctFilters() const;
+
 	std::vector<std::shared_ptr<ImageFilter>> filters; ///< The image filters whose results should be combined.
 };
 
@@ -14,6 +14,10 @@ namespace imageprocessing {
 
 /**
  * Image patch with data, extracted from an image.
+ *
+ * The data of a patch may be a view into data that is owned by someone else (e.g. the layer of an image pyramid
+ * or the arena of a patch batch) and that might change later on. Such patches must not be modified directly, but
+ * via getWritableData(), which copies the data first. Copies of patches always own their data.
  */
 class Patch {
 public:
@@ -50,7 +54,7 @@ public:
 	/**
 	 * Constructs a new empty patch. All values will be zero and the data will be empty.
 	 */
-	Patch() : center(0, 0), size(0, 0), data() {}
+	Patch() : center(0, 0), size(0, 0), data(), view(false) {}
 
 	/**
 	 * Constructs a new patch.
@@ -62,7 +66,7 @@ public:
 	 * @param[in] data The patch data (might be an image patch or a feature vector).
 	 */
 	Patch(int x, int y, int width, int height, const cv::Mat& data) :
-			center(x, y), size(width, height), data(data) {}
+			center(x, y), size(width, height), data(data), view(false) {}
 
 	/**
 	 * Constructs a new patch given its bounding rectangle.
@@ -71,7 +75,7 @@ public:
 	 * @param[in] data The patch data (might be an image patch or a feature vector).
 	 */
 	Patch(cv::Rect bounds, const cv::Mat& data) :
-			center(computeCenter(bounds)), size(bounds.width, bounds.height), data(data) {}
+			center(computeCenter(bounds)), size(bounds.width, bounds.height), data(data), view(false) {}
 
 	/**
 	 * Copy constructor that clones the patch data.
@@ -79,7 +83,7 @@ public:
 	 * @param[in] other The patch that should be copied.
 	 */
 	Patch(const Patch& other) :
-			center(other.center), size(other.size), data(other.data.clone()) {}
+			center(other.center), size(other.size), data(other.data.clone()), view(false) {}
 
 	/**
 	 * Move constructor.
@@ -87,8 +91,9 @@ public:
 	 * @param[in] other The patch that should be moved.
 	 */
 	Patch(Patch&& other) :
-			center(other.center), size(other.size), data(other.data) {
+			center(other.center), size(other.size), data(other.data), view(other.view) {
 		other.data = cv::Mat();
+		other.view = false;
 	}
 
 	/**
@@ -100,6 +105,7 @@ public:
 		center = other.center;
 		size = other.size;
 		data = other.data.clone();
+		view = false;
 		return *this;
 	}
 
@@ -112,7 +118,9 @@ public:
 		center = other.center;
 		size = other.size;
 		data = other.data;
+		view = other.view;
 		other.data = cv::Mat();
+		other.view = false;
 		return *this;
 	}
 
@@ -214,6 +222,36 @@ public:
 		return data;
 	}
 
+	/**
+	 * Copies the data if it is a view, so it may be modified without changing the data of someone else.
+	 *
+	 * @return The patch data that is owned by this patch.
+	 */
+	cv::Mat& getWritableData() {
+		if (view) {
+			data = data.clone();
+			view = false;
+		}
+		return data;
+	}
+
+	/**
+	 * Changes the data to a view into data that is owned by someone else. The data is not copied.
+	 *
+	 * @param[in] data The patch data (might be an image patch or a feature vector).
+	 */
+	void setView(const cv::Mat& data) {
+		this->data = data;
+		view = true;
+	}
+
+	/**
+	 * @return True if the data is a view into data that is owned by someone else, false if it is owned by this patch.
+	 */
+	bool isView() const {
+		return view;
+	}
+
 	/**
 	 * @return The patch data (might be an image patch or a feature vector).
 	 */
@@ -241,6 +279,7 @@ private:
 	cv::Point center; ///< The original center of this patch.
 	cv::Size size; ///< The original size of this patch.
 	cv::Mat data; ///< The patch data (might be an image patch or a feature vector).
+	bool view; ///< Flag that indicates whether the data is a view into data that is owned by someone else.
 };
 
 } /* namespace imageprocessing */
@@ -0,0 +1,109 @@
+/*
+ * PatchBatch.hpp
+ *
+ *  Created on: 18.10.2026
+ *      Author: poschmann
+ */
+
+#ifndef PATCHBATCH_HPP_
+#define PATCHBATCH_HPP_
+
+#include "imageprocessing/Patch.hpp"
+#include "opencv2/core/core.hpp"
+#include <vector>
+
+namespace imageprocessing {
+
+/**
+ * Batch of patches that is re-used between extractions (e.g. of subsequent frames) to avoid allocations.
+ *
+ * The data of the patches are views into a single arena, one continuous row per patch. As long as the number of
+ * patches and the size and type of their data do not change, neither the patches nor the arena are re-allocated.
+ * The data of the patches is overwritten by the next extraction into the same batch, so patches that should be
+ * kept must be copied (copies own their data).
+ */
+class PatchBatch {
+public:
+
+	/**
+	 * Constructs a new empty patch batch.
+	 */
+	PatchBatch() : patches(), arena() {}
+
+	/**
+	 * Changes the number of patches and lets the data of each patch be a slice of the arena.
+	 *
+	 * @param[in] count The number of patches.
+	 * @param[in] rows The number of rows of the patch data.
+	 * @param[in] cols The number of columns of the patch data.
+	 * @param[in] type The type of the patch data.
+	 */
+	void allocate(size_t count, int rows, int cols, int type) {
+		patches.resize(count);
+		arena.create(static_cast<int>(count), rows * cols * CV_MAT_CN(type), CV_MAT_DEPTH(type));
+		for (size_t i = 0; i < count; ++i)
+			patches[i].setView(arena.row(static_cast<int>(i)).reshape(CV_MAT_CN(type), rows));
+	}
+
+	/**
+	 * Changes the number of patches without touching the arena. Data of additional patches will be empty.
+	 *
+	 * @param[in] count The number of patches.
+	 */
+	void resize(size_t count) {
+		patches.resize(count);
+	}
+
+	/**
+	 * Removes all patches, but keeps the arena for later use.
+	 */
+	void clear() {
+		patches.clear();
+	}
+
+	/**
+	 * @return The number of patches.
+	 */
+	size_t size() const {
+		return patches.size();
+	}
+
+	/**
+	 * @return True if there are no patches, false otherwise.
+	 */
+	bool empty() const {
+		return patches.empty();
+	}
+
+	Patch& operator[](size_t index) {
+		return patches[index];
+	}
+
+	const Patch& operator[](size_t index) const {
+		return patches[index];
+	}
+
+	std::vector<Patch>::iterator begin() {
+		return patches.begin();
+	}
+
+	std::vector<Patch>::iterator end() {
+		return patches.end();
+	}
+
+	std::vector<Patch>::const_iterator begin() const {
+		return patches.begin();
+	}
+
+	std::vector<Patch>::const_iterator end() const {
+		return patches.end();
+	}
+
+private:
+
+	std::vector<Patch> patches; ///< The patches.
+	cv::Mat arena; ///< The data of all patches, one row per patch.
+};
+
+} /* namespace imageprocessing */
+#endif /* PATCHBATCH_HPP_ */
@@ -10,6 +10,7 @@
 #define PYRAMIDFEATUREEXTRACTOR_HPP_
 
 #include "imageprocessing/FeatureExtractor.hpp"
+#include "imageprocessing/PatchBatch.hpp"
 #include <vector>
 #include <utility>
 
@@ -52,6 +53,49 @@ public:
 	virtual std::vector<std::shared_ptr<Patch>> extract(int stepX, int stepY, cv::Rect roi = cv::Rect(),
 			int firstLayer = -1, int lastLayer = -1, int stepLayer = 1) const = 0;
 
+	/**
+	 * Extracts several patches from the layers of the corresponding image pyramid into a batch. The batch should be
+	 * re-used for subsequent extractions, so its patches and their data do not have to be allocated again. The data
+	 * of the patches is only valid until the next extraction into the same batch.
+	 *
+	 * @param[out] batch The batch that is filled with the extracted patches.
+	 * @param[in] stepX The step size in x-direction in pixels (will be the same absolute value in all pyramid layers).
+	 * @param[in] stepY The step size in y-direction in pixels (will be the same absolute value in all pyramid layers).
+	 * @param[in] roi The region of interest inside the original image (region will be scaled accordingly to the layers).
+	 * @param[in] firstLayer The index of the first layer to extract patches from.
+	 * @param[in] lastLayer The index of the last layer to extract patches from.
+	 * @param[in] stepLayer The step size for proceeding to the next layer (values greater than one will skip layers).
+	 */
+	virtual void extract(PatchBatch& batch, int stepX, int stepY, cv::Rect roi = cv::Rect(),
+			int firstLayer = -1, int lastLayer = -1, int stepLayer = 1) const {
+		std::vector<std::shared_ptr<Patch>> patches = extract(stepX, stepY, roi, firstLayer, lastLayer, stepLayer);
+		batch.resize(patches.size());
+		for (size_t i = 0; i < patches.size(); ++i) { // the patches might be shared (e.g. by a cache), so their data are not moved
+			batch[i].setX(patches[i]->getX());
+			batch[i].setY(patches[i]->getY());
+			batch[i].setWidth(patches[i]->getWidth());
+			batch[i].setHeight(patches[i]->getHeight());
+			batch[i].setView(patches[i]->getData());
+		}
+	}
+
+	/**
+	 * Determines the number of patch positions inside each layer that would be extracted with the given arguments.
+	 * The patches of an extraction are ordered by layer and each layer's patches row by row, so they form a grid of
+	 * rows x columns patches per layer.
+	 *
+	 * @param[in] stepX The step size in x-direction in pixels (will be the same absolute value in all pyramid layers).
+	 * @param[in] stepY The step size in y-direction in pixels (will be the same absolute value in all pyramid layers).
+	 * @param[in] roi The region of interest inside the original image (region will be scaled accordingly to the layers).
+	 * @param[in] firstLayer The index of the first layer to extract patches from.
+	 * @param[in] lastLayer The index of the last layer to extract patches from.
+	 * @param[in] stepLayer The step size for proceeding to the next layer (values greater than one will skip layers).
+	 * @return Pairs containing the index of each layer and its number of patch columns (width) and rows (height),
+	 *         beginning from the largest layer.
+	 */
+	virtual std::vector<std::pair<int, cv::Size>> getPatchGridSizes(int stepX, int stepY, cv::Rect roi = cv::Rect(),
+			int firstLayer = -1, int lastLayer = -1, int stepLayer = 1) const = 0;
+
 	/**
 	 * Extracts a single patch from a layer of the corresponding image pyramid.
 	 *
@@ -116,6 +160,19 @@ public:
 	 * @return The sizes of the pyramid layer's patches, beginning from the smallest patch (largest layer).
 	 */
 	virtual std::vector<cv::Size> getPatchSizes() const = 0;
+
+	/**
+	 * Determines the regions of a layer whose patches might have changed with the last update. Patches that do not
+	 * overlap any of these regions are the same as before the update.
+	 *
+	 * @param[in] layer The index of the layer.
+	 * @param[out] regions The changed regions inside the layer.
+	 * @return True if the changed regions are known, false if all patches of the layer might have changed.
+	 */
+	virtual bool getChangedRegions(int layer, std::vector<cv::Rect>& regions) const {
+		regions.clear();
+		return false;
+	}
 };
 
 } /* namespace imageprocessing */
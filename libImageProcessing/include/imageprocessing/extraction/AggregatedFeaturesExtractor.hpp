@@ -70,6 +70,8 @@ public:
 
 	std::shared_ptr<Patch> extract(cv::Rect bounds) const;
 
+	void setRegionOfInterest(cv::Rect roi) override;
+
 	std::shared_ptr<ImagePyramid> getFeaturePyramid();
 
 	/**
@@ -78,6 +78,16 @@ private:
 	 */
 	cv::Mat computeGradientEnergies(const cv::Mat& histograms, int signedBinCount) const;
 
+	/**
+	 * Computes the squared gradient energies of one row of gradient histograms.
+	 *
+	 * @param[out] energies Squared gradient energies, must have the size of the histograms image and a type of CV_32FC1.
+	 * @param[in] histograms Signed gradient histograms (further channels are ignored).
+	 * @param[in] row Index of the row to compute the energies of.
+	 * @param[in] signedBinCount Number of bins of the signed gradient histogram.
+	 */
+	void computeGradientEnergyRow(cv::Mat& energies, const cv::Mat& histograms, int row, int signedBinCount) const;
+
 	/**
 	 * Computes the squared gradient energy for a gradient histogram.
 	 * @param[in] signedHistogram Values of the signed gradient histogram.
@@ -96,16 +106,32 @@ private:
 	 */
 	void computeDescriptors(cv::Mat& descriptors, const cv::Mat& histograms, const cv::Mat& energies, int signedBinCount) const;
 
+	/**
+	 * Computes the FHOG descriptors of one row. The squared gradient energies of the row and its neighboring
+	 * rows must be computed already. The descriptors may be computed in-place, as the histogram of a cell is
+	 * only needed for the descriptor of the same cell.
+	 *
+	 * @param[out] descriptors FHOG descriptors, must have the size of the histograms image and the descriptor channel count.
+	 * @param[in] histograms Signed gradient histograms. Can be same as descriptors.
+	 * @param[in] energies Squared gradient energies.
+	 * @param[in] row Index of the row to compute the descriptors of.
+	 * @param[in] signedBinCount Number of bins of the signed gradient histogram.
+	 */
+	void computeDescriptorRow(cv::Mat& descriptors, const cv::Mat& histograms, const cv::Mat& energies, int row, int signedBinCount) const;
+
 	/**
 	 * Computes the four normalizers for a histogram, that are computed from the squared gradient energy
 	 * of four combined histograms.
 	 *
-	 * @param[in] energies Squared gradient energies (for each histogram).
-	 * @param[in] row Row index of the histogram to compute the normalizers of.
+	 * @param[in] prevEnergies Squared gradient energies of the previous row (same as current row at the top border).
+	 * @param[in] currEnergies Squared gradient energies of the row of the histogram.
+	 * @param[in] nextEnergies Squared gradient energies of the next row (same as current row at the bottom border).
 	 * @param[in] col Column index of the histogram to compute the normalizers of.
+	 * @param[in] cols Number of columns.
 	 * @return The four different normalizers of the histogram.
 	 */
-	std::array<float, 4> computeNormalizers(const cv::Mat& energies, int row, int col) const;
+	std::array<float, 4> computeNormalizers(const float* prevEnergies, const float* currEnergies,
+			const float* nextEnergies, int col, int cols) const;
 
 	/**
 	 * Computes a descriptor.
@@ -86,15 +86,35 @@ private:
 
 	void createGradientLut();
 
+	/**
+	 * Computes the FHOG descriptors in a single pass over the image. The signed histograms are accumulated
+	 * into the descriptor image row by row. As soon as a row of histograms does not receive any more pixel
+	 * contributions, its gradient energies are computed, and as soon as the energies of the neighboring rows
+	 * are known, the histograms of a row are turned into the final descriptors in-place. This way, the
+	 * histograms are normalized while they are still in the cache.
+	 *
+	 * @param[in] image Image of type CV_8UC1 (singleChannel) or CV_8UC3.
+	 * @param[in,out] descriptors Zero-initialized image that has the size and channel count of the descriptors.
+	 */
 	template<bool singleChannel>
-	void computeSignedHistograms(const cv::Mat& singleGradientImage, cv::Mat& signedHistograms) const;
+	void computeDescriptors(const cv::Mat& image, cv::Mat& descriptors) const;
 
 	std::vector<Coefficients> computeInterpolationCoefficents(int size, int count) const;
 
+	/**
+	 * Determines the last image row that contributes to each row of cells.
+	 *
+	 * @param[in] rowCoefficients Interpolation coefficients of the image rows.
+	 * @param[in] rows Number of cell rows.
+	 * @return Index of the last contributing image row for each cell row.
+	 */
+	std::vector<int> computeLastContributingRows(const std::vector<Coefficients>& rowCoefficients, int rows) const;
+
 	template<bool singleChannel>
-	Coefficients getBinCoefficients(const cv::Mat& image, int row, int col) const;
+	Coefficients getBinCoefficients(const uchar* upValues, const uchar* values, const uchar* downValues, int prevCol, int col, int nextCol) const;
 
-	void addToSignedHistograms(cv::Mat& signedHistograms, Coefficients rowCoeff, Coefficients colCoeff, Coefficients binCoeff) const;
+	void addToSignedHistograms(float* histograms1, float* histograms2, int descriptorSize,
+			Coefficients rowCoeff, Coefficients colCoeff, Coefficients binCoeff) const;
 
 	float computeOrientation(float gradientX, float gradientY) const;
 
@@ -118,69 +138,80 @@ private:
 };
 
 template<bool singleChannel>
-inline void FhogFilter::computeSignedHistograms(const cv::Mat& image, cv::Mat& signedHistograms) const {
-	assert(image.rows >= signedHistograms.rows * cellSize);
-	assert(image.cols >= signedHistograms.cols * cellSize);
-	std::vector<Coefficients> rowCoefficients = computeInterpolationCoefficents(signedHistograms.rows * cellSize, signedHistograms.rows);
-	std::vector<Coefficients> colCoefficients = computeInterpolationCoefficents(signedHistograms.cols * cellSize, signedHistograms.cols);
-	int channels = image.channels();
+inline void FhogFilter::computeDescriptors(const cv::Mat& image, cv::Mat& descriptors) const {
+	assert(image.rows >= descriptors.rows * cellSize);
+	assert(image.cols >= descriptors.cols * cellSize);
+	std::vector<Coefficients> rowCoefficients = computeInterpolationCoefficents(descriptors.rows * cellSize, descriptors.rows);
+	std::vector<Coefficients> colCoefficients = computeInterpolationCoefficents(descriptors.cols * cellSize, descriptors.cols);
+	std::vector<int> lastContributingRows = computeLastContributingRows(rowCoefficients, descriptors.rows);
+	cv::Mat energies(descriptors.rows, descriptors.cols, CV_32FC1);
+	int descriptorSize = descriptors.channels();
+	int completedRows = 0; // rows of histograms that are complete and whose energies are computed
+	int finishedRows = 0; // rows of final descriptors
 	for (int imageRow = 0; imageRow < rowCoefficients.size(); ++imageRow) {
+		const uchar* upValues = image.ptr<uchar>(std::max(imageRow - 1, 0));
+		const uchar* values = image.ptr<uchar>(imageRow);
+		const uchar* downValues = image.ptr<uchar>(std::min(imageRow + 1, image.rows - 1));
+		Coefficients rowCoeff = rowCoefficients[imageRow];
+		float* histograms1 = descriptors.ptr<float>(rowCoeff.index1);
+		float* histograms2 = interpolateCells ? descriptors.ptr<float>(rowCoeff.index2) : histograms1;
 		for (int imageCol = 0; imageCol < colCoefficients.size(); ++imageCol) {
-			Coefficients binCoeff = getBinCoefficients<singleChannel>(image, imageRow, imageCol);
-			addToSignedHistograms(signedHistograms, rowCoefficients[imageRow], colCoefficients[imageCol], binCoeff);
+			int prevCol = std::max(imageCol - 1, 0);
+			int nextCol = std::min(imageCol + 1, image.cols - 1);
+			Coefficients binCoeff = getBinCoefficients<singleChannel>(upValues, values, downValues, prevCol, imageCol, nextCol);
+			addToSignedHistograms(histograms1, histograms2, descriptorSize, rowCoeff, colCoefficients[imageCol], binCoeff);
 		}
+		while (completedRows < descriptors.rows && lastContributingRows[completedRows] <= imageRow)
+			fhogAggregationFilter.computeGradientEnergyRow(energies, descriptors, completedRows++, signedBinCount);
+		while (finishedRows < completedRows && std::min(finishedRows + 1, descriptors.rows - 1) < completedRows)
+			fhogAggregationFilter.computeDescriptorRow(descriptors, descriptors, energies, finishedRows++, signedBinCount);
 	}
 }
 
 template<>
-inline FhogFilter::Coefficients FhogFilter::getBinCoefficients<true>(const cv::Mat& image, int row, int col) const {
-	int prevRow = std::max(row - 1, 0);
-	int nextRow = std::min(row + 1, image.rows - 1);
-	int prevCol = std::max(col - 1, 0);
-	int nextCol = std::min(col + 1, image.cols - 1);
-	int dx = image.at<uchar>(row, nextCol) - image.at<uchar>(row, prevCol) + 256;
-	int dy = image.at<uchar>(nextRow, col) - image.at<uchar>(prevRow, col) + 256;
+inline FhogFilter::Coefficients FhogFilter::getBinCoefficients<true>(
+		const uchar* upValues, const uchar* values, const uchar* downValues, int prevCol, int col, int nextCol) const {
+	int dx = values[nextCol] - values[prevCol] + 256;
+	int dy = downValues[col] - upValues[col] + 256;
 	return binLut[dy * 512 + dx].bins;
 }
 
 template<>
-inline FhogFilter::Coefficients FhogFilter::getBinCoefficients<false>(const cv::Mat& image, int row, int col) const {
-	int prevRow = std::max(row - 1, 0);
-	int nextRow = std::min(row + 1, image.rows - 1);
-	int prevCol = std::max(col - 1, 0);
-	int nextCol = std::min(col + 1, image.cols - 1);
-	const uchar* upValues = image.ptr<uchar>(prevRow, col);
-	const uchar* downValues = image.ptr<uchar>(nextRow, col);
-	const uchar* leftValues = image.ptr<uchar>(row, prevCol);
-	const uchar* rightValues = image.ptr<uchar>(row, nextCol);
+inline FhogFilter::Coefficients FhogFilter::getBinCoefficients<false>(
+		const uchar* upValues, const uchar* values, const uchar* downValues, int prevCol, int col, int nextCol) const {
+	upValues += 3 * col;
+	downValues += 3 * col;
+	const uchar* leftValues = values + 3 * prevCol;
+	const uchar* rightValues = values + 3 * nextCol;
 	int dx1 = rightValues[0] - leftValues[0] + 256;
 	int dy1 = downValues[0] - upValues[0] + 256;
 	int dx2 = rightValues[1] - leftValues[1] + 256;
 	int dy2 = downValues[1] - upValues[1] + 256;
 	int dx3 = rightValues[2] - leftValues[2] + 256;
 	int dy3 = downValues[2] - upValues[2] + 256;
-	int index1 = dy1 * 512 + dx1;
-	int index2 = dy2 * 512 + dx2;
-	int index3 = dy3 * 512 + dx3;
-	if (binLut[index1].magnitude > binLut[index2].magnitude) {
-		if (binLut[index1].magnitude > binLut[index3].magnitude)
-			return binLut[index1].bins;
+	const LutEntry& entry1 = binLut[dy1 * 512 + dx1];
+	const LutEntry& entry2 = binLut[dy2 * 512 + dx2];
+	const LutEntry& entry3 = binLut[dy3 * 512 + dx3];
+	if (entry1.magnitude > entry2.magnitude) {
+		if (entry1.magnitude > entry3.magnitude)
+			return entry1.bins;
 		else
-			return binLut[index3].bins;
+			return entry3.bins;
 	} else {
-		if (binLut[index2].magnitude > binLut[index3].magnitude)
-			return binLut[index2].bins;
+		if (entry2.magnitude > entry3.magnitude)
+			return entry2.bins;
 		else
-			return binLut[index3].bins;
+			return entry3.bins;
 	}
 }
 
-inline void FhogFilter::addToSignedHistograms(cv::Mat& signedHistograms, Coefficients rowCoeff, Coefficients colCoeff, Coefficients binCoeff) const {
+inline void FhogFilter::addToSignedHistograms(float* histograms1, float* histograms2, int descriptorSize,
+		Coefficients rowCoeff, Coefficients colCoeff, Coefficients binCoeff) const {
 	if (interpolateCells) {
-		float* histogram11 = signedHistograms.ptr<float>(rowCoeff.index1, colCoeff.index1);
-		float* histogram12 = signedHistograms.ptr<float>(rowCoeff.index1, colCoeff.index2);
-		float* histogram21 = signedHistograms.ptr<float>(rowCoeff.index2, colCoeff.index1);
-		float* histogram22 = signedHistograms.ptr<float>(rowCoeff.index2, colCoeff.index2);
+		float* histogram11 = histograms1 + colCoeff.index1 * descriptorSize;
+		float* histogram12 = histograms1 + colCoeff.index2 * descriptorSize;
+		float* histogram21 = histograms2 + colCoeff.index1 * descriptorSize;
+		float* histogram22 = histograms2 + colCoeff.index2 * descriptorSize;
 		if (interpolateBins) {
 			histogram11[binCoeff.index1] += binCoeff.weight1 * rowCoeff.weight1 * colCoeff.weight1;
 			histogram11[binCoeff.index2] += binCoeff.weight2 * rowCoeff.weight1 * colCoeff.weight1;
@@ -197,7 +228,7 @@ inline void FhogFilter::addToSignedHistograms(cv::Mat& signedHistograms, Coeffic
 			histogram22[binCoeff.index1] += binCoeff.weight1 * rowCoeff.weight2 * colCoeff.weight2;
 		}
 	} else {
-		float* histogram = signedHistograms.ptr<float>(rowCoeff.index1, colCoeff.index1);
+		float* histogram = histograms1 + colCoeff.index1 * descriptorSize;
 		if (interpolateBins) {
 			histogram[binCoeff.index1] += binCoeff.weight1;
 			histogram[binCoeff.index2] += binCoeff.weight2;
@@ -34,9 +34,17 @@ public:
 	 * Applies the filter to an image and the previously added filter chains to the filtered image.
 	 *
 	 * @param[in] image Image that should be put through the filter chains.
+	 * @param[in] concurrent Flag that indicates whether the child nodes may be applied concurrently.
 	 * @return Result of each of the filter chains.
 	 */
-	std::vector<cv::Mat> applyTo(const cv::Mat& image) const;
+	std::vector<cv::Mat> applyTo(const cv::Mat& image, bool concurrent) const;
+
+	/**
+	 * Adds the filters of this node and its child nodes (including the filters inside of composite filters) to a list.
+	 *
+	 * @param[in,out] filters List of filters the filters of this node and its descendants are added to.
+	 */
+	void collectFilters(std::vector<const ImageFilter*>& filters) const;
 
 	/**
 	 * Adds a filter chain that is applied to images after the filter of this node.
@@ -82,6 +90,12 @@ private:
  * the resulting filtered image, so there are no duplicate filter operations. To accomplish this goal, a tree
  * structure is created, where each node applies one filter, passes the filtered image down to other nodes and
  * collects and returns their filter results.
+ *
+ * Sibling nodes are applied concurrently, unless a filter instance is used more than once, including the filters
+ * inside of composite filters like ChainedFilter (some filters use internal buffers and must not be applied by
+ * several threads at the same time). The filtered images of a node are
+ * released as soon as its children are done. The results are merged row-wise in parallel directly into the result
+ * image, which is only re-allocated if its size or type changes.
  */
 class FilterTree : public ImageFilter {
 public:
@@ -97,6 +111,8 @@ public:
 	 */
 	cv::Mat applyTo(const cv::Mat& image, cv::Mat& result) const;
 
+	void collectInstances(std::vector<const ImageFilter*>& instances) const;
+
 	/**
 	 * Adds a filter chain that is applied to images.
 	 *
@@ -114,6 +130,14 @@ public:
 
 private:
 
+	/**
+	 * Determines whether each filter instance (including the ones inside of composite filters) is used only once,
+	 * so the nodes can be applied concurrently.
+	 *
+	 * @return True if there are no filters shared by several nodes, false otherwise.
+	 */
+	bool hasDistinctFilters() const;
+
 	std::vector<detail::FilterNode> nodes; ///< Nodes the image is passed down to.
 };
 
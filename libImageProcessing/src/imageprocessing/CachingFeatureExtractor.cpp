@@ -28,6 +28,11 @@ void CachingFeatureExtractor::update(shared_ptr<VersionedImage> image) {
 	}
 }
 
+void CachingFeatureExtractor::setRegionOfInterest(cv::Rect roi) {
+	extractor->setRegionOfInterest(roi);
+	version = Version(); // patches outside of the previous region of interest must not be taken from the cache
+}
+
 shared_ptr<Patch> CachingFeatureExtractor::extract(int x, int y, int width, int height) const {
 	switch (strategy) {
 	case Strategy::SHARING:
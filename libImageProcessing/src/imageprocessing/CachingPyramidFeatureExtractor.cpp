@@ -8,6 +8,7 @@
 #include "imageprocessing/CachingPyramidFeatureExtractor.hpp"
 #include "imageprocessing/VersionedImage.hpp"
 #include "imageprocessing/Patch.hpp"
+#include <algorithm>
 #include <stdexcept>
 
 using cv::Mat;
@@ -15,6 +16,7 @@ using cv::Size;
 using cv::Rect;
 using cv::Point;
 using std::pair;
+using std::make_pair;
 using std::vector;
 using std::shared_ptr;
 using std::make_shared;
@@ -23,26 +25,56 @@ using std::invalid_argument;
 
 namespace imageprocessing {
 
-CachingPyramidFeatureExtractor::CachingPyramidFeatureExtractor(shared_ptr<PyramidFeatureExtractor> extractor, Strategy strategy) :
-		extractor(extractor), cache(), firstCacheIndex(0), strategy(strategy), version() {}
+CachingPyramidFeatureExtractor::CachingPyramidFeatureExtractor(shared_ptr<PyramidFeatureExtractor> extractor,
+		Strategy strategy, Storage storage) :
+				extractor(extractor), cache(), firstCacheIndex(0), strategy(strategy), storage(storage), version() {}
 
 void CachingPyramidFeatureExtractor::buildCache() {
 	cache.clear();
 	vector<pair<int, double>> scales = getLayerScales();
+	vector<Size> sizes;
+	if (storage == Storage::DENSE)
+		sizes = getLayerSizes();
 	if (!scales.empty())
 		firstCacheIndex = scales[0].first;
-	for (const pair<int, double>& scale : scales)
-		cache.push_back(CacheLayer(scale.first, scale.second));
+	for (size_t i = 0; i < scales.size(); ++i) {
+		Size gridSize = i < sizes.size() ? sizes[i] : Size(0, 0);
+		cache.push_back(CacheLayer(scales[i].first, scales[i].second, gridSize));
+	}
 }
 
 void CachingPyramidFeatureExtractor::update(shared_ptr<VersionedImage> image) {
 	extractor->update(image);
 	if (version != image->getVersion()) {
-		buildCache();
+		invalidateCache();
 		version = image->getVersion();
 	}
 }
 
+void CachingPyramidFeatureExtractor::invalidateCache() {
+	vector<pair<int, double>> scales = getLayerScales();
+	bool layersChanged = scales.size() != cache.size();
+	for (size_t i = 0; !layersChanged && i < scales.size(); ++i)
+		layersChanged = scales[i].first != cache[i].getIndex() || scales[i].second != cache[i].getScaleFactor();
+	if (layersChanged) {
+		buildCache();
+		return;
+	}
+	Size patchSize = getPatchSize();
+	vector<Rect> changedRegions;
+	for (CacheLayer& layer : cache) {
+		if (extractor->getChangedRegions(layer.getIndex(), changedRegions))
+			layer.remove(changedRegions, patchSize);
+		else
+			layer.clear();
+	}
+}
+
+void CachingPyramidFeatureExtractor::setRegionOfInterest(Rect roi) {
+	extractor->setRegionOfInterest(roi);
+	version = Version(); // patches outside of the previous region of interest must not be taken from the cache
+}
+
 shared_ptr<Patch> CachingPyramidFeatureExtractor::extract(int x, int y, int width, int height) const {
 	int layerIndex = getLayerIndex(width, height);
 	int index = layerIndex - firstCacheIndex;
@@ -123,6 +155,48 @@ vector<shared_ptr<Patch>> CachingPyramidFeatureExtractor::extract(int stepX, int
 	return patches;
 }
 
+vector<pair<int, Size>> CachingPyramidFeatureExtractor::getPatchGridSizes(int stepX, int stepY, Rect roi,
+		int firstLayer, int lastLayer, int stepLayer) const {
+	if (stepX < 1)
+		throw invalid_argument("CachingPyramidFeatureExtractor: stepX has to be greater than zero");
+	if (stepY < 1)
+		throw invalid_argument("CachingPyramidFeatureExtractor: stepY has to be greater than zero");
+	if (stepLayer < 1)
+		throw invalid_argument("CachingPyramidFeatureExtractor: stepLayer has to be greater than zero");
+	Size imageSize = getImageSize();
+	if (roi.x == 0 && roi.y == 0 && roi.width == 0 && roi.height == 0) {
+		roi.width = imageSize.width;
+		roi.height = imageSize.height;
+	} else {
+		roi.x = std::max(0, roi.x);
+		roi.y = std::max(0, roi.y);
+		roi.width = std::min(imageSize.width, roi.width + roi.x) - roi.x;
+		roi.height = std::min(imageSize.height, roi.height + roi.y) - roi.y;
+	}
+	vector<pair<int, Size>> gridSizes;
+	if (firstLayer < 0)
+		firstLayer = cache.front().getIndex();
+	if (lastLayer < 0)
+		lastLayer = cache.back().getIndex();
+	for (auto layer = cache.begin(); layer != cache.end(); layer += stepLayer) {
+		if (layer->getIndex() < firstLayer)
+			continue;
+		if (layer->getIndex() > lastLayer)
+			break;
+
+		// same as the number of iterations of the loops in extract(stepX, stepY, ...)
+		Size patchSize = getPatchSize();
+		Point roiBegin(layer->getScaled(roi.x), layer->getScaled(roi.y));
+		Point roiEnd(layer->getScaled(roi.x + roi.width), layer->getScaled(roi.y + roi.height));
+		Point centerRoiBegin = Point(roiBegin.x + patchSize.width / 2, roiBegin.y + patchSize.height / 2);
+		Point centerRoiEnd = Point(roiEnd.x - patchSize.width, roiEnd.y - patchSize.height);
+		int cols = centerRoiEnd.x > centerRoiBegin.x ? (centerRoiEnd.x - centerRoiBegin.x - 1) / stepX + 1 : 0;
+		int rows = centerRoiEnd.y > centerRoiBegin.y ? (centerRoiEnd.y - centerRoiBegin.y - 1) / stepY + 1 : 0;
+		gridSizes.push_back(make_pair(layer->getIndex(), Size(cols, rows)));
+	}
+	return gridSizes;
+}
+
 shared_ptr<Patch> CachingPyramidFeatureExtractor::extract(int layerIndex, int x, int y) const {
 	int index = layerIndex - firstCacheIndex;
 	if (index < 0 || static_cast<unsigned int>(index) >= cache.size())
@@ -143,53 +217,147 @@ shared_ptr<Patch> CachingPyramidFeatureExtractor::extract(int layerIndex, int x,
 }
 
 shared_ptr<Patch> CachingPyramidFeatureExtractor::extractSharing(CacheLayer& layer, int x, int y) const {
-	CacheKey key(x, y);
-	unordered_map<CacheKey, shared_ptr<Patch>, CacheKey::hash>& layerCache = layer.getCache();
-	auto iterator = layerCache.find(key);
-	if (iterator == layerCache.end()) {
+	shared_ptr<Patch>* cachedPatch = layer.find(x, y);
+	if (!cachedPatch) {
 		shared_ptr<Patch> patch = extractor->extract(layer.getIndex(), x, y);
-		layerCache.emplace(key, patch);
+		layer.store(x, y, patch);
 		return patch;
 	}
-	return iterator->second;
+	return *cachedPatch;
 }
 
 shared_ptr<Patch> CachingPyramidFeatureExtractor::extractCopying(CacheLayer& layer, int x, int y) const {
-	CacheKey key(x, y);
-	unordered_map<CacheKey, shared_ptr<Patch>, CacheKey::hash>& layerCache = layer.getCache();
-	auto iterator = layerCache.find(key);
-	if (iterator == layerCache.end()) {
+	shared_ptr<Patch>* cachedPatch = layer.find(x, y);
+	if (!cachedPatch) {
 		shared_ptr<Patch> patch = extractor->extract(layer.getIndex(), x, y);
 		if (patch) // store a copy of the patch only if it exists
-			layerCache.emplace(key, make_shared<Patch>(*patch));
+			layer.storeCopy(x, y, *patch);
 		return patch;
 	}
-	return make_shared<Patch>(*(iterator->second));
+	return make_shared<Patch>(**cachedPatch);
 }
 
 shared_ptr<Patch> CachingPyramidFeatureExtractor::extractInputCopying(CacheLayer& layer, int x, int y) const {
-	CacheKey key(x, y);
-	unordered_map<CacheKey, shared_ptr<Patch>, CacheKey::hash>& layerCache = layer.getCache();
-	auto iterator = layerCache.find(key);
-	if (iterator == layerCache.end()) {
+	shared_ptr<Patch>* cachedPatch = layer.find(x, y);
+	if (!cachedPatch) {
 		shared_ptr<Patch> patch = extractor->extract(layer.getIndex(), x, y);
 		if (patch) // store a copy of the patch only if it exists
-			layerCache.emplace(key, make_shared<Patch>(*patch));
+			layer.storeCopy(x, y, *patch);
 		return patch;
 	}
-	return iterator->second;
+	return *cachedPatch;
 }
 
 shared_ptr<Patch> CachingPyramidFeatureExtractor::extractOutputCopying(CacheLayer& layer, int x, int y) const {
-	CacheKey key(x, y);
-	unordered_map<CacheKey, shared_ptr<Patch>, CacheKey::hash>& layerCache = layer.getCache();
-	auto iterator = layerCache.find(key);
-	if (iterator == layerCache.end()) {
+	shared_ptr<Patch>* cachedPatch = layer.find(x, y);
+	if (!cachedPatch) {
 		shared_ptr<Patch> patch = extractor->extract(layer.getIndex(), x, y);
-		layerCache.emplace(key, patch);
+		layer.store(x, y, patch);
 		return patch;
 	}
-	return make_shared<Patch>(*(iterator->second));
+	return make_shared<Patch>(**cachedPatch);
+}
+
+shared_ptr<Patch>* CachingPyramidFeatureExtractor::CacheLayer::find(int x, int y) {
+	if (isInGrid(x, y)) {
+		int position = y * gridSize.width + x;
+		return valid[position] ? &patches[position] : nullptr;
+	}
+	auto iterator = cache.find(CacheKey(x, y));
+	return iterator == cache.end() ? nullptr : &iterator->second;
+}
+
+void CachingPyramidFeatureExtractor::CacheLayer::store(int x, int y, const shared_ptr<Patch>& patch) {
+	if (isInGrid(x, y)) {
+		int position = y * gridSize.width + x;
+		remove(position);
+		patches[position] = patch;
+		valid[position] = true;
+	} else {
+		cache.emplace(CacheKey(x, y), patch);
+	}
+}
+
+void CachingPyramidFeatureExtractor::CacheLayer::storeCopy(int x, int y, const Patch& patch) {
+	if (!isInGrid(x, y) || patch.getData().empty() || !patch.getData().isContinuous()) {
+		store(x, y, make_shared<Patch>(patch));
+		return;
+	}
+	int position = y * gridSize.width + x;
+	remove(position);
+	int chunkIndex;
+	Mat data = allocate(patch.getData(), chunkIndex);
+	patch.getData().copyTo(data);
+	shared_ptr<Patch> copy = make_shared<Patch>(patch.getX(), patch.getY(), patch.getWidth(), patch.getHeight(), Mat());
+	copy->setView(data);
+	patches[position] = copy;
+	valid[position] = true;
+	chunkIndices[position] = chunkIndex;
+	++chunkUsages[chunkIndex];
+}
+
+Mat CachingPyramidFeatureExtractor::CacheLayer::allocate(const Mat& data, int& chunkIndex) {
+	int rowLength = static_cast<int>(data.total()) * data.channels();
+	if (chunks.empty() || chunkRow == chunkRowCount || chunks.back().cols != rowLength || chunks.back().type() != data.depth()) {
+		if (!chunks.empty() && chunkUsages.back() == 0) // the previous chunk is not used anymore
+			chunks.back().release();
+		chunks.push_back(Mat(chunkRowCount, rowLength, data.depth()));
+		chunkUsages.push_back(0);
+		chunkRow = 0;
+	}
+	chunkIndex = static_cast<int>(chunks.size()) - 1;
+	return chunks.back().row(chunkRow++).reshape(data.channels(), data.rows);
+}
+
+void CachingPyramidFeatureExtractor::CacheLayer::remove(int position) {
+	valid[position] = false;
+	patches[position].reset();
+	int chunkIndex = chunkIndices[position];
+	if (chunkIndex >= 0) {
+		chunkIndices[position] = -1;
+		// the last chunk is kept for further copies, the others are released as soon as they are unused
+		if (--chunkUsages[chunkIndex] == 0 && chunkIndex != static_cast<int>(chunks.size()) - 1)
+			chunks[chunkIndex].release();
+	}
+}
+
+void CachingPyramidFeatureExtractor::CacheLayer::remove(const vector<Rect>& regions, Size patchSize) {
+	for (auto iterator = cache.begin(); iterator != cache.end();) {
+		Rect patchBounds(iterator->first.getX() - patchSize.width / 2, iterator->first.getY() - patchSize.height / 2,
+				patchSize.width, patchSize.height);
+		bool changed = std::any_of(regions.begin(), regions.end(), [&](const Rect& region) {
+			return (patchBounds & region).area() > 0;
+		});
+		if (changed)
+			iterator = cache.erase(iterator);
+		else
+			++iterator;
+	}
+	for (const Rect& region : regions) {
+		// centers of the patches that overlap the region
+		int beginX = std::max(0, region.x - patchSize.width + patchSize.width / 2 + 1);
+		int beginY = std::max(0, region.y - patchSize.height + patchSize.height / 2 + 1);
+		int endX = std::min(gridSize.width, region.br().x + patchSize.width / 2);
+		int endY = std::min(gridSize.height, region.br().y + patchSize.height / 2);
+		for (int y = beginY; y < endY; ++y) {
+			for (int x = beginX; x < endX; ++x) {
+				int position = y * gridSize.width + x;
+				if (valid[position])
+					remove(position);
+			}
+		}
+	}
+}
+
+void CachingPyramidFeatureExtractor::CacheLayer::clear() {
+	cache.clear();
+	std::fill(valid.begin(), valid.end(), false);
+	std::fill(patches.begin(), patches.end(), shared_ptr<Patch>());
+	std::fill(chunkIndices.begin(), chunkIndices.end(), -1);
+	// patches that are still used elsewhere keep their chunk alive
+	chunks.clear();
+	chunkUsages.clear();
+	chunkRow = 0;
 }
 
 } /* namespace imageprocessing */
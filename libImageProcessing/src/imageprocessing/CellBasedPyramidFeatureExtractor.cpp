@@ -55,6 +55,30 @@ vector<shared_ptr<Patch>> CellBasedPyramidFeatureExtractor::extract(int stepX, i
 			roi, firstLayer, lastLayer, stepLayer);
 }
 
+void CellBasedPyramidFeatureExtractor::extract(PatchBatch& batch, int stepX, int stepY, Rect roi,
+		int firstLayer, int lastLayer, int stepLayer) const {
+	if (stepX < 1)
+		throw invalid_argument("CellBasedPyramidFeatureExtractor: stepX has to be greater than zero");
+	if (stepY < 1)
+		throw invalid_argument("CellBasedPyramidFeatureExtractor: stepY has to be greater than zero");
+	DirectPyramidFeatureExtractor::extract(batch,
+			std::max(1, static_cast<int>(std::round(stepX / static_cast<double>(cellSize)))),
+			std::max(1, static_cast<int>(std::round(stepY / static_cast<double>(cellSize)))),
+			roi, firstLayer, lastLayer, stepLayer);
+}
+
+vector<pair<int, cv::Size>> CellBasedPyramidFeatureExtractor::getPatchGridSizes(int stepX, int stepY, Rect roi,
+		int firstLayer, int lastLayer, int stepLayer) const {
+	if (stepX < 1)
+		throw invalid_argument("CellBasedPyramidFeatureExtractor: stepX has to be greater than zero");
+	if (stepY < 1)
+		throw invalid_argument("CellBasedPyramidFeatureExtractor: stepY has to be greater than zero");
+	return DirectPyramidFeatureExtractor::getPatchGridSizes(
+			std::max(1, static_cast<int>(std::round(stepX / static_cast<double>(cellSize)))),
+			std::max(1, static_cast<int>(std::round(stepY / static_cast<double>(cellSize)))),
+			roi, firstLayer, lastLayer, stepLayer);
+}
+
 const shared_ptr<ImagePyramidLayer> CellBasedPyramidFeatureExtractor::getLayer(int width) const {
 	double scaleFactor = static_cast<double>(realPatchWidth) / static_cast<double>(width);
 	return getPyramid()->getLayer(scaleFactor);
@@ -36,10 +36,13 @@ void ChainedFilter::add(shared_ptr<ImageFilter> filter) {
 Mat ChainedFilter::applyTo(const Mat &image, Mat &filtered) const {
 	if (filters.empty()) {
 		image.copyTo(filtered);
-	} else {
+	} else if (filters.size() == 1) {
 		filters[0]->applyTo(image, filtered);
-		for (unsigned int i = 1; i < filters.size(); ++i)
-			filters[i]->applyInPlace(filtered);
+	} else { // the intermediate results differ in size or type, so only the last filter writes into the given image
+		Mat intermediate = filters[0]->applyTo(image);
+		for (unsigned int i = 1; i < filters.size() - 1; ++i)
+			filters[i]->applyInPlace(intermediate);
+		filters.back()->applyTo(intermediate, filtered);
 	}
 	return filtered;
 }
@@ -49,4 +52,10 @@ void ChainedFilter::applyInPlace(Mat& image) const {
 		filters[i]->applyInPlace(image);
 }
 
+void ChainedFilter::collectInstances(vector<const ImageFilter*>& instances) const {
+	instances.push_back(this);
+	for (const shared_ptr<ImageFilter>& filter : filters)
+		filter->collectInstances(instances);
+}
+
 } /* namespace imageprocessing */
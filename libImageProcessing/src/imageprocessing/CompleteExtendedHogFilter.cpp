@@ -6,6 +6,8 @@
  */
 
 #include "imageprocessing/CompleteExtendedHogFilter.hpp"
+#include "imageprocessing/ExtendedHogFilter.hpp"
+#include <algorithm>
 #include <stdexcept>
 
 using cv::Mat;
@@ -165,57 +167,43 @@ void CompleteExtendedHogFilter::buildDescriptors(Mat& descriptors, size_t cellRo
 
 	// compute gradient energy of cells
 	Mat energies(descriptors.rows, descriptors.cols, CV_32FC1);
-	if (signedGradients) {
-		// gradient energy should be computed over unsigned gradients, so the signed parts have to be added up
-		for (size_t rowIndex = 0; rowIndex < cellRowCount; ++rowIndex) {
-			for (size_t colIndex = 0; colIndex < cellColumnCount; ++colIndex) {
-				float energy = 0;
-				float* histogramValues = descriptors.ptr<float>(rowIndex, colIndex);
+	for (size_t rowIndex = 0; rowIndex < cellRowCount; ++rowIndex) {
+		const float* histogramValues = descriptors.ptr<float>(rowIndex);
+		float* rowEnergies = energies.ptr<float>(rowIndex);
+		for (size_t colIndex = 0; colIndex < cellColumnCount; ++colIndex, histogramValues += descriptorSize) {
+			float energy = 0;
+			if (signedGradients) {
+				// gradient energy should be computed over unsigned gradients, so the signed parts have to be added up
 				for (size_t binIndex = 0; binIndex < binHalfCount; ++binIndex) {
 					float unsignedBinValue = histogramValues[binIndex] + histogramValues[binIndex + binHalfCount];
 					energy += unsignedBinValue * unsignedBinValue;
 				}
-				energies.at<float>(rowIndex, colIndex) = energy;
-			}
-		}
-	} else {
-		for (size_t rowIndex = 0; rowIndex < cellRowCount; ++rowIndex) {
-			for (size_t colIndex = 0; colIndex < cellColumnCount; ++colIndex) {
-				float energy = 0;
-				float* histogramValues = descriptors.ptr<float>(rowIndex, colIndex);
+			} else {
 				for (size_t binIndex = 0; binIndex < binCount; ++binIndex)
 					energy += histogramValues[binIndex] * histogramValues[binIndex];
-				energies.at<float>(rowIndex, colIndex) = energy;
 			}
+			rowEnergies[colIndex] = energy;
 		}
 	}
 
-	// build normalized cell descriptors
-	if (signedGradients && unsignedGradients) { // signed and unsigned gradients should be combined into descriptor
-		for (size_t rowIndex = 0; rowIndex < cellRowCount; ++rowIndex) {
-			for (size_t colIndex = 0; colIndex < cellColumnCount; ++colIndex) {
-				float* descriptor = descriptors.ptr<float>(rowIndex, colIndex);
-				int r1 = rowIndex;
-				int r0 = std::max(0, static_cast<int>(rowIndex) - 1);
-				int r2 = std::min(rowIndex + 1, cellRowCount - 1);
-				int c1 = colIndex;
-				int c0 = std::max(0, static_cast<int>(colIndex) - 1);
-				int c2 = std::min(colIndex + 1, cellColumnCount - 1);
-				float sqn00 = energies.at<float>(r0, c0);
-				float sqn01 = energies.at<float>(r0, c1);
-				float sqn02 = energies.at<float>(r0, c2);
-				float sqn10 = energies.at<float>(r1, c0);
-				float sqn11 = energies.at<float>(r1, c1);
-				float sqn12 = energies.at<float>(r1, c2);
-				float sqn20 = energies.at<float>(r2, c0);
-				float sqn21 = energies.at<float>(r2, c1);
-				float sqn22 = energies.at<float>(r2, c2);
-				float n1 = 1.f / sqrt(sqn00 + sqn01 + sqn10 + sqn11 + eps);
-				float n2 = 1.f / sqrt(sqn01 + sqn02 + sqn11 + sqn12 + eps);
-				float n3 = 1.f / sqrt(sqn10 + sqn11 + sqn20 + sqn21 + eps);
-				float n4 = 1.f / sqrt(sqn11 + sqn12 + sqn21 + sqn22 + eps);
+	// compute the normalizers of each block once instead of four times (once for each cell of the block)
+	Mat normalizers;
+	ExtendedHogFilter::computeBlockNormalizers(energies, normalizers, eps);
 
-				// unsigned orientation features (aka contrast-insensitive)
+	// build normalized cell descriptors
+	bool signedAndUnsigned = signedGradients && unsignedGradients;
+	for (size_t rowIndex = 0; rowIndex < cellRowCount; ++rowIndex) {
+		float* descriptor = descriptors.ptr<float>(rowIndex);
+		const float* upperNormalizers = normalizers.ptr<float>(rowIndex);
+		const float* lowerNormalizers = normalizers.ptr<float>(rowIndex + 1);
+		for (size_t colIndex = 0; colIndex < cellColumnCount; ++colIndex, descriptor += descriptorSize) {
+			float n1 = upperNormalizers[colIndex];
+			float n2 = upperNormalizers[colIndex + 1];
+			float n3 = lowerNormalizers[colIndex];
+			float n4 = lowerNormalizers[colIndex + 1];
+
+			// unsigned orientation features (aka contrast-insensitive), computed first as the signed bins are overwritten
+			if (signedAndUnsigned) {
 				for (size_t binIndex = 0; binIndex < binHalfCount; ++binIndex) {
 					float sum = descriptor[binIndex] + descriptor[binIndex + binHalfCount];
 					float h1 = std::min(alpha, sum * n1);
@@ -224,80 +212,32 @@ void CompleteExtendedHogFilter::buildDescriptors(Mat& descriptors, size_t cellRo
 					float h4 = std::min(alpha, sum * n4);
 					descriptor[binCount + binIndex] = 0.5 * (h1 + h2 + h3 + h4);
 				}
-
-				float t1 = 0;
-				float t2 = 0;
-				float t3 = 0;
-				float t4 = 0;
-
-				// signed orientation features (aka contrast-sensitive)
-				for (size_t binIndex = 0; binIndex < binCount; ++binIndex) {
-					float h1 = std::min(alpha, descriptor[binIndex] * n1);
-					float h2 = std::min(alpha, descriptor[binIndex] * n2);
-					float h3 = std::min(alpha, descriptor[binIndex] * n3);
-					float h4 = std::min(alpha, descriptor[binIndex] * n4);
-					descriptor[binIndex] = 0.5 * (h1 + h2 + h3 + h4);
-					t1 += h1;
-					t2 += h2;
-					t3 += h3;
-					t4 += h4;
-				}
-
-				// energy features
-				descriptor[binCount + binHalfCount] = 0.2357 * t1;
-				descriptor[binCount + binHalfCount + 1] = 0.2357 * t2;
-				descriptor[binCount + binHalfCount + 2] = 0.2357 * t3;
-				descriptor[binCount + binHalfCount + 3] = 0.2357 * t4;
 			}
-		}
-	} else { // only signed or unsigned gradients should be in descriptor
-		for (size_t rowIndex = 0; rowIndex < cellRowCount; ++rowIndex) {
-			for (size_t colIndex = 0; colIndex < cellColumnCount; ++colIndex) {
-				float* descriptor = descriptors.ptr<float>(rowIndex, colIndex);
-				int r1 = rowIndex;
-				int r0 = std::max(0, static_cast<int>(rowIndex) - 1);
-				int r2 = std::min(rowIndex + 1, cellRowCount - 1);
-				int c1 = colIndex;
-				int c0 = std::max(0, static_cast<int>(colIndex) - 1);
-				int c2 = std::min(colIndex + 1, cellColumnCount - 1);
-				float sqn00 = energies.at<float>(r0, c0);
-				float sqn01 = energies.at<float>(r0, c1);
-				float sqn02 = energies.at<float>(r0, c2);
-				float sqn10 = energies.at<float>(r1, c0);
-				float sqn11 = energies.at<float>(r1, c1);
-				float sqn12 = energies.at<float>(r1, c2);
-				float sqn20 = energies.at<float>(r2, c0);
-				float sqn21 = energies.at<float>(r2, c1);
-				float sqn22 = energies.at<float>(r2, c2);
-				float n1 = 1.f / sqrt(sqn00 + sqn01 + sqn10 + sqn11 + eps);
-				float n2 = 1.f / sqrt(sqn01 + sqn02 + sqn11 + sqn12 + eps);
-				float n3 = 1.f / sqrt(sqn10 + sqn11 + sqn20 + sqn21 + eps);
-				float n4 = 1.f / sqrt(sqn11 + sqn12 + sqn21 + sqn22 + eps);
-
-				float t1 = 0;
-				float t2 = 0;
-				float t3 = 0;
-				float t4 = 0;
 
-				// orientation features
-				for (size_t binIndex = 0; binIndex < binCount; ++binIndex) {
-					float h1 = std::min(alpha, descriptor[binIndex] * n1);
-					float h2 = std::min(alpha, descriptor[binIndex] * n2);
-					float h3 = std::min(alpha, descriptor[binIndex] * n3);
-					float h4 = std::min(alpha, descriptor[binIndex] * n4);
-					descriptor[binIndex] = 0.5 * (h1 + h2 + h3 + h4);
-					t1 += h1;
-					t2 += h2;
-					t3 += h3;
-					t4 += h4;
-				}
-
-				// energy features
-				descriptor[binCount] = 0.2357 * t1;
-				descriptor[binCount + 1] = 0.2357 * t2;
-				descriptor[binCount + 2] = 0.2357 * t3;
-				descriptor[binCount + 3] = 0.2357 * t4;
+			float t1 = 0;
+			float t2 = 0;
+			float t3 = 0;
+			float t4 = 0;
+
+			// signed orientation features (aka contrast-sensitive), or just orientation features
+			for (size_t binIndex = 0; binIndex < binCount; ++binIndex) {
+				float h1 = std::min(alpha, descriptor[binIndex] * n1);
+				float h2 = std::min(alpha, descriptor[binIndex] * n2);
+				float h3 = std::min(alpha, descriptor[binIndex] * n3);
+				float h4 = std::min(alpha, descriptor[binIndex] * n4);
+				descriptor[binIndex] = 0.5 * (h1 + h2 + h3 + h4);
+				t1 += h1;
+				t2 += h2;
+				t3 += h3;
+				t4 += h4;
 			}
+
+			// energy features
+			float* energyValues = descriptor + (signedAndUnsigned ? binCount + binHalfCount : binCount);
+			energyValues[0] = 0.2357 * t1;
+			energyValues[1] = 0.2357 * t2;
+			energyValues[2] = 0.2357 * t3;
+			energyValues[3] = 0.2357 * t4;
 		}
 	}
 }
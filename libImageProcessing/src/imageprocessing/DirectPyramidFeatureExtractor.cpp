@@ -9,6 +9,7 @@
 #include "imageprocessing/ImagePyramid.hpp"
 #include "imageprocessing/ImagePyramidLayer.hpp"
 #include "imageprocessing/Patch.hpp"
+#include "imageprocessing/PatchBatch.hpp"
 #include "imageprocessing/ChainedFilter.hpp"
 #include <stdexcept>
 
@@ -17,6 +18,7 @@ using cv::Size;
 using cv::Rect;
 using cv::Point;
 using std::pair;
+using std::make_pair;
 using std::vector;
 using std::shared_ptr;
 using std::make_shared;
@@ -74,6 +76,90 @@ shared_ptr<Patch> DirectPyramidFeatureExtractor::extract(int x, int y, int width
 
 vector<shared_ptr<Patch>> DirectPyramidFeatureExtractor::extract(int stepX, int stepY, Rect roi,
 		int firstLayer, int lastLayer, int stepLayer) const {
+	vector<shared_ptr<Patch>> patches;
+	for (const pair<shared_ptr<ImagePyramidLayer>, Rect>& layerArea : getLayerAreas(stepX, stepY, roi, firstLayer, lastLayer, stepLayer)) {
+		const ImagePyramidLayer& layer = *layerArea.first;
+		Point roiBegin = layerArea.second.tl();
+		Point roiEnd = layerArea.second.br();
+		int originalWidth = getOriginal(layer, patchWidth);
+		int originalHeight = getOriginal(layer, patchHeight);
+		const Mat& image = layer.getScaledImage();
+		Rect patchBounds(roiBegin.x, roiBegin.y, patchWidth, patchHeight);
+		for (patchBounds.y = roiBegin.y; patchBounds.y + patchBounds.height < roiEnd.y; patchBounds.y += stepY) {
+			for (patchBounds.x = roiBegin.x; patchBounds.x + patchBounds.width < roiEnd.x; patchBounds.x += stepX) {
+				int originalX = getOriginal(layer, patchBounds.x) + originalWidth / 2;
+				int originalY = getOriginal(layer, patchBounds.y) + originalHeight / 2;
+				Mat data = patchFilter->applyTo(Mat(image, patchBounds));
+				patches.push_back(make_shared<Patch>(originalX, originalY, originalWidth, originalHeight, data));
+			}
+		}
+	}
+	return patches;
+}
+
+void DirectPyramidFeatureExtractor::extract(PatchBatch& batch, int stepX, int stepY, Rect roi,
+		int firstLayer, int lastLayer, int stepLayer) const {
+	vector<pair<shared_ptr<ImagePyramidLayer>, Rect>> layerAreas = getLayerAreas(stepX, stepY, roi, firstLayer, lastLayer, stepLayer);
+	size_t count = 0;
+	const pair<shared_ptr<ImagePyramidLayer>, Rect>* firstLayerArea = nullptr;
+	for (const pair<shared_ptr<ImagePyramidLayer>, Rect>& layerArea : layerAreas) {
+		size_t layerCount = getPositionCount(layerArea.second.width, patchWidth, stepX) * getPositionCount(layerArea.second.height, patchHeight, stepY);
+		if (layerCount > 0 && !firstLayerArea)
+			firstLayerArea = &layerArea;
+		count += layerCount;
+	}
+	if (count == 0) {
+		batch.clear();
+		return;
+	}
+	// all patches have the same size, so the size and type of the first filtered patch determine the arena
+	const Mat& firstImage = firstLayerArea->first->getScaledImage();
+	Mat firstData = patchFilter->applyTo(Mat(firstImage, Rect(firstLayerArea->second.tl(), Size(patchWidth, patchHeight))));
+	batch.allocate(count, firstData.rows, firstData.cols, firstData.type());
+	firstData.copyTo(batch[0].getData());
+	size_t index = 0;
+	for (const pair<shared_ptr<ImagePyramidLayer>, Rect>& layerArea : layerAreas) {
+		const ImagePyramidLayer& layer = *layerArea.first;
+		Point roiBegin = layerArea.second.tl();
+		Point roiEnd = layerArea.second.br();
+		int originalWidth = getOriginal(layer, patchWidth);
+		int originalHeight = getOriginal(layer, patchHeight);
+		const Mat& image = layer.getScaledImage();
+		Rect patchBounds(roiBegin.x, roiBegin.y, patchWidth, patchHeight);
+		for (patchBounds.y = roiBegin.y; patchBounds.y + patchBounds.height < roiEnd.y; patchBounds.y += stepY) {
+			for (patchBounds.x = roiBegin.x; patchBounds.x + patchBounds.width < roiEnd.x; patchBounds.x += stepX, ++index) {
+				Patch& patch = batch[index];
+				patch.setX(getOriginal(layer, patchBounds.x) + originalWidth / 2);
+				patch.setY(getOriginal(layer, patchBounds.y) + originalHeight / 2);
+				patch.setWidth(originalWidth);
+				patch.setHeight(originalHeight);
+				if (index == 0) // the first patch was already filtered for determining the arena
+					continue;
+				// the last filter writes into the slice of the arena, unless it replaces the image instead of writing into it
+				Mat slice = patch.getData();
+				patchFilter->applyTo(Mat(image, patchBounds), patch.getData());
+				if (patch.getData().data != slice.data && patch.getData().size() == slice.size() && patch.getData().type() == slice.type()) {
+					patch.getData().copyTo(slice);
+					patch.setView(slice);
+				}
+			}
+		}
+	}
+}
+
+vector<pair<int, Size>> DirectPyramidFeatureExtractor::getPatchGridSizes(int stepX, int stepY, Rect roi,
+		int firstLayer, int lastLayer, int stepLayer) const {
+	vector<pair<int, Size>> gridSizes;
+	for (const pair<shared_ptr<ImagePyramidLayer>, Rect>& layerArea : getLayerAreas(stepX, stepY, roi, firstLayer, lastLayer, stepLayer)) {
+		int cols = static_cast<int>(getPositionCount(layerArea.second.width, patchWidth, stepX));
+		int rows = static_cast<int>(getPositionCount(layerArea.second.height, patchHeight, stepY));
+		gridSizes.push_back(make_pair(layerArea.first->getIndex(), Size(cols, rows)));
+	}
+	return gridSizes;
+}
+
+vector<pair<shared_ptr<ImagePyramidLayer>, Rect>> DirectPyramidFeatureExtractor::getLayerAreas(int stepX, int stepY, Rect roi,
+		int firstLayer, int lastLayer, int stepLayer) const {
 	if (stepX < 1)
 		throw invalid_argument("DirectPyramidFeatureExtractor: stepX has to be greater than zero");
 	if (stepY < 1)
@@ -90,7 +176,7 @@ vector<shared_ptr<Patch>> DirectPyramidFeatureExtractor::extract(int stepX, int
 		roi.width = std::min(imageSize.width, roi.width + roi.x) - roi.x;
 		roi.height = std::min(imageSize.height, roi.height + roi.y) - roi.y;
 	}
-	vector<shared_ptr<Patch>> patches;
+	vector<pair<shared_ptr<ImagePyramidLayer>, Rect>> layerAreas;
 	const vector<shared_ptr<ImagePyramidLayer>>& layers = pyramid->getLayers();
 	if (firstLayer < 0)
 		firstLayer = layers.front()->getIndex();
@@ -102,24 +188,18 @@ vector<shared_ptr<Patch>> DirectPyramidFeatureExtractor::extract(int stepX, int
 			continue;
 		if (layer->getIndex() > lastLayer)
 			break;
-
-		int originalWidth = getOriginal(*layer, patchWidth);
-		int originalHeight = getOriginal(*layer, patchHeight);
-		const Mat& image = layer->getScaledImage();
-
 		Point roiBegin(getScaled(*layer, roi.x), getScaled(*layer, roi.y));
 		Point roiEnd(getScaled(*layer, roi.x + roi.width), getScaled(*layer, roi.y + roi.height));
-		Rect patchBounds(roiBegin.x, roiBegin.y, patchWidth, patchHeight);
-		for (patchBounds.y = roiBegin.y; patchBounds.y + patchBounds.height < roiEnd.y; patchBounds.y += stepY) {
-			for (patchBounds.x = roiBegin.x; patchBounds.x + patchBounds.width < roiEnd.x; patchBounds.x += stepX) {
-				int originalX = getOriginal(*layer, patchBounds.x) + originalWidth / 2;
-				int originalY = getOriginal(*layer, patchBounds.y) + originalHeight / 2;
-				Mat data = patchFilter->applyTo(Mat(image, patchBounds));
-				patches.push_back(make_shared<Patch>(originalX, originalY, originalWidth, originalHeight, data));
-			}
-		}
+		layerAreas.push_back(make_pair(layer, Rect(roiBegin.x, roiBegin.y, roiEnd.x - roiBegin.x, roiEnd.y - roiBegin.y)));
 	}
-	return patches;
+	return layerAreas;
+}
+
+size_t DirectPyramidFeatureExtractor::getPositionCount(int areaSize, int patchSize, int step) const {
+	// same as the number of iterations of: for (position = 0; position + patchSize < areaSize; position += step)
+	if (areaSize <= patchSize)
+		return 0;
+	return static_cast<size_t>((areaSize - patchSize - 1) / step + 1);
 }
 
 shared_ptr<Patch> DirectPyramidFeatureExtractor::extract(int layerIndex, int x, int y) const {
@@ -197,6 +277,14 @@ vector<Size> DirectPyramidFeatureExtractor::getPatchSizes() const {
 	return sizes;
 }
 
+bool DirectPyramidFeatureExtractor::getChangedRegions(int layer, vector<Rect>& regions) const {
+	return pyramid->getChangedRegions(layer, regions);
+}
+
+void DirectPyramidFeatureExtractor::setRegionOfInterest(Rect roi) {
+	pyramid->setRegionOfInterest(roi);
+}
+
 shared_ptr<ImagePyramid> DirectPyramidFeatureExtractor::getPyramid() {
 	return pyramid;
 }
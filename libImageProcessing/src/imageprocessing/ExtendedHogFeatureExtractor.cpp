@@ -71,6 +71,8 @@ ExtendedHogFeatureExtractor::ExtendedHogFeatureExtractor(shared_ptr<GradientFilt
 	pyramid->addImageFilter(make_shared<GrayscaleFilter>());
 	pyramid->addLayerFilter(gradientFilter);
 	pyramid->addLayerFilter(binningFilter);
+	// the patches extend one cell beyond the region, plus the support of the gradients and a pixel for rounding
+	pyramid->setRegionOfInterestPadding(cellSize + gradientFilter->getSupport() + 1);
 }
 
 ExtendedHogFeatureExtractor::ExtendedHogFeatureExtractor(shared_ptr<CompleteExtendedHogFilter> ehogFilter,
@@ -92,6 +94,10 @@ void ExtendedHogFeatureExtractor::update(shared_ptr<VersionedImage> image) {
 	pyramid->update(image);
 }
 
+void ExtendedHogFeatureExtractor::setRegionOfInterest(Rect roi) {
+	pyramid->setRegionOfInterest(roi);
+}
+
 shared_ptr<Patch> ExtendedHogFeatureExtractor::extract(int x, int y, int width, int height) const {
 	width = static_cast<int>(std::round(widthFactor * width));
 	height = static_cast<int>(std::round(heightFactor * height));
@@ -6,6 +6,7 @@
  */
 
 #include "imageprocessing/ExtendedHogFilter.hpp"
+#include <algorithm>
 #include <stdexcept>
 
 using cv::Mat;
@@ -60,71 +61,86 @@ Mat ExtendedHogFilter::applyTo(const Mat& image, Mat& filtered) const {
 	return filtered;
 }
 
+void ExtendedHogFilter::computeBlockNormalizers(const Mat& energies, Mat& normalizers, float eps) {
+	int rowCount = energies.rows;
+	int columnCount = energies.cols;
+	normalizers.create(rowCount + 1, columnCount + 1, CV_32F);
+	for (int row = 0; row <= rowCount; ++row) {
+		// the energies of the cells outside of the grid are taken from the nearest border cells
+		const float* upperEnergies = energies.ptr<float>(std::max(0, row - 1));
+		const float* lowerEnergies = energies.ptr<float>(std::min(row, rowCount - 1));
+		float* rowNormalizers = normalizers.ptr<float>(row);
+		for (int col = 0; col <= columnCount; ++col) {
+			int leftCol = std::max(0, col - 1);
+			int rightCol = std::min(col, columnCount - 1);
+			rowNormalizers[col] = 1.f / sqrt(upperEnergies[leftCol] + upperEnergies[rightCol]
+					+ lowerEnergies[leftCol] + lowerEnergies[rightCol] + eps);
+		}
+	}
+}
+
 void ExtendedHogFilter::createDescriptors(const Mat& histograms, Mat& descriptors,
-		int binCount, bool signedAndUnsigned, int cellRowCount, int cellColumnCount, float alpha) const {
-	Mat energies = Mat::zeros(cellRowCount, cellColumnCount, CV_32F);
+		int binCount, bool signedAndUnsigned, int cellRowCount, int cellColumnCount, float alpha) {
 	const float* histogramsValues = histograms.ptr<float>();
-	float* energiesValues = energies.ptr<float>();
-
-	// create extended HOG feature vector
-	if (signedAndUnsigned) { // signed and unsigned gradients should be combined into descriptor
+	int binHalfCount = binCount / 2;
 
-		// compute gradient energy over cells
-		int binHalfCount = binCount / 2;
-		for (int cellIndex = 0; cellIndex < cellRowCount * cellColumnCount; ++cellIndex) {
-			const float* histogramValues = histogramsValues + cellIndex * binCount;
+	// compute gradient energy over cells (over unsigned gradients if signed and unsigned gradients should be combined)
+	Mat energies(cellRowCount, cellColumnCount, CV_32F);
+	float* energiesValues = energies.ptr<float>();
+	for (int cellIndex = 0; cellIndex < cellRowCount * cellColumnCount; ++cellIndex) {
+		const float* histogramValues = histogramsValues + cellIndex * binCount;
+		float energy = 0;
+		if (signedAndUnsigned) {
 			for (int binIndex = 0; binIndex < binHalfCount; ++binIndex) {
 				float sum = histogramValues[binIndex] + histogramValues[binIndex + binHalfCount];
-				energiesValues[cellIndex] += sum * sum;
+				energy += sum * sum;
 			}
+		} else {
+			for (int binIndex = 0; binIndex < binCount; ++binIndex)
+				energy += histogramValues[binIndex] * histogramValues[binIndex];
 		}
+		energiesValues[cellIndex] = energy;
+	}
 
-		// create descriptors
-		descriptors.create(cellRowCount, cellColumnCount, CV_32FC(binCount + binHalfCount + 4));
-		float* values = descriptors.ptr<float>();
-		for (int cellRow = 0; cellRow < cellRowCount; ++cellRow) {
-			for (int cellCol = 0; cellCol < cellColumnCount; ++cellCol) {
-				const float* cellHistogramValues = histogramsValues + cellRow * cellColumnCount * binCount + cellCol * binCount;
-				int r1 = cellRow;
-				int r0 = std::max(0, cellRow - 1);
-				int r2 = std::min(cellRow + 1, cellRowCount - 1);
-				int c1 = cellCol;
-				int c0 = std::max(0, cellCol - 1);
-				int c2 = std::min(cellCol + 1, cellColumnCount - 1);
-				float sqn00 = energies.at<float>(r0, c0);
-				float sqn01 = energies.at<float>(r0, c1);
-				float sqn02 = energies.at<float>(r0, c2);
-				float sqn10 = energies.at<float>(r1, c0);
-				float sqn11 = energies.at<float>(r1, c1);
-				float sqn12 = energies.at<float>(r1, c2);
-				float sqn20 = energies.at<float>(r2, c0);
-				float sqn21 = energies.at<float>(r2, c1);
-				float sqn22 = energies.at<float>(r2, c2);
-				float n1 = 1.f / sqrt(sqn00 + sqn01 + sqn10 + sqn11 + eps);
-				float n2 = 1.f / sqrt(sqn01 + sqn02 + sqn11 + sqn12 + eps);
-				float n3 = 1.f / sqrt(sqn10 + sqn11 + sqn20 + sqn21 + eps);
-				float n4 = 1.f / sqrt(sqn11 + sqn12 + sqn21 + sqn22 + eps);
-
-				float t1 = 0;
-				float t2 = 0;
-				float t3 = 0;
-				float t4 = 0;
-
-				// signed orientation features (aka contrast-sensitive)
-				for (int binIndex = 0; binIndex < binCount; ++binIndex) {
-					float h1 = std::min(alpha, cellHistogramValues[binIndex] * n1);
-					float h2 = std::min(alpha, cellHistogramValues[binIndex] * n2);
-					float h3 = std::min(alpha, cellHistogramValues[binIndex] * n3);
-					float h4 = std::min(alpha, cellHistogramValues[binIndex] * n4);
-					values[binIndex] = 0.5 * (h1 + h2 + h3 + h4);
-					t1 += h1;
-					t2 += h2;
-					t3 += h3;
-					t4 += h4;
-				}
-				values += binCount;
+	// compute the normalizers of each block once instead of four times (once for each cell of the block)
+	Mat normalizers;
+	computeBlockNormalizers(energies, normalizers, eps);
 
-				// unsigned orientation features (aka contrast-insensitive)
+	// create extended HOG feature vector
+	int descriptorSize = signedAndUnsigned ? binCount + binHalfCount + 4 : binCount + 4;
+	descriptors.create(cellRowCount, cellColumnCount, CV_32FC(descriptorSize));
+	for (int cellRow = 0; cellRow < cellRowCount; ++cellRow) {
+		const float* cellHistogramValues = histogramsValues + cellRow * cellColumnCount * binCount;
+		const float* upperNormalizers = normalizers.ptr<float>(cellRow);
+		const float* lowerNormalizers = normalizers.ptr<float>(cellRow + 1);
+		float* values = descriptors.ptr<float>(cellRow);
+		for (int cellCol = 0; cellCol < cellColumnCount; ++cellCol, cellHistogramValues += binCount) {
+			float n1 = upperNormalizers[cellCol];
+			float n2 = upperNormalizers[cellCol + 1];
+			float n3 = lowerNormalizers[cellCol];
+			float n4 = lowerNormalizers[cellCol + 1];
+
+			float t1 = 0;
+			float t2 = 0;
+			float t3 = 0;
+			float t4 = 0;
+
+			// signed orientation features (aka contrast-sensitive), or just orientation features
+			for (int binIndex = 0; binIndex < binCount; ++binIndex) {
+				float h1 = std::min(alpha, cellHistogramValues[binIndex] * n1);
+				float h2 = std::min(alpha, cellHistogramValues[binIndex] * n2);
+				float h3 = std::min(alpha, cellHistogramValues[binIndex] * n3);
+				float h4 = std::min(alpha, cellHistogramValues[binIndex] * n4);
+				values[binIndex] = 0.5 * (h1 + h2 + h3 + h4);
+				t1 += h1;
+				t2 += h2;
+				t3 += h3;
+				t4 += h4;
+			}
+			values += binCount;
+
+			// unsigned orientation features (aka contrast-insensitive)
+			if (signedAndUnsigned) {
 				for (int binIndex = 0; binIndex < binHalfCount; ++binIndex) {
 					float sum = cellHistogramValues[binIndex] + cellHistogramValues[binIndex + binHalfCount];
 					float h1 = std::min(alpha, sum * n1);
@@ -134,76 +150,14 @@ void ExtendedHogFilter::createDescriptors(const Mat& histograms, Mat& descriptor
 					values[binIndex] = 0.5 * (h1 + h2 + h3 + h4);
 				}
 				values += binHalfCount;
-
-				// energy features
-				values[0] = 0.2357 * t1;
-				values[1] = 0.2357 * t2;
-				values[2] = 0.2357 * t3;
-				values[3] = 0.2357 * t4;
-				values += 4;
 			}
-		}
-	} else { // only signed or unsigned gradients should be in descriptor
-
-		// compute gradient energy over cells
-		for (int cellIndex = 0; cellIndex < cellRowCount * cellColumnCount; ++cellIndex) {
-			const float* histogramValues = histogramsValues + cellIndex * binCount;
-			for (int binIndex = 0; binIndex < binCount; ++binIndex)
-				energiesValues[cellIndex] += histogramValues[binIndex] * histogramValues[binIndex];
-		}
-
-		// create descriptors
-		descriptors.create(cellRowCount, cellColumnCount, CV_32FC(binCount + 4));
-		float* values = descriptors.ptr<float>();
-		for (int cellRow = 0; cellRow < cellRowCount; ++cellRow) {
-			for (int cellCol = 0; cellCol < cellColumnCount; ++cellCol) {
-				const float* cellHistogramValues = histogramsValues + cellRow * cellColumnCount * binCount + cellCol * binCount;
-				int r1 = cellRow;
-				int r0 = std::max(cellRow - 1, 0);
-				int r2 = std::min(cellRow + 1, cellRowCount - 1);
-				int c1 = cellCol;
-				int c0 = std::max(cellCol - 1, 0);
-				int c2 = std::min(cellCol + 1, cellColumnCount - 1);
-				float sqn00 = energies.at<float>(r0, c0);
-				float sqn01 = energies.at<float>(r0, c1);
-				float sqn02 = energies.at<float>(r0, c2);
-				float sqn10 = energies.at<float>(r1, c0);
-				float sqn11 = energies.at<float>(r1, c1);
-				float sqn12 = energies.at<float>(r1, c2);
-				float sqn20 = energies.at<float>(r2, c0);
-				float sqn21 = energies.at<float>(r2, c1);
-				float sqn22 = energies.at<float>(r2, c2);
-				float n1 = 1.f / sqrt(sqn00 + sqn01 + sqn10 + sqn11 + eps);
-				float n2 = 1.f / sqrt(sqn01 + sqn02 + sqn11 + sqn12 + eps);
-				float n3 = 1.f / sqrt(sqn10 + sqn11 + sqn20 + sqn21 + eps);
-				float n4 = 1.f / sqrt(sqn11 + sqn12 + sqn21 + sqn22 + eps);
-
-				float t1 = 0;
-				float t2 = 0;
-				float t3 = 0;
-				float t4 = 0;
-
-				// orientation features
-				for (int binIndex = 0; binIndex < binCount; ++binIndex) {
-					float h1 = std::min(alpha, cellHistogramValues[binIndex] * n1);
-					float h2 = std::min(alpha, cellHistogramValues[binIndex] * n2);
-					float h3 = std::min(alpha, cellHistogramValues[binIndex] * n3);
-					float h4 = std::min(alpha, cellHistogramValues[binIndex] * n4);
-					values[binIndex] = 0.5 * (h1 + h2 + h3 + h4);
-					t1 += h1;
-					t2 += h2;
-					t3 += h3;
-					t4 += h4;
-				}
 
-				// energy features
-				values += binCount;
-				values[0] = 0.2357 * t1;
-				values[1] = 0.2357 * t2;
-				values[2] = 0.2357 * t3;
-				values[3] = 0.2357 * t4;
-				values += 4;
-			}
+			// energy features
+			values[0] = 0.2357 * t1;
+			values[1] = 0.2357 * t2;
+			values[2] = 0.2357 * t3;
+			values[3] = 0.2357 * t4;
+			values += 4;
 		}
 	}
 }
@@ -65,7 +65,10 @@ shared_ptr<ImagePyramid> ImagePyramid::createApproximated(
 ImagePyramid::ImagePyramid(size_t octaveLayerCount, double minScaleFactor, double maxScaleFactor) :
 		octaveLayerCount(octaveLayerCount), incrementalScaleFactor(0),
 		minScaleFactor(minScaleFactor), maxScaleFactor(maxScaleFactor),
-		firstLayer(0), layers(), lambdas(), sourceImage(), sourcePyramid(), version(),
+		firstLayer(0), layers(), lambdas(), scaling(Scaling::RESIZE_FIRST), sourceImage(), sourcePyramid(), version(),
+		changeBlockSize(0), changeMargin(0), maxChangedFraction(1), changeThreshold(0),
+		previousImage(), sourceVersion(), changedCompletely(true), changedRegions(),
+		regionOfInterest(), regionOfInterestPadding(-1), regionOfInterestGranularity(1),
 		imageFilter(make_shared<ChainedFilter>()), layerFilter(make_shared<ChainedFilter>()) {
 	if (octaveLayerCount == 0)
 		throw createException<invalid_argument>(__FILE__, __LINE__, "the number of layers per octave must be greater than zero");
@@ -79,7 +82,10 @@ ImagePyramid::ImagePyramid(size_t octaveLayerCount, double minScaleFactor, doubl
 ImagePyramid::ImagePyramid(double incrementalScaleFactor, double minScaleFactor, double maxScaleFactor) :
 		octaveLayerCount(0), incrementalScaleFactor(0),
 		minScaleFactor(minScaleFactor), maxScaleFactor(maxScaleFactor),
-		firstLayer(0), layers(), lambdas(), sourceImage(), sourcePyramid(), version(),
+		firstLayer(0), layers(), lambdas(), scaling(Scaling::RESIZE_FIRST), sourceImage(), sourcePyramid(), version(),
+		changeBlockSize(0), changeMargin(0), maxChangedFraction(1), changeThreshold(0),
+		previousImage(), sourceVersion(), changedCompletely(true), changedRegions(),
+		regionOfInterest(), regionOfInterestPadding(-1), regionOfInterestGranularity(1),
 		imageFilter(make_shared<ChainedFilter>()), layerFilter(make_shared<ChainedFilter>()) {
 	if (incrementalScaleFactor <= 0 || incrementalScaleFactor >= 1)
 		throw createException<invalid_argument>(__FILE__, __LINE__, "the incremental scale factor must be greater than zero and smaller than one");
@@ -94,23 +100,31 @@ ImagePyramid::ImagePyramid(double incrementalScaleFactor, double minScaleFactor,
 ImagePyramid::ImagePyramid(double minScaleFactor, double maxScaleFactor) :
 		octaveLayerCount(0), incrementalScaleFactor(0),
 		minScaleFactor(minScaleFactor), maxScaleFactor(maxScaleFactor),
-		firstLayer(0), layers(), lambdas(), sourceImage(), sourcePyramid(), version(),
+		firstLayer(0), layers(), lambdas(), scaling(Scaling::RESIZE_FIRST), sourceImage(), sourcePyramid(), version(),
+		changeBlockSize(0), changeMargin(0), maxChangedFraction(1), changeThreshold(0),
+		previousImage(), sourceVersion(), changedCompletely(true), changedRegions(),
+		regionOfInterest(), regionOfInterestPadding(-1), regionOfInterestGranularity(1),
 		imageFilter(make_shared<ChainedFilter>()), layerFilter(make_shared<ChainedFilter>()) {}
 
 ImagePyramid::ImagePyramid(shared_ptr<ImagePyramid> pyramid, double minScaleFactor, double maxScaleFactor) :
 		octaveLayerCount(pyramid->octaveLayerCount), incrementalScaleFactor(pyramid->incrementalScaleFactor),
 		minScaleFactor(minScaleFactor), maxScaleFactor(maxScaleFactor),
-		firstLayer(0), layers(), lambdas(), sourceImage(), sourcePyramid(pyramid), version(),
+		firstLayer(0), layers(), lambdas(), scaling(Scaling::RESIZE_FIRST), sourceImage(), sourcePyramid(pyramid), version(),
+		changeBlockSize(0), changeMargin(0), maxChangedFraction(1), changeThreshold(0),
+		previousImage(), sourceVersion(), changedCompletely(true), changedRegions(),
+		regionOfInterest(), regionOfInterestPadding(-1), regionOfInterestGranularity(1),
 		imageFilter(make_shared<ChainedFilter>()), layerFilter(make_shared<ChainedFilter>()) {}
 
 void ImagePyramid::addImageFilter(const shared_ptr<ImageFilter>& filter) {
 	imageFilter->add(filter);
 	if (sourcePyramid)
 		sourcePyramid->addImageFilter(filter);
+	previousImage.release();
 }
 
 void ImagePyramid::addLayerFilter(const shared_ptr<ImageFilter>& filter) {
 	layerFilter->add(filter);
+	previousImage.release();
 }
 
 void ImagePyramid::update(const Mat& image) {
@@ -147,12 +161,15 @@ void ImagePyramid::setSource(const shared_ptr<ImagePyramid>& pyramid) {
 
 void ImagePyramid::update() {
 	if (sourceImage) {
-		if (version != sourceImage->getVersion()) {
-			layers.clear();
-			createLayers(sourceImage->getData());
-			if (!layers.empty())
-				firstLayer = layers.front()->getIndex();
-			version = sourceImage->getVersion();
+		if (sourceVersion != sourceImage->getVersion()) {
+			sourceVersion = sourceImage->getVersion();
+			if (detectChanges(sourceImage->getData())) {
+				layers.clear();
+				createLayers(sourceImage->getData());
+				if (!layers.empty())
+					firstLayer = layers.front()->getIndex();
+				version = sourceImage->getVersion();
+			}
 		}
 	} else if (sourcePyramid) {
 		if (version != sourcePyramid->version) {
@@ -162,33 +179,214 @@ void ImagePyramid::update() {
 				firstLayer = layers.front()->getIndex();
 			version = sourcePyramid->version;
 		}
+		// lambdas that are estimated from the channel means change all approximated layers with any change of the image
+		bool estimatesLambdas = lambdas.empty() && octaveLayerCount != sourcePyramid->octaveLayerCount;
+		changedCompletely = sourcePyramid->changedCompletely || (estimatesLambdas && !sourcePyramid->changedRegions.empty());
+		changedRegions = sourcePyramid->changedRegions;
 	} else { // neither source pyramid nor source image are set, therefore the other parameters are missing, too
 		Loggers->getLogger("ImageProcessing").warn("ImagePyramid: could not update because there is no source (image or pyramid)");
 	}
 }
 
+void ImagePyramid::enableChangeDetection(int blockSize, int margin, double maxChangedFraction, double threshold) {
+	if (blockSize <= 0)
+		throw createException<invalid_argument>(__FILE__, __LINE__, "the block size must be greater than zero");
+	if (margin < 0)
+		throw createException<invalid_argument>(__FILE__, __LINE__, "the margin must not be negative");
+	if (sourcePyramid)
+		sourcePyramid->enableChangeDetection(blockSize, margin, maxChangedFraction, threshold);
+	changeBlockSize = blockSize;
+	changeMargin = margin;
+	this->maxChangedFraction = maxChangedFraction;
+	changeThreshold = threshold;
+}
+
+void ImagePyramid::disableChangeDetection() {
+	if (sourcePyramid)
+		sourcePyramid->disableChangeDetection();
+	changeBlockSize = 0;
+	previousImage.release();
+}
+
+bool ImagePyramid::detectChanges(const Mat& image) {
+	changedCompletely = true;
+	changedRegions.clear();
+	if (changeBlockSize <= 0)
+		return true;
+	if (previousImage.empty() || previousImage.size() != image.size() || previousImage.type() != image.type()) {
+		image.copyTo(previousImage);
+		return true;
+	}
+	Mat difference;
+	cv::absdiff(image, previousImage, difference);
+	Mat changedValues = difference.reshape(1) > changeThreshold;
+	int channels = image.channels();
+	int blockCols = (image.cols + changeBlockSize - 1) / changeBlockSize;
+	int blockRows = (image.rows + changeBlockSize - 1) / changeBlockSize;
+	int changedBlockCount = 0;
+	for (int blockRow = 0; blockRow < blockRows; ++blockRow) {
+		int y = blockRow * changeBlockSize;
+		int height = std::min(changeBlockSize, image.rows - y);
+		int firstChangedBlockCol = -1;
+		// horizontally adjacent changed blocks are combined into a single region
+		for (int blockCol = 0; blockCol <= blockCols; ++blockCol) {
+			bool changed = false;
+			if (blockCol < blockCols) {
+				int x = blockCol * changeBlockSize;
+				int width = std::min(changeBlockSize, image.cols - x);
+				changed = cv::countNonZero(changedValues(cv::Rect(x * channels, y, width * channels, height))) > 0;
+			}
+			if (changed) {
+				++changedBlockCount;
+				if (firstChangedBlockCol < 0)
+					firstChangedBlockCol = blockCol;
+			} else if (firstChangedBlockCol >= 0) {
+				int x = firstChangedBlockCol * changeBlockSize;
+				changedRegions.push_back(cv::Rect(x, y, std::min(blockCol * changeBlockSize, image.cols) - x, height));
+				firstChangedBlockCol = -1;
+			}
+		}
+	}
+	if (changedBlockCount == 0) { // the layers stay the same, so the image is not remembered (otherwise small changes could add up)
+		changedCompletely = false;
+		return false;
+	}
+	image.copyTo(previousImage);
+	if (changedBlockCount > maxChangedFraction * blockCols * blockRows) {
+		changedRegions.clear();
+		return true;
+	}
+	changedCompletely = false;
+	return true;
+}
+
+bool ImagePyramid::getChangedRegions(int index, vector<cv::Rect>& regions) const {
+	regions.clear();
+	if (changedCompletely)
+		return false;
+	shared_ptr<ImagePyramidLayer> layer = getLayer(index);
+	if (!layer)
+		return false;
+	Size imageSize = getImageSize();
+	Size layerSize = layer->getSize();
+	// the ratio of the sizes is used instead of the scale factor, because layer filters might change the size (e.g. cells)
+	double scaleX = static_cast<double>(layerSize.width) / static_cast<double>(imageSize.width);
+	double scaleY = static_cast<double>(layerSize.height) / static_cast<double>(imageSize.height);
+	int margin = changeMargin + resamplingMargin;
+	cv::Rect layerBounds(cv::Point(0, 0), layerSize);
+	for (const cv::Rect& region : changedRegions) {
+		cv::Point begin(static_cast<int>(std::floor(region.x * scaleX)) - margin, static_cast<int>(std::floor(region.y * scaleY)) - margin);
+		cv::Point end(static_cast<int>(std::ceil(region.br().x * scaleX)) + margin, static_cast<int>(std::ceil(region.br().y * scaleY)) + margin);
+		cv::Rect layerRegion = cv::Rect(begin, end) & layerBounds;
+		if (layerRegion.area() > 0)
+			regions.push_back(layerRegion);
+	}
+	return true;
+}
+
+void ImagePyramid::setRegionOfInterest(cv::Rect roi) {
+	if (roi.width < 0 || roi.height < 0)
+		throw createException<invalid_argument>(__FILE__, __LINE__, "the region of interest must not have a negative size");
+	if (roi.area() > 0 && !layerFilter->empty() && regionOfInterestPadding < 0)
+		throw createException<invalid_argument>(__FILE__, __LINE__, "the padding of the region of interest must be set before");
+	if (roi.area() > 0 && sourcePyramid && octaveLayerCount != sourcePyramid->octaveLayerCount && lambdas.empty())
+		throw createException<invalid_argument>(__FILE__, __LINE__, "the lambdas must be set before approximating layers with a region of interest");
+	if (sourcePyramid)
+		sourcePyramid->setRegionOfInterest(roi);
+	if (roi == regionOfInterest)
+		return;
+	regionOfInterest = roi;
+	// the layers must be re-created even if the image stays the same
+	version = Version();
+	sourceVersion = Version();
+	previousImage.release();
+}
+
+void ImagePyramid::setRegionOfInterestPadding(int padding, int granularity) {
+	if (padding < 0)
+		throw createException<invalid_argument>(__FILE__, __LINE__, "the padding must not be negative");
+	if (granularity <= 0)
+		throw createException<invalid_argument>(__FILE__, __LINE__, "the granularity must be greater than zero");
+	if (sourcePyramid)
+		sourcePyramid->setRegionOfInterestPadding(padding, granularity);
+	if (padding == regionOfInterestPadding && granularity == regionOfInterestGranularity)
+		return;
+	regionOfInterestPadding = padding;
+	regionOfInterestGranularity = granularity;
+	if (regionOfInterest.area() > 0) { // the layers must be re-created even if the image stays the same
+		version = Version();
+		sourceVersion = Version();
+		previousImage.release();
+	}
+}
+
+Mat ImagePyramid::applyLayerFilter(const Mat& scaledImage) const {
+	// without knowing the padding (layer filters were added after setting the region), the whole layer is filtered
+	if (regionOfInterest.area() == 0 || layerFilter->empty() || regionOfInterestPadding < 0)
+		return layerFilter->applyTo(scaledImage);
+	Size imageSize = getImageSize();
+	double scaleX = static_cast<double>(scaledImage.cols) / static_cast<double>(imageSize.width);
+	double scaleY = static_cast<double>(scaledImage.rows) / static_cast<double>(imageSize.height);
+	int granularity = regionOfInterestGranularity;
+	// the begin is rounded down and the end is rounded up to the granularity, but the end must not exceed the layer
+	int beginX = std::max(0, static_cast<int>(std::floor(regionOfInterest.x * scaleX)) - regionOfInterestPadding);
+	int beginY = std::max(0, static_cast<int>(std::floor(regionOfInterest.y * scaleY)) - regionOfInterestPadding);
+	int endX = static_cast<int>(std::ceil(regionOfInterest.br().x * scaleX)) + regionOfInterestPadding;
+	int endY = static_cast<int>(std::ceil(regionOfInterest.br().y * scaleY)) + regionOfInterestPadding;
+	beginX -= beginX % granularity;
+	beginY -= beginY % granularity;
+	endX = std::min(scaledImage.cols, (endX + granularity - 1) / granularity * granularity);
+	endY = std::min(scaledImage.rows, (endY + granularity - 1) / granularity * granularity);
+	if (endX <= beginX || endY <= beginY // region of interest is outside of the layer
+			|| (beginX == 0 && beginY == 0 && endX == scaledImage.cols && endY == scaledImage.rows))
+		return layerFilter->applyTo(scaledImage);
+	Mat filteredRegion = layerFilter->applyTo(scaledImage(cv::Rect(beginX, beginY, endX - beginX, endY - beginY)));
+	// the layer filter might change the size (e.g. cells), so the filtered layer is scaled accordingly
+	double filterScaleX = static_cast<double>(filteredRegion.cols) / static_cast<double>(endX - beginX);
+	double filterScaleY = static_cast<double>(filteredRegion.rows) / static_cast<double>(endY - beginY);
+	Size filteredSize(cvRound(scaledImage.cols * filterScaleX), cvRound(scaledImage.rows * filterScaleY));
+	cv::Rect target = cv::Rect(cvRound(beginX * filterScaleX), cvRound(beginY * filterScaleY),
+			filteredRegion.cols, filteredRegion.rows) & cv::Rect(cv::Point(0, 0), filteredSize);
+	Mat filteredImage = Mat::zeros(filteredSize, filteredRegion.type());
+	filteredRegion(cv::Rect(0, 0, target.width, target.height)).copyTo(filteredImage(target));
+	return filteredImage;
+}
+
 void ImagePyramid::createLayers(const Mat& image) {
 	Mat filteredImage = imageFilter->applyTo(image);
-	// TODO wenn maxscale <= 0.5 -> erstmal pyrdown auf bild (etc pp)
+	// octaves whose layers are all bigger than the maximum scale factor are skipped by halving the image first,
+	// so the layers of the first needed octave are resized from a smaller image
+	size_t firstOctave = 0;
+	Mat octaveImage = filteredImage;
+	if (scaling != Scaling::RESIZE_FIRST) {
+		double smallestLayerScaleFactor = pow(incrementalScaleFactor, octaveLayerCount - 1);
+		while (smallestLayerScaleFactor * pow(0.5, firstOctave) > maxScaleFactor && octaveImage.cols > 1 && octaveImage.rows > 1) {
+			Mat halvedImage;
+			halve(octaveImage, halvedImage);
+			octaveImage = halvedImage;
+			++firstOctave;
+		}
+	}
 	for (size_t i = 0; i < octaveLayerCount; ++i) {
-		double scaleFactor = pow(incrementalScaleFactor, i);
+		double octaveLayerScaleFactor = pow(incrementalScaleFactor, i);
+		double scaleFactor = octaveLayerScaleFactor * pow(0.5, firstOctave);
 		Mat scaledImage;
-		Size scaledImageSize(cvRound(filteredImage.cols * scaleFactor), cvRound(filteredImage.rows * scaleFactor));
-		cv::resize(filteredImage, scaledImage, scaledImageSize, 0, 0, cv::INTER_LINEAR);
+		Size scaledImageSize(cvRound(octaveImage.cols * octaveLayerScaleFactor), cvRound(octaveImage.rows * octaveLayerScaleFactor));
+		cv::resize(octaveImage, scaledImage, scaledImageSize, 0, 0, cv::INTER_LINEAR);
 		double widthScaleFactor = static_cast<double>(scaledImage.cols) / static_cast<double>(filteredImage.cols);
 		double heightScaleFactor = static_cast<double>(scaledImage.rows) / static_cast<double>(filteredImage.rows);
 		if (scaleFactor <= maxScaleFactor && scaleFactor >= minScaleFactor)
-			layers.push_back(make_shared<ImagePyramidLayer>(i, scaleFactor,
-					widthScaleFactor, heightScaleFactor, layerFilter->applyTo(scaledImage)));
+			layers.push_back(make_shared<ImagePyramidLayer>(i + firstOctave * octaveLayerCount, scaleFactor,
+					widthScaleFactor, heightScaleFactor, applyLayerFilter(scaledImage)));
 		Mat previousScaledImage = scaledImage;
 		scaleFactor *= 0.5;
-		for (size_t j = 1; scaleFactor >= minScaleFactor && previousScaledImage.cols > 1; ++j, scaleFactor *= 0.5) {
-			pyrDown(previousScaledImage, scaledImage);
+		for (size_t j = firstOctave + 1; scaleFactor >= minScaleFactor && previousScaledImage.cols > 1; ++j, scaleFactor *= 0.5) {
+			halve(previousScaledImage, scaledImage);
 			double widthScaleFactor = static_cast<double>(scaledImage.cols) / static_cast<double>(filteredImage.cols);
 			double heightScaleFactor = static_cast<double>(scaledImage.rows) / static_cast<double>(filteredImage.rows);
 			if (scaleFactor <= maxScaleFactor)
 				layers.push_back(make_shared<ImagePyramidLayer>(i + j * octaveLayerCount, scaleFactor,
-						widthScaleFactor, heightScaleFactor, layerFilter->applyTo(scaledImage)));
+						widthScaleFactor, heightScaleFactor, applyLayerFilter(scaledImage)));
 			previousScaledImage = scaledImage;
 		}
 	}
@@ -197,6 +395,14 @@ void ImagePyramid::createLayers(const Mat& image) {
 	});
 }
 
+void ImagePyramid::halve(const Mat& image, Mat& halvedImage) const {
+	Size halvedSize((image.cols + 1) / 2, (image.rows + 1) / 2);
+	if (scaling == Scaling::AREA)
+		cv::resize(image, halvedImage, halvedSize, 0, 0, cv::INTER_AREA);
+	else
+		cv::pyrDown(image, halvedImage, halvedSize);
+}
+
 void ImagePyramid::createLayers(const ImagePyramid& pyramid) {
 	if (octaveLayerCount % pyramid.octaveLayerCount != 0)
 		throw createException<runtime_error>(__FILE__, __LINE__,
@@ -204,13 +410,17 @@ void ImagePyramid::createLayers(const ImagePyramid& pyramid) {
 	vector<shared_ptr<ImagePyramidLayer>> filteredLayers;
 	filteredLayers.reserve(pyramid.layers.size());
 	for (const shared_ptr<ImagePyramidLayer>& layer : pyramid.layers)
-		filteredLayers.push_back(layer->createFiltered(*layerFilter));
+		filteredLayers.push_back(make_shared<ImagePyramidLayer>(*layer, applyLayerFilter(layer->getScaledImage())));
 	int layersPerOriginalLayer = octaveLayerCount / pyramid.octaveLayerCount;
 	vector<double> lambdas = this->lambdas;
-	if (lambdas.size() == 0)
+	if (lambdas.empty() && layersPerOriginalLayer > 1) {
+		// layers that are zero outside of the region of interest would let the lambdas depend on that region
+		if (regionOfInterest.area() > 0)
+			throw createException<runtime_error>(__FILE__, __LINE__, "the lambdas must be set when approximating layers with a region of interest");
 		lambdas = estimateLambdas(filteredLayers);
-	else if (!filteredLayers.empty() && filteredLayers.front()->getScaledImage().channels() != lambdas.size())
+	} else if (!lambdas.empty() && !filteredLayers.empty() && filteredLayers.front()->getScaledImage().channels() != lambdas.size()) {
 		throw createException<runtime_error>(__FILE__, __LINE__, "the number number of lambdas does not match the number of channels");
+	}
 	for (shared_ptr<ImagePyramidLayer>& exactLayer : filteredLayers) {
 		if (exactLayer->getScaleFactor() < minScaleFactor)
 			break;
@@ -0,0 +1,84 @@
+/*
+ * LambdaEstimator.cpp
+ *
+ *  Created on: 18.10.2026
+ *      Author: poschmann
+ */
+
+#include "imageprocessing/LambdaEstimator.hpp"
+#include "opencv2/imgproc/imgproc.hpp"
+#include <cmath>
+#include <stdexcept>
+
+using cv::Mat;
+using cv::Size;
+using std::vector;
+using std::shared_ptr;
+using std::invalid_argument;
+using std::runtime_error;
+
+namespace imageprocessing {
+
+LambdaEstimator::LambdaEstimator(shared_ptr<ImageFilter> layerFilter, shared_ptr<ImageFilter> imageFilter, int scaleCount) :
+		layerFilter(layerFilter), imageFilter(imageFilter), scaleFactors(), ratioSums(), ratioCounts(), imageCount(0) {
+	if (!layerFilter)
+		throw invalid_argument("LambdaEstimator: the layer filter must not be empty");
+	if (scaleCount <= 0)
+		throw invalid_argument("LambdaEstimator: the number of scales must be greater than zero");
+	for (int i = 1; i <= scaleCount; ++i)
+		scaleFactors.push_back(std::pow(0.5, static_cast<double>(i) / scaleCount));
+}
+
+void LambdaEstimator::add(const Mat& image) {
+	Mat filteredImage = imageFilter ? imageFilter->applyTo(image) : image;
+	vector<double> channelMeans = computeChannelMeans(layerFilter->applyTo(filteredImage));
+	if (ratioSums.empty()) {
+		ratioSums.assign(scaleFactors.size(), vector<double>(channelMeans.size(), 0));
+		ratioCounts.assign(scaleFactors.size(), vector<int>(channelMeans.size(), 0));
+	} else if (ratioSums.front().size() != channelMeans.size()) {
+		throw invalid_argument("LambdaEstimator: the number of channels differs from previous images");
+	}
+	for (size_t i = 0; i < scaleFactors.size(); ++i) {
+		Mat scaledImage;
+		Size scaledSize(cvRound(filteredImage.cols * scaleFactors[i]), cvRound(filteredImage.rows * scaleFactors[i]));
+		cv::resize(filteredImage, scaledImage, scaledSize, 0, 0, cv::INTER_LINEAR);
+		vector<double> scaledChannelMeans = computeChannelMeans(layerFilter->applyTo(scaledImage));
+		for (size_t ch = 0; ch < channelMeans.size(); ++ch) {
+			if (channelMeans[ch] > 0 && scaledChannelMeans[ch] > 0) { // ratios of empty channels are meaningless
+				ratioSums[i][ch] += scaledChannelMeans[ch] / channelMeans[ch];
+				++ratioCounts[i][ch];
+			}
+		}
+	}
+	++imageCount;
+}
+
+vector<double> LambdaEstimator::getLambdas() const {
+	if (imageCount == 0)
+		throw runtime_error("LambdaEstimator: at least one image is needed to estimate the lambdas");
+	// the channel mean ratio at scale s is modeled as s^-lambda, so log(ratio) = -lambda * log(s)
+	vector<double> lambdas(ratioSums.front().size());
+	for (size_t ch = 0; ch < lambdas.size(); ++ch) {
+		double numerator = 0;
+		double denominator = 0;
+		for (size_t i = 0; i < scaleFactors.size(); ++i) {
+			if (ratioCounts[i][ch] > 0) {
+				double logRatio = std::log(ratioSums[i][ch] / ratioCounts[i][ch]);
+				double logScaleFactor = std::log(scaleFactors[i]);
+				numerator += logRatio * logScaleFactor;
+				denominator += logScaleFactor * logScaleFactor;
+			}
+		}
+		lambdas[ch] = denominator > 0 ? -numerator / denominator : 0;
+	}
+	return lambdas;
+}
+
+vector<double> LambdaEstimator::computeChannelMeans(const Mat& image) const {
+	Mat values = (image.isContinuous() ? image : image.clone()).reshape(1, static_cast<int>(image.total()));
+	Mat means;
+	cv::reduce(values, means, 0, CV_REDUCE_AVG, CV_64F);
+	return vector<double>(means.begin<double>(), means.end<double>());
+}
+
+} /* namespace imageprocessing */
@@ -0,0 +1,76 @@
+/*
+ * LambdaStore.cpp
+ *
+ *  Created on: 18.10.2026
+ *      Author: poschmann
+ */
+
+#include "imageprocessing/LambdaStore.hpp"
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+
+using std::string;
+using std::vector;
+using std::invalid_argument;
+using std::runtime_error;
+
+namespace imageprocessing {
+
+LambdaStore::LambdaStore() : lambdas() {}
+
+LambdaStore::LambdaStore(const string& filename) : lambdas() {
+	load(filename);
+}
+
+bool LambdaStore::contains(const string& key) const {
+	return lambdas.find(key) != lambdas.end();
+}
+
+vector<double> LambdaStore::get(const string& key) const {
+	auto iterator = lambdas.find(key);
+	if (iterator == lambdas.end())
+		return vector<double>();
+	return iterator->second;
+}
+
+void LambdaStore::set(const string& key, const vector<double>& lambdas) {
+	if (key.empty() || std::any_of(key.begin(), key.end(), [](char c) { return std::isspace(static_cast<unsigned char>(c)); }))
+		throw invalid_argument("LambdaStore: the key must not be empty or contain whitespace");
+	this->lambdas[key] = lambdas;
+}
+
+void LambdaStore::load(const string& filename) {
+	std::ifstream file(filename);
+	if (!file)
+		throw runtime_error("LambdaStore: cannot read from file " + filename);
+	string key;
+	size_t count;
+	while (file >> key >> count) {
+		vector<double> keyLambdas(count);
+		for (double& lambda : keyLambdas)
+			file >> lambda;
+		if (!file)
+			throw runtime_error("LambdaStore: invalid lambdas of key " + key + " in file " + filename);
+		lambdas[key] = keyLambdas;
+	}
+	if (!file.eof())
+		throw runtime_error("LambdaStore: invalid line in file " + filename);
+}
+
+void LambdaStore::store(const string& filename) const {
+	std::ofstream file(filename);
+	if (!file)
+		throw runtime_error("LambdaStore: cannot write into file " + filename);
+	file.precision(std::numeric_limits<double>::digits10 + 1);
+	for (const auto& keyLambdas : lambdas) {
+		file << keyLambdas.first << ' ' << keyLambdas.second.size();
+		for (double lambda : keyLambdas.second)
+			file << ' ' << lambda;
+		file << '\n';
+	}
+}
+
+} /* namespace imageprocessing */
@@ -6,13 +6,54 @@
  */
 
 #include "imageprocessing/ParallelFilter.hpp"
+#include <algorithm>
+#include <stdexcept>
 
 using cv::Mat;
 using std::vector;
 using std::shared_ptr;
+using std::invalid_argument;
 
 namespace imageprocessing {
 
+class ParallelFilter::FilterApplication : public cv::ParallelLoopBody {
+public:
+
+	FilterApplication(const vector<shared_ptr<ImageFilter>>& filters, const Mat& image, vector<Mat>& results) :
+			filters(filters), image(image), results(results) {}
+
+	void operator()(const cv::Range& range) const override {
+		for (int i = range.start; i < range.end; ++i)
+			filters[i]->applyTo(image, results[i]);
+	}
+
+private:
+
+	const vector<shared_ptr<ImageFilter>>& filters;
+	const Mat& image;
+	vector<Mat>& results;
+};
+
+class ParallelFilter::ChannelMerger : public cv::ParallelLoopBody {
+public:
+
+	ChannelMerger(const vector<Mat>& images, Mat& merged) : images(images), merged(merged) {}
+
+	void operator()(const cv::Range& range) const override {
+		vector<Mat> imageRows;
+		imageRows.reserve(images.size());
+		for (const Mat& image : images)
+			imageRows.push_back(image.rowRange(range.start, range.end));
+		Mat mergedRows = merged.rowRange(range.start, range.end); // same size and type, so merge writes into the rows
+		cv::merge(imageRows, mergedRows);
+	}
+
+private:
+
+	const vector<Mat>& images;
+	Mat& merged;
+};
+
 ParallelFilter::ParallelFilter() : filters() {}
 
 ParallelFilter::ParallelFilter(vector<shared_ptr<ImageFilter>> filters) : filters(filters) {}
@@ -35,10 +76,41 @@ void ParallelFilter::add(shared_ptr<ImageFilter> filter) {
 
 Mat ParallelFilter::applyTo(const Mat& image, Mat& filtered) const {
 	vector<Mat> results(filters.size());
-	for (unsigned int i = 0; i < filters.size(); ++i)
-		filters[i]->applyTo(image, results[i]);
-	cv::merge(results, filtered);
+	if (filters.size() > 1 && hasDistinctFilters()) {
+		cv::parallel_for_(cv::Range(0, static_cast<int>(filters.size())), FilterApplication(filters, image, results));
+	} else {
+		for (unsigned int i = 0; i < filters.size(); ++i)
+			filters[i]->applyTo(image, results[i]);
+	}
+	merge(results, filtered);
 	return filtered;
 }
 
+void ParallelFilter::collectInstances(vector<const ImageFilter*>& instances) const {
+	instances.push_back(this);
+	for (const shared_ptr<ImageFilter>& filter : filters)
+		filter->collectInstances(instances);
+}
+
+bool ParallelFilter::hasDistinctFilters() const {
+	vector<const ImageFilter*> instances;
+	for (const shared_ptr<ImageFilter>& filter : filters)
+		filter->collectInstances(instances);
+	std::sort(instances.begin(), instances.end());
+	return std::adjacent_find(instances.begin(), instances.end()) == instances.end();
+}
+
+void ParallelFilter::merge(const vector<Mat>& images, Mat& merged) {
+	if (images.empty())
+		throw invalid_argument("ParallelFilter: there must be at least one image to merge");
+	int channels = 0;
+	for (const Mat& image : images) {
+		if (image.size() != images[0].size() || image.depth() != images[0].depth())
+			throw invalid_argument("ParallelFilter: the images to merge must have the same size and depth");
+		channels += image.channels();
+	}
+	merged.create(images[0].rows, images[0].cols, CV_MAKETYPE(images[0].depth(), channels));
+	cv::parallel_for_(cv::Range(0, merged.rows), ChannelMerger(images, merged));
+}
+
 } /* namespace imageprocessing */
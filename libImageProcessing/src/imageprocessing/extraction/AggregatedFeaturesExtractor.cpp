@@ -29,6 +29,8 @@ AggregatedFeaturesExtractor::AggregatedFeaturesExtractor(shared_ptr<ImagePyramid
 				adjustMinScaleFactor(adjustMinScaleFactor) {
 	if (minPatchWidthInPixels > patchSizeInPixels.width)
 		featurePyramid->setMaxScaleFactor(getMaxScaleFactor(minPatchWidthInPixels));
+	// wrong gradients at the border of the region spread over two cells and into the normalization of a third one
+	featurePyramid->setRegionOfInterestPadding(3 * cellSizeInPixels, cellSizeInPixels);
 }
 
 AggregatedFeaturesExtractor::AggregatedFeaturesExtractor(shared_ptr<ImageFilter> layerFilter,
@@ -61,6 +63,10 @@ void AggregatedFeaturesExtractor::update(shared_ptr<VersionedImage> image) {
 	featurePyramid->update(image);
 }
 
+void AggregatedFeaturesExtractor::setRegionOfInterest(Rect roi) {
+	featurePyramid->setRegionOfInterest(roi);
+}
+
 double AggregatedFeaturesExtractor::getMinScaleFactor(const Mat& image) const {
 	double minScaleFactor = static_cast<double>(patchSizeInPixels.width) / getMaxWidth(image);
 	int maxLayerIndex = static_cast<int>(std::log(minScaleFactor) / std::log(featurePyramid->getIncrementalScaleFactor()));
@@ -43,17 +43,21 @@ void FhogAggregationFilter::computeDescriptors(Mat& descriptors, const Mat& hist
 }
 
 Mat FhogAggregationFilter::computeGradientEnergies(const Mat& histograms, int signedBinCount) const {
-	int unsignedBinCount = signedBinCount / 2;
 	Mat energies(histograms.rows, histograms.cols, CV_32FC1);
-	for (int row = 0; row < histograms.rows; ++row) {
-		for (int col = 0; col < histograms.cols; ++col) {
-			const float* signedHistogram = histograms.ptr<float>(row, col);
-			energies.at<float>(row, col) = computeGradientEnergy(signedHistogram, unsignedBinCount);
-		}
-	}
+	for (int row = 0; row < histograms.rows; ++row)
+		computeGradientEnergyRow(energies, histograms, row, signedBinCount);
 	return energies;
 }
 
+void FhogAggregationFilter::computeGradientEnergyRow(Mat& energies, const Mat& histograms, int row, int signedBinCount) const {
+	int unsignedBinCount = signedBinCount / 2;
+	int channels = histograms.channels();
+	const float* signedHistogram = histograms.ptr<float>(row);
+	float* energy = energies.ptr<float>(row);
+	for (int col = 0; col < histograms.cols; ++col, signedHistogram += channels)
+		energy[col] = computeGradientEnergy(signedHistogram, unsignedBinCount);
+}
+
 float FhogAggregationFilter::computeGradientEnergy(const float* signedHistogram, int unsignedBinCount) const {
 	float energy = 0;
 	for (int bin = 0; bin < unsignedBinCount; ++bin) {
@@ -68,29 +72,38 @@ void FhogAggregationFilter::computeDescriptors(Mat& descriptors, const Mat& hist
 	int unsignedBinCount = signedBinCount / 2;
 	int descriptorSize = signedBinCount + unsignedBinCount + 4;
 	descriptors.create(histograms.rows, histograms.cols, CV_32FC(descriptorSize));
-	for (int row = 0; row < histograms.rows; ++row) {
-		for (int col = 0; col < histograms.cols; ++col) {
-			array<float, 4> normalizers = computeNormalizers(energies, row, col);
-			computeDescriptor(descriptors.ptr<float>(row, col),
-					histograms.ptr<float>(row, col), normalizers, signedBinCount, unsignedBinCount);
-		}
+	for (int row = 0; row < histograms.rows; ++row)
+		computeDescriptorRow(descriptors, histograms, energies, row, signedBinCount);
+}
+
+void FhogAggregationFilter::computeDescriptorRow(Mat& descriptors, const Mat& histograms, const Mat& energies, int row, int signedBinCount) const {
+	int unsignedBinCount = signedBinCount / 2;
+	int descriptorSize = descriptors.channels();
+	int histogramSize = histograms.channels();
+	const float* prevEnergies = energies.ptr<float>(std::max(row - 1, 0));
+	const float* currEnergies = energies.ptr<float>(row);
+	const float* nextEnergies = energies.ptr<float>(std::min(row + 1, energies.rows - 1));
+	float* descriptor = descriptors.ptr<float>(row);
+	const float* signedHistogram = histograms.ptr<float>(row);
+	for (int col = 0; col < histograms.cols; ++col, descriptor += descriptorSize, signedHistogram += histogramSize) {
+		array<float, 4> normalizers = computeNormalizers(prevEnergies, currEnergies, nextEnergies, col, energies.cols);
+		computeDescriptor(descriptor, signedHistogram, normalizers, signedBinCount, unsignedBinCount);
 	}
 }
 
-array<float, 4> FhogAggregationFilter::computeNormalizers(const Mat& energies, int currRow, int currCol) const {
-	int prevRow = std::max(currRow - 1, 0);
-	int nextRow = std::min(currRow + 1, energies.rows - 1);
+array<float, 4> FhogAggregationFilter::computeNormalizers(const float* prevEnergies, const float* currEnergies,
+		const float* nextEnergies, int currCol, int cols) const {
 	int prevCol = std::max(currCol - 1, 0);
-	int nextCol = std::min(currCol + 1, energies.cols - 1);
-	float ulEnergySq = energies.at<float>(prevRow, prevCol); // up left
-	float ucEnergySq = energies.at<float>(prevRow, currCol); // up center
-	float urEnergySq = energies.at<float>(prevRow, nextCol); // up right
-	float clEnergySq = energies.at<float>(currRow, prevCol); // center left
-	float ccEnergySq = energies.at<float>(currRow, currCol); // center center
-	float crEnergySq = energies.at<float>(currRow, nextCol); // center right
-	float dlEnergySq = energies.at<float>(nextRow, prevCol); // down left
-	float dcEnergySq = energies.at<float>(nextRow, currCol); // down center
-	float drEnergySq = energies.at<float>(nextRow, nextCol); // down right
+	int nextCol = std::min(currCol + 1, cols - 1);
+	float ulEnergySq = prevEnergies[prevCol]; // up left
+	float ucEnergySq = prevEnergies[currCol]; // up center
+	float urEnergySq = prevEnergies[nextCol]; // up right
+	float clEnergySq = currEnergies[prevCol]; // center left
+	float ccEnergySq = currEnergies[currCol]; // center center
+	float crEnergySq = currEnergies[nextCol]; // center right
+	float dlEnergySq = nextEnergies[prevCol]; // down left
+	float dcEnergySq = nextEnergies[currCol]; // down center
+	float drEnergySq = nextEnergies[nextCol]; // down right
 	return {
 			1.f / std::sqrt(ulEnergySq + ucEnergySq + clEnergySq + ccEnergySq + eps),
 			1.f / std::sqrt(ucEnergySq + urEnergySq + ccEnergySq + crEnergySq + eps),
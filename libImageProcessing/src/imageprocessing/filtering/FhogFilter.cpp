@@ -63,10 +63,9 @@ Mat FhogFilter::applyTo(const Mat& image, Mat& descriptors) const {
 	int descriptorSize = signedBinCount + unsignedBinCount + 4;
 	descriptors = Mat::zeros(rows, cols, CV_32FC(descriptorSize));
 	if (image.channels() == 1)
-		computeSignedHistograms<true>(image, descriptors);
+		computeDescriptors<true>(image, descriptors);
 	else
-		computeSignedHistograms<false>(image, descriptors);
-	fhogAggregationFilter.computeDescriptors(descriptors, descriptors, signedBinCount);
+		computeDescriptors<false>(image, descriptors);
 	return descriptors;
 }
 
@@ -96,6 +95,16 @@ vector<FhogFilter::Coefficients> FhogFilter::computeInterpolationCoefficents(int
 	return coefficients;
 }
 
+vector<int> FhogFilter::computeLastContributingRows(const vector<Coefficients>& rowCoefficients, int rows) const {
+	vector<int> lastContributingRows(rows, -1);
+	for (int imageRow = 0; imageRow < rowCoefficients.size(); ++imageRow) {
+		lastContributingRows[rowCoefficients[imageRow].index1] = imageRow;
+		if (interpolateCells)
+			lastContributingRows[rowCoefficients[imageRow].index2] = imageRow;
+	}
+	return lastContributingRows;
+}
+
 float FhogFilter::computeOrientation(float gradientX, float gradientY) const {
 	return orientationFilter.computeOrientation(gradientX, gradientY);
 }
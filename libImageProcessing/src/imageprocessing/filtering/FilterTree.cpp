@@ -6,6 +6,8 @@
  */
 
 #include "imageprocessing/filtering/FilterTree.hpp"
+#include "imageprocessing/ParallelFilter.hpp"
+#include <algorithm>
 #include <stdexcept>
 
 using cv::Mat;
@@ -17,18 +19,76 @@ using std::vector;
 namespace imageprocessing {
 namespace filtering {
 
+namespace {
+
+/**
+ * Applies a range of filter nodes to an image, used with cv::parallel_for_.
+ */
+class NodeApplication : public cv::ParallelLoopBody {
+public:
+
+	NodeApplication(const vector<FilterNode>& nodes, const Mat& image, vector<vector<Mat>>& results) :
+			nodes(nodes), image(image), results(results) {}
+
+	void operator()(const cv::Range& range) const override {
+		for (int i = range.start; i < range.end; ++i)
+			results[i] = nodes[i].applyTo(image, true);
+	}
+
+private:
+
+	const vector<FilterNode>& nodes;
+	const Mat& image;
+	vector<vector<Mat>>& results;
+};
+
+/**
+ * Applies filter nodes to an image and appends their results to a list.
+ *
+ * @param[in] nodes Nodes that should be applied.
+ * @param[in] image Image the nodes are applied to.
+ * @param[in] concurrent Flag that indicates whether the nodes may be applied concurrently.
+ * @param[in,out] results List of filter results the results of the nodes are appended to.
+ */
+void applyNodes(const vector<FilterNode>& nodes, const Mat& image, bool concurrent, vector<Mat>& results) {
+	if (concurrent && nodes.size() > 1) {
+		vector<vector<Mat>> nodeResults(nodes.size());
+		cv::parallel_for_(cv::Range(0, static_cast<int>(nodes.size())), NodeApplication(nodes, image, nodeResults));
+		for (const vector<Mat>& singleNodeResults : nodeResults)
+			results.insert(results.end(), singleNodeResults.begin(), singleNodeResults.end());
+	} else {
+		for (const FilterNode& node : nodes) {
+			vector<Mat> nodeResults = node.applyTo(image, concurrent);
+			results.insert(results.end(), nodeResults.begin(), nodeResults.end());
+		}
+	}
+}
+
+} /* namespace */
+
 Mat FilterTree::applyTo(const Mat& image, Mat& result) const {
 	vector<Mat> results;
-	for (const FilterNode& node : nodes) {
-		vector<Mat> nodeResults = node.applyTo(image);
-		results.insert(results.end(), nodeResults.begin(), nodeResults.end());
-	}
+	applyNodes(nodes, image, hasDistinctFilters(), results);
 	if (results.empty())
 		return Mat();
-	cv::merge(results, result);
+	ParallelFilter::merge(results, result);
 	return result;
 }
 
+void FilterTree::collectInstances(vector<const ImageFilter*>& instances) const {
+	instances.push_back(this);
+	for (const FilterNode& node : nodes)
+		node.collectFilters(instances);
+}
+
+bool FilterTree::hasDistinctFilters() const {
+	vector<const ImageFilter*> filters;
+	for (const FilterNode& node : nodes)
+		node.collectFilters(filters);
+	std::sort(filters.begin(), filters.end());
+	return std::adjacent_find(filters.begin(), filters.end()) == filters.end();
+}
+
 void FilterTree::addChain(const vector<shared_ptr<ImageFilter>>& filters) {
 	if (filters.empty())
 		throw invalid_argument("FilterTree: filter chain must not be empty");
@@ -49,18 +109,21 @@ namespace detail {
 FilterNode::FilterNode(const shared_ptr<ImageFilter>& filter) :
 		returnFilteredImage(false), filter(filter), nodes() {}
 
-vector<Mat> FilterNode::applyTo(const Mat& image) const {
+vector<Mat> FilterNode::applyTo(const Mat& image, bool concurrent) const {
 	vector<Mat> results;
 	Mat filteredImage = filter->applyTo(image);
 	if (returnFilteredImage)
 		results.push_back(filteredImage);
-	for (const FilterNode& node : nodes) {
-		vector<Mat> nodeResults = node.applyTo(filteredImage);
-		results.insert(results.end(), nodeResults.begin(), nodeResults.end());
-	}
+	applyNodes(nodes, filteredImage, concurrent, results);
 	return results;
 }
 
+void FilterNode::collectFilters(vector<const ImageFilter*>& filters) const {
+	filter->collectInstances(filters);
+	for (const FilterNode& node : nodes)
+		node.collectFilters(filters);
+}
+
 void FilterNode::addChain(
 		vector<shared_ptr<ImageFilter>>::const_iterator begin,
 		vector<shared_ptr<ImageFilter>>::const_iterator end) {
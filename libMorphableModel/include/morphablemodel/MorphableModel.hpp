@@ -13,6 +13,7 @@
 #include "morphablemodel/PcaModel.hpp"
 
 #include "render/Mesh.hpp"
+#include "render/SoaMesh.hpp"
 
 #ifdef WIN32
 	#define BOOST_ALL_DYN_LINK	// Link against the dynamic boost lib. Seems to be necessary because we use /MD, i.e. link to the dynamic CRT.
@@ -62,7 +63,44 @@ public:
 
 	static MorphableModel loadStatismoModel(boost::filesystem::path h5file);
 
+	/**
+	 * Loads a model from a binary file written with saveBinaryModel(...).
+	 * The file is memory-mapped and the mean, PCA bases and
+	 * eigenvalues of the shape- and color model point directly into
+	 * the mapping, without parsing or copying. Processes that load
+	 * the same file share its memory through the page cache. The
+	 * mapping is copy-on-write, i.e. a matrix of the model that is
+	 * modified gets private copies of the modified pages. The file
+	 * must not be modified while it is loaded.
+	 *
+	 * Matrices returned by the model that are not cloned (e.g. the
+	 * mean) are only valid as long as the model or a copy of it exists.
+	 *
+	 * @param[in] binaryFile A binary model file.
+	 * @return A morphable model that uses the memory of the mapped file.
+	 * @throws runtime_error exception if the file is not a valid binary model file.
+	 */
+	static MorphableModel loadBinaryModel(boost::filesystem::path binaryFile);
+
 	static std::vector<cv::Vec2f> loadIsomap(boost::filesystem::path isomapFile);
+
+	/**
+	 * Saves the model to a binary file that can be memory-mapped
+	 * with loadBinaryModel(...). It is used to convert .scm and
+	 * statismo models once, to speed up the loading afterwards.
+	 *
+	 * The file starts with a header containing the dimensions of
+	 * the models and the offsets of the arrays in the file, followed
+	 * by the arrays (means, normalized and unnormalized PCA bases,
+	 * eigenvalues, triangle lists and texture coordinates). The arrays
+	 * are stored row-major as 32-bit floats or ints in the byte order
+	 * of the machine, each aligned to 64 bytes.
+	 *
+	 * @param[in] binaryFile The file to write the model to.
+	 * @throws runtime_error exception if the file can't be written.
+	 */
+	void saveBinaryModel(boost::filesystem::path binaryFile) const;
+
 	
 	PcaModel getShapeModel() const;
 	PcaModel getColorModel() const;
@@ -112,11 +150,39 @@ public:
 	 * @param[in] colorCoefficients The PCA coefficients used to generate the shape sample.
 	 * @return A model instance with given coefficients.
 	 */
-	render::Mesh drawSample(std::vector<float> shapeCoefficients, std::vector<float> colorCoefficients);
+	render::Mesh drawSample(std::vector<float> shapeCoefficients, std::vector<float> colorCoefficients) const;
+
+	/**
+	 * Returns the mean of the shape- and color model as a mesh in
+	 * structure-of-arrays layout. The positions and colors share
+	 * their data with the model and must not be modified, the mesh
+	 * keeps their memory alive (also if the model is memory-mapped).
+	 *
+	 * @return The mean of the model.
+	 */
+	render::SoaMesh getMeanSoa() const;
+
+	/**
+	 * Returns a sample from the model with the given shape- and
+	 * color PCA coefficients as a mesh in structure-of-arrays layout.
+	 * The positions and colors wrap the PCA samples without copying
+	 * them, the texture coordinates are copied. If a vector is empty,
+	 * the mean is used (shared with the model, see getMeanSoa()).
+	 *
+	 * @param[in] shapeCoefficients The PCA coefficients used to generate the shape sample.
+	 * @param[in] colorCoefficients The PCA coefficients used to generate the color sample.
+	 * @return A model instance with given coefficients.
+	 */
+	render::SoaMesh drawSampleSoa(std::vector<float> shapeCoefficients, std::vector<float> colorCoefficients) const;
 
 	//void setHasTextureCoordinates(bool hasTextureCoordinates);
 	
 private:
+	/**
+	 * Creates a mesh in structure-of-arrays layout from 3N x 1 shape and color vectors.
+	 */
+	render::SoaMesh createSoaMesh(cv::Mat shape, cv::Mat color) const;
+
 	PcaModel shapeModel; ///< A PCA model of the shape
 	PcaModel colorModel; ///< A PCA model of vertex color information
 
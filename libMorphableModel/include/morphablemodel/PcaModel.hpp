@@ -22,6 +22,7 @@
 #include <vector>
 #include <array>
 #include <map>
+#include <memory>
 #include <random>
 
 namespace morphablemodel {
@@ -93,6 +94,24 @@ public:
 	 */
 	static PcaModel loadStatismoModel(boost::filesystem::path h5file, ModelType modelType);
 
+	/**
+	 * Creates a PCA model from already loaded matrices without
+	 * copying them. The matrices may point to memory that they
+	 * don't own (e.g. a memory-mapped file), in which case the
+	 * owner of the memory has to be given as storage. It is kept
+	 * alive as long as the model or one of its copies exists.
+	 *
+	 * @param[in] mean A 3m x 1 CV_32FC1 col-vector (xyzxyz...)'.
+	 * @param[in] normalizedPcaBasis The normalized PCA basis, a 3m x n CV_32FC1 matrix.
+	 * @param[in] unnormalizedPcaBasis The unnormalized PCA basis, a 3m x n CV_32FC1 matrix.
+	 * @param[in] eigenvalues A n x 1 CV_32FC1 col-vector of the eigenvalues.
+	 * @param[in] triangleList The list of triangles of the mesh.
+	 * @param[in] storage The owner of the memory of the matrices, if they don't own it.
+	 * @return A PCA model that shares the given matrices.
+	 * @throws invalid_argument exception if the dimensions of the matrices don't fit together.
+	 */
+	static PcaModel fromMatrices(cv::Mat mean, cv::Mat normalizedPcaBasis, cv::Mat unnormalizedPcaBasis, cv::Mat eigenvalues, std::vector<std::array<int, 3>> triangleList, std::shared_ptr<void> storage = nullptr);
+
 	/**
 	 * Returns the number of principal components in the model.
 	 *
@@ -121,6 +140,15 @@ public:
 	 */
 	cv::Mat getMean() const; // Returning Mesh here makes no sense since the PCA model doesn't know if it's color or shape. Only the MorphableModel can return a Mesh.
 
+	/**
+	 * Returns the owner of the memory of the matrices (e.g. of the
+	 * mean) if they don't own it themselves. Whoever keeps using the
+	 * matrices beyond the lifetime of the model has to keep it alive.
+	 *
+	 * @return The owner of the memory of the matrices, empty if they own their memory.
+	 */
+	std::shared_ptr<void> getStorage() const;
+
 	/**
 	 * Return the value of the mean at a given landmark.
 	 *
@@ -153,7 +181,33 @@ public:
 	 * @param[in] coefficients The PCA coefficients used to generate the sample.
 	 * @return A model instance with given coefficients.
 	 */
-	cv::Mat drawSample(std::vector<float> coefficients);
+	cv::Mat drawSample(std::vector<float> coefficients) const;
+
+	/**
+	 * Computes a sample from the model using only the first k
+	 * basis vectors, where k is the number of given coefficients.
+	 * The sample is written into a caller-provided buffer, which
+	 * is only re-allocated if it does not have the right size.
+	 *
+	 * @param[in] coefficients The first k PCA coefficients, may be fewer than the number of principal components.
+	 * @param[out] sample A 3m x 1 CV_32FC1 col-vector (xyzxyz...)'.
+	 * @throws invalid_argument exception if there are more coefficients than principal components.
+	 */
+	void drawSample(const std::vector<float>& coefficients, cv::Mat& sample) const;
+
+	/**
+	 * Computes a sample from the model only at the given vertices,
+	 * using only the first k basis vectors, where k is the number
+	 * of given coefficients. This is e.g. useful for evaluating
+	 * landmark residuals without computing the full sample.
+	 *
+	 * @param[in] coefficients The first k PCA coefficients, may be fewer than the number of principal components.
+	 * @param[in] vertexIndices The ids of the vertices to compute.
+	 * @param[out] sample A 3v x 1 CV_32FC1 col-vector (xyzxyz...)' with the positions of the v given vertices.
+	 * @throws invalid_argument exception if there are more coefficients than principal components.
+	 * @throws out_of_range exception if a vertex id does not exist in the model.
+	 */
+	void drawSample(const std::vector<float>& coefficients, const std::vector<int>& vertexIndices, cv::Mat& sample) const;
 
 	/**
 	* Returns The PCA basis matrix, i.e. the eigenvectors.
@@ -181,6 +235,16 @@ public:
 	*/
 	cv::Mat getNormalizedPcaBasis(std::string landmarkIdentifier) const;
 
+	/**
+	* Returns The unnormalized PCA basis matrix, i.e. the eigenvectors.
+	* Each column of the matrix is an eigenvector.
+	* Returns a clone of the matrix so that the original cannot
+	* be modified.
+	*
+	* @return Returns the unnormalized PCA basis matrix.
+	*/
+	cv::Mat getUnnormalizedPcaBasis() const;
+
 	/**
 	* Returns the PCA basis for a particular vertex. The vertex
 	* is specified by a landmark identifier that the model can
@@ -197,6 +261,13 @@ public:
 
 	float getEigenvalue(unsigned int index) const;
 
+	/**
+	* Returns a clone of the col-vector of eigenvalues.
+	*
+	* @return The eigenvalues (variances in the PCA space).
+	*/
+	cv::Mat getEigenvalues() const;
+
 	/**
 	* Returns true if the given landmark identifier
 	* exists in the model.
@@ -217,6 +288,8 @@ private:
 	cv::Mat eigenvalues; ///< A col-vector of the eigenvalues (variances in the PCA space).
 
 	std::vector<std::array<int, 3>> triangleList; ///< List of triangles that make up the mesh of the model. (Note: Does every PCA model has a triangle-list? Use Mesh here instead?)
+
+	std::shared_ptr<void> storage; ///< Owner of the memory of the matrices if they don't own it themselves (e.g. a memory-mapped file), otherwise empty
 };
 
 /**
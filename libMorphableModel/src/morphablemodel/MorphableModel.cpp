@@ -10,9 +10,16 @@
 #include "opencv2/core/core.hpp"
 #include "boost/lexical_cast.hpp"
 #include "boost/filesystem/path.hpp"
+#include "boost/interprocess/file_mapping.hpp"
+#include "boost/interprocess/mapped_region.hpp"
 #include <exception>
+#include <stdexcept>
 #include <sstream>
 #include <fstream>
+#include <memory>
+#include <cstdint>
+#include <cstring>
+#include <utility>
 
 using logging::LoggerFactory;
 using cv::Mat;
@@ -23,6 +30,8 @@ using boost::lexical_cast;
 using boost::filesystem::path;
 using std::vector;
 using std::string;
+using std::array;
+using std::runtime_error;
 
 namespace morphablemodel {
 
@@ -43,9 +52,12 @@ morphablemodel::MorphableModel MorphableModel::load(const boost::property_tree::
 	else if (filename.extension().string() == ".h5") {
 		morphableModel = MorphableModel::loadStatismoModel(filename.string());
 	}
+	else if (filename.extension().string() == ".bin") {
+		morphableModel = MorphableModel::loadBinaryModel(filename.string());
+	}
 	else
 	{
-		throw std::runtime_error("MorphableModel: Unknown file extension. Neither .scm nor .h5.");
+		throw std::runtime_error("MorphableModel: Unknown file extension. Neither .scm, .h5 nor .bin.");
 	}
 	return morphableModel;
 }
@@ -79,6 +91,187 @@ MorphableModel MorphableModel::loadStatismoModel(path h5file)
 }
 
 
+namespace {
+
+/**
+ * Layout of one PCA model in the header of a binary model file.
+ * The offsets are in bytes from the beginning of the file.
+ */
+struct BinaryPcaModelHeader {
+	uint32_t dataDimension; ///< Number of rows of the mean and the bases (3 times the number of vertices)
+	uint32_t numPrincipalComponents; ///< Number of columns of the bases and number of eigenvalues
+	uint32_t numTriangles;
+	uint32_t reserved;
+	uint64_t meanOffset;
+	uint64_t normalizedBasisOffset;
+	uint64_t unnormalizedBasisOffset;
+	uint64_t eigenvaluesOffset;
+	uint64_t triangleListOffset;
+};
+
+/**
+ * Header at the beginning of a binary model file.
+ */
+struct BinaryModelHeader {
+	char magic[8];
+	uint32_t version;
+	uint32_t byteOrderMark; ///< Written in the byte order of the machine that wrote the file
+	BinaryPcaModelHeader shape;
+	BinaryPcaModelHeader color;
+	uint32_t numTextureCoordinates; ///< Zero if the model has no texture coordinates
+	uint32_t reserved;
+	uint64_t textureCoordinatesOffset;
+};
+
+static_assert(sizeof(BinaryModelHeader) == 144, "The binary model header must not contain padding");
+static_assert(sizeof(array<int, 3>) == 3 * sizeof(int32_t), "The triangle list must be stored as a contiguous array of ints");
+static_assert(sizeof(Vec2f) == 2 * sizeof(float), "The texture coordinates must be stored as a contiguous array of floats");
+
+const char binaryModelMagic[8] = { 'B', 'I', 'N', '3', 'D', 'M', 'M', '\0' };
+const uint32_t binaryModelVersion = 1;
+const uint32_t binaryModelByteOrderMark = 0x01020304;
+const std::streamoff binaryModelAlignment = 64; ///< Alignment of the arrays in the file (and in memory, as the mapping is page-aligned)
+
+/**
+ * Pads the file with zeros up to the next aligned position and returns that position.
+ */
+uint64_t alignFile(std::ofstream& file)
+{
+	const char zeros[binaryModelAlignment] = {};
+	std::streamoff position = file.tellp();
+	std::streamoff padding = (binaryModelAlignment - position % binaryModelAlignment) % binaryModelAlignment;
+	file.write(zeros, padding);
+	return static_cast<uint64_t>(position + padding);
+}
+
+/**
+ * Writes an array to the next aligned position in the file and returns its offset.
+ */
+uint64_t writeArray(std::ofstream& file, const void* data, size_t numBytes)
+{
+	uint64_t offset = alignFile(file);
+	file.write(static_cast<const char*>(data), numBytes);
+	return offset;
+}
+
+uint64_t writeMatrix(std::ofstream& file, const Mat& matrix)
+{
+	Mat continuousMatrix = matrix.isContinuous() ? matrix : matrix.clone();
+	return writeArray(file, continuousMatrix.data, continuousMatrix.total() * continuousMatrix.elemSize());
+}
+
+BinaryPcaModelHeader writePcaModel(std::ofstream& file, const PcaModel& model)
+{
+	Mat mean = model.getMean();
+	Mat normalizedBasis = model.getNormalizedPcaBasis();
+	Mat unnormalizedBasis = model.getUnnormalizedPcaBasis();
+	Mat eigenvalues = model.getEigenvalues();
+	vector<array<int, 3>> triangleList = model.getTriangleList();
+	if (mean.type() != CV_32FC1 || normalizedBasis.type() != CV_32FC1 || unnormalizedBasis.type() != CV_32FC1 || eigenvalues.type() != CV_32FC1) {
+		throw runtime_error("MorphableModel: The matrices of the PCA model must be of type CV_32FC1 to be stored in a binary model file.");
+	}
+	BinaryPcaModelHeader header = {};
+	header.dataDimension = normalizedBasis.rows;
+	header.numPrincipalComponents = normalizedBasis.cols;
+	header.numTriangles = static_cast<uint32_t>(triangleList.size());
+	header.meanOffset = writeMatrix(file, mean);
+	header.normalizedBasisOffset = writeMatrix(file, normalizedBasis);
+	header.unnormalizedBasisOffset = writeMatrix(file, unnormalizedBasis);
+	header.eigenvaluesOffset = writeMatrix(file, eigenvalues);
+	header.triangleListOffset = writeArray(file, triangleList.data(), triangleList.size() * sizeof(array<int, 3>));
+	return header;
+}
+
+/**
+ * Returns a matrix that points into the mapped file, after checking that it lies within the file.
+ */
+Mat mapMatrix(const boost::interprocess::mapped_region& region, uint64_t offset, int rows, int cols, int type)
+{
+	uint64_t numBytes = static_cast<uint64_t>(rows) * cols * CV_ELEM_SIZE(type);
+	if (offset % binaryModelAlignment != 0 || offset > region.get_size() || numBytes > region.get_size() - offset) {
+		throw runtime_error("MorphableModel: The binary model file is truncated or corrupt.");
+	}
+	return Mat(rows, cols, type, static_cast<char*>(region.get_address()) + offset);
+}
+
+PcaModel mapPcaModel(std::shared_ptr<boost::interprocess::mapped_region> region, const BinaryPcaModelHeader& header)
+{
+	int rows = static_cast<int>(header.dataDimension);
+	int cols = static_cast<int>(header.numPrincipalComponents);
+	Mat mean = mapMatrix(*region, header.meanOffset, rows, 1, CV_32FC1);
+	Mat normalizedBasis = mapMatrix(*region, header.normalizedBasisOffset, rows, cols, CV_32FC1);
+	Mat unnormalizedBasis = mapMatrix(*region, header.unnormalizedBasisOffset, rows, cols, CV_32FC1);
+	Mat eigenvalues = mapMatrix(*region, header.eigenvaluesOffset, cols, 1, CV_32FC1);
+	Mat triangles = mapMatrix(*region, header.triangleListOffset, static_cast<int>(header.numTriangles), 3, CV_32SC1);
+	vector<array<int, 3>> triangleList(header.numTriangles); // small, copied so that getTriangleList() works as before
+	if (!triangleList.empty()) {
+		std::memcpy(triangleList.data(), triangles.data, triangleList.size() * sizeof(array<int, 3>));
+	}
+	return PcaModel::fromMatrices(mean, normalizedBasis, unnormalizedBasis, eigenvalues, triangleList, region);
+}
+
+} /* unnamed namespace */
+
+MorphableModel MorphableModel::loadBinaryModel(path binaryFile)
+{
+	// The region stays valid after the file_mapping is destroyed. It is shared by all matrices of the model.
+	std::shared_ptr<boost::interprocess::mapped_region> region;
+	try {
+		boost::interprocess::file_mapping file(binaryFile.string().c_str(), boost::interprocess::read_only);
+		region = std::make_shared<boost::interprocess::mapped_region>(file, boost::interprocess::copy_on_write);
+	}
+	catch (boost::interprocess::interprocess_exception& e) {
+		throw runtime_error("MorphableModel: Could not map the binary model file " + binaryFile.string() + ": " + e.what());
+	}
+	if (region->get_size() < sizeof(BinaryModelHeader)) {
+		throw runtime_error("MorphableModel: The binary model file is truncated or corrupt.");
+	}
+	const BinaryModelHeader& header = *static_cast<const BinaryModelHeader*>(region->get_address());
+	if (std::memcmp(header.magic, binaryModelMagic, sizeof(binaryModelMagic)) != 0) {
+		throw runtime_error("MorphableModel: " + binaryFile.string() + " is not a binary model file.");
+	}
+	if (header.byteOrderMark != binaryModelByteOrderMark) {
+		throw runtime_error("MorphableModel: The binary model file was written on a machine with a different byte order.");
+	}
+	if (header.version != binaryModelVersion) {
+		throw runtime_error("MorphableModel: Unsupported version of the binary model file: " + lexical_cast<string>(header.version));
+	}
+
+	MorphableModel model;
+	model.shapeModel = mapPcaModel(region, header.shape);
+	model.colorModel = mapPcaModel(region, header.color);
+	if (header.numTextureCoordinates > 0) {
+		Mat texCoords = mapMatrix(*region, header.textureCoordinatesOffset, static_cast<int>(header.numTextureCoordinates), 1, CV_32FC2);
+		model.textureCoordinates.assign(texCoords.ptr<Vec2f>(), texCoords.ptr<Vec2f>() + header.numTextureCoordinates);
+		model.hasTextureCoordinates = true;
+	}
+	return model;
+}
+
+void MorphableModel::saveBinaryModel(path binaryFile) const
+{
+	std::ofstream file(binaryFile.string(), std::ios::binary);
+	if (!file.is_open()) {
+		throw runtime_error("MorphableModel: Could not open " + binaryFile.string() + " for writing.");
+	}
+	BinaryModelHeader header = {};
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header)); // placeholder, overwritten when the offsets are known
+	std::memcpy(header.magic, binaryModelMagic, sizeof(binaryModelMagic));
+	header.version = binaryModelVersion;
+	header.byteOrderMark = binaryModelByteOrderMark;
+	header.shape = writePcaModel(file, shapeModel);
+	header.color = writePcaModel(file, colorModel);
+	if (hasTextureCoordinates) {
+		header.numTextureCoordinates = static_cast<uint32_t>(textureCoordinates.size());
+		header.textureCoordinatesOffset = writeArray(file, textureCoordinates.data(), textureCoordinates.size() * sizeof(Vec2f));
+	}
+	file.seekp(0);
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	if (!file) {
+		throw runtime_error("MorphableModel: Could not write the binary model file " + binaryFile.string() + ".");
+	}
+}
+
 PcaModel MorphableModel::getShapeModel() const
 {
 	return shapeModel;
@@ -155,7 +348,7 @@ render::Mesh MorphableModel::drawSample(float sigma /*= 1.0f*/)
 	return mean;
 }
 
-render::Mesh MorphableModel::drawSample(vector<float> shapeCoefficients, vector<float> colorCoefficients)
+render::Mesh MorphableModel::drawSample(vector<float> shapeCoefficients, vector<float> colorCoefficients) const
 {
 	render::Mesh sample;
 
@@ -201,6 +394,46 @@ render::Mesh MorphableModel::drawSample(vector<float> shapeCoefficients, vector<
 	return sample;
 }
 
+render::SoaMesh MorphableModel::getMeanSoa() const
+{
+	return createSoaMesh(shapeModel.getMean(), colorModel.getMean());
+}
+
+render::SoaMesh MorphableModel::drawSampleSoa(vector<float> shapeCoefficients, vector<float> colorCoefficients) const
+{
+	Mat shapeSample = shapeCoefficients.empty() ? shapeModel.getMean() : shapeModel.drawSample(shapeCoefficients);
+	Mat colorSample = colorCoefficients.empty() ? colorModel.getMean() : colorModel.drawSample(colorCoefficients);
+	return createSoaMesh(shapeSample, colorSample);
+}
+
+render::SoaMesh MorphableModel::createSoaMesh(Mat shape, Mat color) const
+{
+	if (shape.total() != color.total()) {
+		string msg("MorphableModel: The number of vertices of the shape and color models are not the same: " + lexical_cast<string>(shape.total() / 3) + " != " + lexical_cast<string>(color.total() / 3));
+		Loggers->getLogger("morphablemodel").debug(msg);
+		throw std::runtime_error(msg);
+	}
+	render::SoaMesh mesh;
+	mesh.tvi = shapeModel.getTriangleList();
+	mesh.tci = colorModel.getTriangleList();
+	mesh.positions = render::SoaMesh::wrap(shape, 3);
+	mesh.colors = render::SoaMesh::wrap(color, 3); // order in hdf5: RGB, same as in the mesh
+	// the means may point into a memory-mapped file, so the mesh keeps the mapping alive
+	std::shared_ptr<void> shapeStorage = shapeModel.getStorage();
+	std::shared_ptr<void> colorStorage = colorModel.getStorage();
+	if (shapeStorage == colorStorage || !colorStorage)
+		mesh.storage = shapeStorage;
+	else if (!shapeStorage)
+		mesh.storage = colorStorage;
+	else
+		mesh.storage = std::make_shared<std::pair<std::shared_ptr<void>, std::shared_ptr<void>>>(shapeStorage, colorStorage);
+	if (hasTextureCoordinates) {
+		mesh.texcrds = Mat(textureCoordinates, true).reshape(1); // N x 1 Vec2f to N x 2 float, copied as the vector is owned by the model
+		mesh.hasTexture = true; // Note: Actually it doesn't have a texture, just texture coordinates!
+	}
+	return mesh;
+}
+
 vector<Vec2f> MorphableModel::loadIsomap(path isomapFile)
 {
 	vector<float> xCoords, yCoords;
@@ -16,6 +16,7 @@
 #include "boost/algorithm/string.hpp"
 
 #include <fstream>
+#include <stdexcept>
 
 using logging::LoggerFactory;
 using cv::Mat;
@@ -389,6 +390,21 @@ PcaModel PcaModel::loadScmModel(path modelFilename, path landmarkVertexMappingFi
 	//return model;
 }
 
+PcaModel PcaModel::fromMatrices(Mat mean, Mat normalizedPcaBasis, Mat unnormalizedPcaBasis, Mat eigenvalues, vector<array<int, 3>> triangleList, std::shared_ptr<void> storage/*=nullptr*/)
+{
+	if (mean.cols != 1 || normalizedPcaBasis.rows != mean.rows || unnormalizedPcaBasis.size() != normalizedPcaBasis.size() || eigenvalues.total() != static_cast<size_t>(normalizedPcaBasis.cols)) {
+		throw std::invalid_argument("PcaModel: The dimensions of the mean, the PCA bases and the eigenvalues don't match.");
+	}
+	PcaModel model;
+	model.mean = mean;
+	model.normalizedPcaBasis = normalizedPcaBasis;
+	model.unnormalizedPcaBasis = unnormalizedPcaBasis;
+	model.eigenvalues = eigenvalues;
+	model.triangleList = std::move(triangleList);
+	model.storage = std::move(storage);
+	return model;
+}
+
 unsigned int PcaModel::getNumberOfPrincipalComponents() const
 {
 	// Note: we could assert(normalizedPcaBasis.cols==unnormalizedPcaBasis.cols)
@@ -413,6 +429,11 @@ Mat PcaModel::getMean() const
 	return mean;
 }
 
+std::shared_ptr<void> PcaModel::getStorage() const
+{
+	return storage;
+}
+
 Vec3f PcaModel::getMeanAtPoint(string landmarkIdentifier) const
 {
 	//int vertexId = landmarkVertexMap.at(landmarkIdentifier); // TODO hack. Do proper.
@@ -456,9 +477,8 @@ Mat PcaModel::drawSample(float sigma/*=1.0f*/)
 	*/
 }
 
-Mat PcaModel::drawSample(vector<float> coefficients)
+Mat PcaModel::drawSample(vector<float> coefficients) const
 {
-	Mat alphas(coefficients);
 	/*
 	Mat sqrtOfEigenvalues = eigenvalues.clone();
 	for (unsigned int i = 0; i < eigenvalues.rows; ++i)	{
@@ -471,12 +491,52 @@ Mat PcaModel::drawSample(vector<float> coefficients)
 	//Mat modelSample = mean + pcaBasis * alphas.mul(sqrtOfEigenvalues); // Surr
 	//Mat modelSample = mean + pcaBasis * alphas; // Bsl .h5 old
 	*/
-	// Not necessary anymore: We can now just do:
-	Mat modelSample = mean + normalizedPcaBasis * alphas;
-
+	// Not necessary anymore: We can now just do mean + normalizedPcaBasis * alphas:
+	Mat modelSample;
+	drawSample(coefficients, modelSample);
 	return modelSample;
 }
 
+void PcaModel::drawSample(const vector<float>& coefficients, Mat& sample) const
+{
+	int numCoefficients = static_cast<int>(coefficients.size());
+	if (numCoefficients > normalizedPcaBasis.cols) {
+		throw std::invalid_argument("PcaModel: There are more coefficients than principal components: " + lexical_cast<string>(numCoefficients) + " > " + lexical_cast<string>(normalizedPcaBasis.cols));
+	}
+	sample.create(mean.rows, 1, CV_32FC1);
+	if (numCoefficients == 0) {
+		mean.copyTo(sample);
+		return;
+	}
+	// Only the first k columns of the basis are used
+	Mat alphas(numCoefficients, 1, CV_32FC1, const_cast<float*>(coefficients.data()));
+	cv::gemm(normalizedPcaBasis.colRange(0, numCoefficients), alphas, 1.0, mean, 1.0, sample);
+}
+
+void PcaModel::drawSample(const vector<float>& coefficients, const vector<int>& vertexIndices, Mat& sample) const
+{
+	int numCoefficients = static_cast<int>(coefficients.size());
+	if (numCoefficients > normalizedPcaBasis.cols) {
+		throw std::invalid_argument("PcaModel: There are more coefficients than principal components: " + lexical_cast<string>(numCoefficients) + " > " + lexical_cast<string>(normalizedPcaBasis.cols));
+	}
+	sample.create(3 * static_cast<int>(vertexIndices.size()), 1, CV_32FC1);
+	float* values = sample.ptr<float>();
+	for (size_t i = 0; i < vertexIndices.size(); ++i) {
+		int row = 3 * vertexIndices[i];
+		if (vertexIndices[i] < 0 || row >= mean.rows) {
+			throw std::out_of_range("PcaModel: The given vertex id is larger than the dimension of the mean.");
+		}
+		for (int coordinate = 0; coordinate < 3; ++coordinate) {
+			const float* basisRow = normalizedPcaBasis.ptr<float>(row + coordinate);
+			double value = mean.at<float>(row + coordinate);
+			for (int k = 0; k < numCoefficients; ++k) {
+				value += basisRow[k] * coefficients[k];
+			}
+			values[3 * i + coordinate] = static_cast<float>(value);
+		}
+	}
+}
+
 cv::Mat PcaModel::getNormalizedPcaBasis() const
 {
 	return normalizedPcaBasis.clone();
@@ -508,11 +568,21 @@ cv::Mat PcaModel::getNormalizedPcaBasis(std::string landmarkIdentifier) const
 	return normalizedPcaBasis.rowRange(vertexId, vertexId + 3);
 }
 
+cv::Mat PcaModel::getUnnormalizedPcaBasis() const
+{
+	return unnormalizedPcaBasis.clone();
+}
+
 float PcaModel::getEigenvalue(unsigned int index) const
 {
 	return eigenvalues.at<float>(index);
 }
 
+cv::Mat PcaModel::getEigenvalues() const
+{
+	return eigenvalues.clone();
+}
+
 bool PcaModel::landmarkExists(std::string landmarkIdentifier) const
 {
 	int vertexId = boost::lexical_cast<int>(landmarkIdentifier);
@@ -0,0 +1,89 @@
+/*
+ * BatchRenderer.hpp
+ *
+ *  Created on: 18.10.2026
+ *      Author: Patrik Huber
+ */
+#pragma once
+
+#ifndef BATCHRENDERER_HPP_
+#define BATCHRENDERER_HPP_
+
+#include "render/Mesh.hpp"
+#include "render/SoaMesh.hpp"
+
+#include "opencv2/core/core.hpp"
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace render {
+
+/**
+ * Renders many instances of one mesh topology, e.g. different poses or shape samples
+ * of a morphable model, with the software renderer.
+ *
+ * The topology (triangle indices, vertex colors, texture coordinates) and the texture
+ * with its mipmaps are set once and stay resident. Each job only consists of the vertex
+ * positions and the MVP matrix. The jobs are distributed across threads, each thread
+ * rendering its jobs serially with its own SoftwareRenderer. The vertex buffers of
+ * the jobs are wrapped without copying them.
+ */
+class BatchRenderer
+{
+public:
+	/**
+	 * One image to render.
+	 */
+	struct Job {
+		cv::Mat positions; ///< 3N x 1 (or 1 x 3N) CV_32F vertex positions x0, y0, z0, x1, ... as returned by PcaModel::drawSample. If empty, the positions of the topology mesh are used.
+		cv::Mat mvp; ///< 4x4 CV_32F model-view-projection matrix.
+	};
+
+	/**
+	 * Constructs a new batch renderer.
+	 *
+	 * @param[in] viewportWidth Width of the rendered images.
+	 * @param[in] viewportHeight Height of the rendered images.
+	 * @param[in] topology Mesh whose triangles, vertex colors, texture coordinates and default positions are used for every job.
+	 */
+	BatchRenderer(unsigned int viewportWidth, unsigned int viewportHeight, const Mesh& topology);
+
+	/**
+	 * Constructs a new batch renderer from a mesh in structure-of-arrays layout.
+	 *
+	 * @param[in] viewportWidth Width of the rendered images.
+	 * @param[in] viewportHeight Height of the rendered images.
+	 * @param[in] topology Mesh whose triangles, vertex colors, texture coordinates and default positions are used for every job.
+	 */
+	BatchRenderer(unsigned int viewportWidth, unsigned int viewportHeight, SoaMesh topology);
+
+	bool doBackfaceCulling = false; ///< If true, only draw triangles with vertices ordered CCW in screen-space.
+	bool doTexturing = false; ///< If true, the texture is used instead of the vertex colors.
+
+	void setTexture(std::shared_ptr<Texture> texture) {
+		this->texture = texture;
+	};
+
+	/**
+	 * Renders all jobs in parallel. The result of each job is the same as that of
+	 * SoftwareRenderer::render with the mesh and MVP matrix of the job.
+	 *
+	 * @param[in] jobs The vertex buffers and MVP matrices to render.
+	 * @return Color (CV_8UC4) and depth (CV_64FC1) buffer of each job, in the order of the jobs. The buffers are not shared with the renderer.
+	 */
+	std::vector<std::pair<cv::Mat, cv::Mat>> render(const std::vector<Job>& jobs) const;
+
+private:
+	class JobRenderer; ///< Renders a range of jobs, used with cv::parallel_for_.
+
+	unsigned int viewportWidth;
+	unsigned int viewportHeight;
+	SoaMesh topology; ///< Mesh with the triangles, colors, texture coordinates and default positions.
+	std::shared_ptr<Texture> texture; ///< Texture with its mipmaps.
+};
+
+} /* namespace render */
+
+#endif /* BATCHRENDERER_HPP_ */
@@ -10,6 +10,7 @@
 #define MESHUTILS_HPP_
 
 #include "render/Mesh.hpp"
+#include "render/SoaMesh.hpp"
 
 #include "opencv2/core/core.hpp"
 
@@ -35,7 +36,27 @@ namespace render {
 			static bool isPointInTriangle(cv::Point2f point, cv::Point2f triV0, cv::Point2f triV1, cv::Point2f triV2);
 		};
 
-		cv::Mat extractTexture(render::Mesh mesh, cv::Mat mvpMatrix, int viewportWidth, int viewportHeight, cv::Mat image, cv::Mat depthBuffer);
+		/**
+		 * Extracts the texture of a fitted mesh from an image into an isomap (texture map). Only triangles that
+		 * face the camera and, if a depth buffer is given, are completely visible in it are extracted. The image
+		 * is sampled with bicubic interpolation. The triangles are set up in parallel and the isomap is filled
+		 * in parallel bands, the result does not depend on the number of threads.
+		 *
+		 * @param[in] mesh The mesh whose texture coordinates define the location of the triangles in the isomap.
+		 * @param[in] mvpMatrix 4x4 CV_32F model-view-projection matrix that projects the mesh into the image.
+		 * @param[in] viewportWidth Width of the viewport (usually the image width).
+		 * @param[in] viewportHeight Height of the viewport (usually the image height).
+		 * @param[in] image BGR (or grayscale or BGRA) image to extract the texture from.
+		 * @param[in] depthBuffer Depth buffer of the mesh rendered with the same matrix, e.g. the one of SoftwareRenderer::render. If empty, no visibility check is done.
+		 * @param[in] isomapResolution Width and height of the isomap.
+		 * @return The isomap (CV_8UC3), black where nothing was extracted.
+		 */
+		cv::Mat extractTexture(const render::Mesh& mesh, cv::Mat mvpMatrix, int viewportWidth, int viewportHeight, cv::Mat image, cv::Mat depthBuffer = cv::Mat(), int isomapResolution = 512);
+
+		/**
+		 * Extracts the texture of a fitted mesh in structure-of-arrays layout, see above. The mesh must have texture coordinates.
+		 */
+		cv::Mat extractTexture(const render::SoaMesh& mesh, cv::Mat mvpMatrix, int viewportWidth, int viewportHeight, cv::Mat image, cv::Mat depthBuffer = cv::Mat(), int isomapResolution = 512);
 
 	} /* namespace utils */
 
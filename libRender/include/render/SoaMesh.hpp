@@ -0,0 +1,84 @@
+/*
+ * SoaMesh.hpp
+ *
+ *  Created on: 18.10.2026
+ *      Author: Patrik Huber
+ */
+#pragma once
+
+#ifndef SOAMESH_HPP_
+#define SOAMESH_HPP_
+
+#include "render/Mesh.hpp"
+
+#include "opencv2/core/core.hpp"
+
+#include <vector>
+#include <array>
+#include <string>
+#include <memory>
+
+namespace render {
+
+/**
+ * A mesh in structure-of-arrays layout: The positions, colors and texture coordinates of
+ * all vertices are stored in separate contiguous float matrices, one row per vertex.
+ *
+ * Because a PCA sample of a morphable model (3N x 1, x0 y0 z0 x1 ...) has the same memory
+ * layout as the N x 3 position matrix, the arrays can wrap those samples without copying
+ * (see wrap(...)). The matrices are reference-counted, so a mesh may share its data with
+ * the matrices it was created from. If those matrices do not own their memory (e.g. they
+ * point into a memory-mapped file), the owner is kept alive by the storage of the mesh.
+ */
+class SoaMesh
+{
+public:
+
+	cv::Mat positions; ///< N x 3 CV_32FC1 vertex positions (x, y, z), the homogeneous coordinate is 1.
+	cv::Mat colors; ///< N x 3 CV_32FC1 vertex colors in RGB-format, may be empty.
+	cv::Mat texcrds; ///< N x 2 CV_32FC1 texture coordinates, may be empty.
+
+	std::vector<std::array<int, 3>> tvi; ///< Triangle vertex indices.
+	std::vector<std::array<int, 3>> tci; ///< Triangle color indices.
+
+	bool hasTexture = false;
+	std::string textureName;
+
+	std::shared_ptr<render::Texture> texture;
+
+	std::shared_ptr<void> storage; ///< Owner of the memory of the arrays if they don't own it themselves (e.g. a memory-mapped file), otherwise empty.
+
+	/**
+	 * @return The number of vertices.
+	 */
+	int getVertexCount() const {
+		return positions.rows;
+	};
+
+	/**
+	 * Creates an N x channels matrix header for a buffer of N * channels float values (e.g. a
+	 * 3N x 1 PCA sample or a vector of Vec2f). The data is only copied if the buffer is not
+	 * continuous or not of type CV_32F.
+	 *
+	 * @param[in] values The buffer.
+	 * @param[in] channels The number of values per vertex.
+	 * @return An N x channels CV_32FC1 matrix.
+	 */
+	static cv::Mat wrap(const cv::Mat& values, int channels);
+
+	/**
+	 * Converts a mesh with interleaved vertices. The homogeneous coordinate of the positions is dropped.
+	 *
+	 * @param[in] mesh The mesh.
+	 * @return A copy of the mesh in structure-of-arrays layout.
+	 */
+	static SoaMesh fromMesh(const Mesh& mesh);
+
+	// obj with vertex-coloring, same format as Mesh::writeObj
+	static void writeObj(const SoaMesh& mesh, std::string filename);
+
+};
+
+} /* namespace render */
+
+#endif /* SOAMESH_HPP_ */
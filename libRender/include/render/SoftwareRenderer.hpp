@@ -10,10 +10,12 @@
 #define SOFTWARERENDERER_HPP_
 
 #include "render/Mesh.hpp"
+#include "render/SoaMesh.hpp"
 #include "render/MatrixUtils.hpp"
 
 #include "opencv2/core/core.hpp"
 #include "boost/optional/optional.hpp"
+#include <vector>
 #ifdef WITH_RENDER_QOPENGL
 	#include <QMatrix4x4>
 #endif
@@ -36,15 +38,26 @@ public:
 
 	bool doBackfaceCulling = false; ///< If true, only draw triangles with vertices ordered CCW in screen-space
 	bool doTexturing = false; ///< Desc.
+	bool doTiledRasterization = true; ///< If true, the triangles are binned into screen tiles that are rasterized in parallel. The output is the same as when rasterizing serially.
 
 #ifdef WITH_RENDER_QOPENGL
-	std::pair<cv::Mat, cv::Mat> render(Mesh mesh, QMatrix4x4 mvp);
+	std::pair<cv::Mat, cv::Mat> render(const Mesh& mesh, QMatrix4x4 mvp);
 #endif
 	// Note: returns a reference (Mat) to the framebuffer, not
 	// a clone! I.e. if you don't want your image to get
 	// overwritten by a second call to render(...), you have to
-	// clone.
-	std::pair<cv::Mat, cv::Mat> render(Mesh mesh, cv::Mat mvp);
+	// clone. The framebuffers are re-used across calls.
+	std::pair<cv::Mat, cv::Mat> render(const Mesh& mesh, cv::Mat mvp);
+
+	/**
+	 * Renders a mesh in structure-of-arrays layout. Vertices without colors are
+	 * black, vertices without texture coordinates use (0, 0).
+	 *
+	 * @param[in] mesh The mesh, e.g. wrapping a PCA sample of a morphable model.
+	 * @param[in] mvp 4x4 CV_32F model-view-projection matrix.
+	 * @return Color and depth buffer, see above.
+	 */
+	std::pair<cv::Mat, cv::Mat> render(const SoaMesh& mesh, cv::Mat mvp);
 
 	cv::Vec3f projectVertex(cv::Vec4f vertex, cv::Mat mvp);
 	
@@ -56,34 +69,102 @@ public:
 		currentTexture = texture;
 	};
 
+	/**
+	 * Changes the size of the screen tiles that are used for tiled rasterization.
+	 *
+	 * @param[in] tileSize Width and height of the tiles in pixels.
+	 */
+	void setTileSize(int tileSize);
+
+	/**
+	 * How many triangles were rejected or passed by the culling and clipping stage.
+	 */
+	struct CullingStatistics {
+		int numTriangles = 0; ///< The triangles of the mesh.
+		int numOutside = 0; ///< Triangles that lie completely outside of one of the frustum planes.
+		int numBackfacing = 0; ///< Back-facing triangles that don't intersect the frustum (only if doBackfaceCulling is set). Clipped back-facing triangles are rejected after clipping and not counted here.
+		int numClipped = 0; ///< Triangles that intersect the frustum and were clipped against the near-plane.
+		int numRasterized = 0; ///< Triangles (after clipping) that were passed to the rasterizer.
+	};
+
+	/**
+	 * Returns the culling statistics of the last call to render(...).
+	 *
+	 * @return The culling statistics of the last rendered mesh.
+	 */
+	const CullingStatistics& getCullingStatistics() const {
+		return cullingStatistics;
+	};
+
 private:
+	class TileRasterizer; ///< Rasterizes the triangles of screen tiles, used with cv::parallel_for_.
+
 	cv::Mat colorBuffer;
 	cv::Mat depthBuffer;
 	unsigned int viewportWidth = 640;
 	unsigned int viewportHeight = 480;
 	float aspect;
 
+	// Buffers that are re-used across calls to render(...):
+	std::vector<Vertex> clipSpaceVertices; ///< The vertices of the mesh in clip-space.
+	std::vector<TriangleToRasterize> trisToRaster; ///< The triangles that passed clipping and culling, in mesh order.
+	std::vector<std::vector<unsigned int>> tileBins; ///< Per screen tile (row-major), the indices of the triangles overlapping it, in mesh order.
+	int tileSize = 32; ///< Width and height of the screen tiles in pixels.
+	std::vector<unsigned char> vertexOutcodes; ///< Per vertex of clipSpaceVertices, a bit for each frustum plane it lies outside of.
+	std::vector<cv::Vec2f> screenSpacePositions; ///< Per vertex of clipSpaceVertices, its position in screen-space, for the back-face test.
+	CullingStatistics cullingStatistics; ///< The statistics of the last call to render(...).
+
 	// Texturing:
 	std::shared_ptr<Texture> currentTexture;
-	float dudx, dudy, dvdx, dvdy; // partial derivatives of U/V coordinates with respect to X/Y pixel's screen coordinates
+
+	/**
+	 * Clips, culls and rasterizes the triangles of clipSpaceVertices.
+	 */
+	std::pair<cv::Mat, cv::Mat> renderClipSpaceVertices(const std::vector<std::array<int, 3>>& tvi);
 
 	// Todo: Split this function into the general (core-part) and the texturing part.
 	// Then, utils::extractTexture can re-use the core-part.
 	boost::optional<TriangleToRasterize> processProspectiveTri(Vertex v0, Vertex v1, Vertex v2);
 
-	void rasterTriangle(TriangleToRasterize triangle);
-
-	std::vector<Vertex> clipPolygonToPlaneIn4D(const std::vector<Vertex>& vertices, const cv::Vec4f& planeNormal);
-
-	cv::Vec3f tex2D(const cv::Vec2f& texCoord);
-
-	cv::Vec3f tex2D_linear_mipmap_linear(const cv::Vec2f& texCoord);
-
-	cv::Vec2f texCoord_wrap(const cv::Vec2f& texCoord);
-
-	cv::Vec3f tex2D_linear(const cv::Vec2f& imageTexCoord, unsigned char mipmapIndex);
-
-	float clamp(float x, float a, float b); // Todo: Document! x, a, b?
+	/**
+	 * Rasterizes the part of a triangle that lies inside the given (inclusive) pixel bounds. Because each pixel
+	 * is only touched by one tile, tiles can be rasterized concurrently.
+	 */
+	void rasterTriangle(const TriangleToRasterize& triangle, int minX, int maxX, int minY, int maxY);
+
+	void rasterTiles();
+
+	/**
+	 * The culling and clipping stage: Every vertex is classified against the frustum once, then
+	 * triangles that lie outside of the frustum and (if enabled) back-facing triangles are
+	 * rejected without copying their vertices. Triangles intersecting the frustum are clipped
+	 * against the near-plane in a fixed-size buffer. The triangles to rasterize are appended to
+	 * trisToRaster in mesh order.
+	 */
+	void cullAndClipTriangles(const std::vector<std::array<int, 3>>& tvi);
+
+	/**
+	 * Clips a convex polygon against a plane in homogeneous (clip-space) coordinates.
+	 * The output has at most one vertex more than the input.
+	 *
+	 * @param[in] vertices The vertices of the polygon.
+	 * @param[in] numVertices The number of vertices of the polygon.
+	 * @param[in] planeNormal The plane, the part of the polygon on its negative side is kept.
+	 * @param[out] clippedVertices Buffer for at least numVertices + 1 vertices of the clipped polygon.
+	 * @return The number of vertices of the clipped polygon.
+	 */
+	int clipPolygonToPlaneIn4D(const Vertex* vertices, int numVertices, const cv::Vec4f& planeNormal, Vertex* clippedVertices) const;
+
+	// dudx, dudy, dvdx, dvdy: partial derivatives of U/V coordinates with respect to X/Y pixel's screen coordinates
+	cv::Vec3f tex2D(const cv::Vec2f& texCoord, float dudx, float dudy, float dvdx, float dvdy) const;
+
+	cv::Vec3f tex2D_linear_mipmap_linear(const cv::Vec2f& texCoord, float dudx, float dudy, float dvdx, float dvdy) const;
+
+	cv::Vec2f texCoord_wrap(const cv::Vec2f& texCoord) const;
+
+	cv::Vec3f tex2D_linear(const cv::Vec2f& imageTexCoord, unsigned char mipmapIndex) const;
+
+	float clamp(float x, float a, float b) const; // Todo: Document! x, a, b?
 };
 
  } /* namespace render */
@@ -11,10 +11,19 @@
 
 #include "opencv2/core/core.hpp"
 
+#include <string>
+#include <vector>
+
 namespace render {
 
 /**
- * Desc
+ * A texture with its mipmap chain, as used by the SoftwareRenderer.
+ *
+ * All mip-levels are stored in one contiguous buffer. Each level is
+ * generated from the previous one by averaging 2x2 pixels, with the rows
+ * of a level computed in parallel. A texture is not modified after it has
+ * been created, so it can be shared by several renderers that render
+ * concurrently.
  */
 class Texture
 {
@@ -22,12 +31,25 @@ public:
 
 	void createFromFile(const std::string& fileName, unsigned int mipmapsNum = 0);
 
+	/**
+	 * Creates the texture and its mipmaps from an image in memory,
+	 * e.g. an isomap that was just extracted.
+	 *
+	 * @param[in] image A CV_8UC3 (BGR) or CV_8UC4 (BGRA) image. The size must be a power of two if mipmaps are generated.
+	 * @param[in] mipmapsNum The number of mip-levels, 0 for the full chain down to 1x1.
+	 * @throws invalid_argument exception if the image is empty, has a wrong type or if mipmaps can't be generated.
+	 */
+	void create(const cv::Mat& image, unsigned int mipmapsNum = 0);
+
 	std::vector<cv::Mat> mipmaps;	// make Texture a friend class of renderer, then move this to private?
 	unsigned char widthLog, heightLog; // log2 of width and height of the base mip-level
 
 private:
+	class DownsampleBody; ///< Computes a range of rows of a mip-level from the previous level, used with cv::parallel_for_.
+
 	std::string fileName;
 	unsigned int mipmapsNum;
+	cv::Mat storage; ///< One row containing all mip-levels, the matrices in mipmaps are reshaped parts of it.
 
 	inline bool isPowerOfTwo(int x)
 	{
@@ -0,0 +1,77 @@
+/*
+ * BatchRenderer.cpp
+ *
+ *  Created on: 18.10.2026
+ *      Author: Patrik Huber
+ */
+
+#include "render/BatchRenderer.hpp"
+#include "render/SoftwareRenderer.hpp"
+
+#include <stdexcept>
+
+using cv::Mat;
+using std::pair;
+using std::vector;
+using std::invalid_argument;
+
+namespace render {
+
+class BatchRenderer::JobRenderer : public cv::ParallelLoopBody
+{
+public:
+	JobRenderer(const BatchRenderer& batchRenderer, const vector<Job>& jobs, vector<pair<Mat, Mat>>& framebuffers) :
+		batchRenderer(batchRenderer), jobs(jobs), framebuffers(framebuffers) {}
+
+	void operator()(const cv::Range& range) const override
+	{
+		SoftwareRenderer renderer(batchRenderer.viewportWidth, batchRenderer.viewportHeight);
+		renderer.doBackfaceCulling = batchRenderer.doBackfaceCulling;
+		renderer.doTexturing = batchRenderer.doTexturing;
+		renderer.doTiledRasterization = false; // the jobs are already rendered in parallel
+		renderer.setCurrentTexture(batchRenderer.texture);
+		SoaMesh mesh = batchRenderer.topology; // shares the arrays of the topology, only the positions are exchanged per job
+		for (int i = range.start; i < range.end; ++i) {
+			const Job& job = jobs[i];
+			if (job.positions.empty())
+				mesh.positions = batchRenderer.topology.positions;
+			else
+				mesh.positions = SoaMesh::wrap(job.positions, 3); // no copy
+			pair<Mat, Mat> framebuffer = renderer.render(mesh, job.mvp);
+			// the renderer re-uses its buffers for the next job
+			framebuffers[i] = std::make_pair(framebuffer.first.clone(), framebuffer.second.clone());
+		}
+	}
+
+private:
+	const BatchRenderer& batchRenderer;
+	const vector<Job>& jobs;
+	vector<pair<Mat, Mat>>& framebuffers;
+};
+
+BatchRenderer::BatchRenderer(unsigned int viewportWidth, unsigned int viewportHeight, const Mesh& topology) :
+	BatchRenderer(viewportWidth, viewportHeight, SoaMesh::fromMesh(topology))
+{
+}
+
+BatchRenderer::BatchRenderer(unsigned int viewportWidth, unsigned int viewportHeight, SoaMesh topology) :
+	viewportWidth(viewportWidth), viewportHeight(viewportHeight), topology(std::move(topology)), texture(this->topology.texture)
+{
+}
+
+vector<pair<Mat, Mat>> BatchRenderer::render(const vector<Job>& jobs) const
+{
+	for (const auto& job : jobs) {
+		if (!job.positions.empty() && (job.positions.type() != CV_32FC1 || !job.positions.isContinuous() || job.positions.total() != 3 * static_cast<size_t>(topology.getVertexCount())))
+			throw invalid_argument("BatchRenderer: the positions of a job must be a continuous CV_32FC1 matrix with three values per vertex of the topology");
+		if (job.mvp.rows != 4 || job.mvp.cols != 4)
+			throw invalid_argument("BatchRenderer: the MVP matrix of a job must be 4x4");
+	}
+	if (doTexturing && !texture)
+		throw invalid_argument("BatchRenderer: texturing is enabled, but there is no texture");
+	vector<pair<Mat, Mat>> framebuffers(jobs.size());
+	cv::parallel_for_(cv::Range(0, static_cast<int>(jobs.size())), JobRenderer(*this, jobs, framebuffers));
+	return framebuffers;
+}
+
+} /* namespace render */
@@ -14,11 +14,15 @@
 #include <array>
 #include <iostream>
 #include <fstream>
+#include <stdexcept>
+#include <vector>
 
 using cv::Mat;
 using cv::Point2f;
 using cv::Vec2f;
+using cv::Vec4f;
 using cv::Scalar;
+using std::vector;
 
 namespace render {
 	namespace utils {
@@ -271,161 +275,299 @@ bool MeshUtils::isPointInTriangle(cv::Point2f point, cv::Point2f triV0, cv::Poin
 	return (u >= 0) && (v >= 0) && (u + v < 1);
 }
 
-// image: where to extract the texture from
-// note: framebuffer should have size of the image (ok not necessarily. What about mobile?) (well it should, to get optimal quality (and everywhere the same quality)?)
-// note: mvpMatrix: Atm working with a 4x4 (full) affine. But anything would work, just take care with the w-division.
-// Regarding the depth-buffer: We could also pass an instance of a Renderer here. Depending on how "stateful" the renderer is, this might make more sense.
-Mat extractTexture(Mesh mesh, Mat mvpMatrix, int viewportWidth, int viewportHeight, Mat image, Mat depthBuffer) {
-	// optional param Mat textureMap = Mat(512, 512, CV_8UC3) ?
-	//Mat textureMap(512, 512, inputImage.type());
-	Mat textureMap = Mat::zeros(512, 512, CV_8UC3); // We don't want an alpha channel. We might want to handle grayscale input images though.
-	Mat visibilityMask = Mat::zeros(512, 512, CV_8UC3);
-
-	for (const auto& triangleIndices : mesh.tvi) {
-
-		// Find out if the current triangle is visible:
-		// We do a second rendering-pass here. We use the depth-buffer of the final image, and then, here,
-		// check if each pixel in a triangle is visible. If the whole triangle is visible, we use it to extract
-		// the texture.
-		// Possible improvement: - If only part of the triangle is visible, split it
-		// - Share more code with the renderer?
-		Vertex v0_3d = mesh.vertex[triangleIndices[0]];
-		Vertex v1_3d = mesh.vertex[triangleIndices[1]];
-		Vertex v2_3d = mesh.vertex[triangleIndices[2]];
+/**
+ * Per-triangle setup of the texture extraction that is independent of the isomap pixels.
+ */
+struct ExtractionTriangle {
+	bool extract; ///< Flag that indicates whether the triangle faces the camera and is visible.
+	cv::Matx23f isomapToImage; ///< Affine transformation from isomap to image coordinates.
+	int minX, maxX, minY, maxY; ///< Isomap pixels that are tested against the triangle (maxX and maxY exclusive).
+	float u0, dudx, dudy; ///< Barycentric coordinate u (see MeshUtils::isPointInTriangle) at (minX, minY) and its derivatives.
+	float v0, dvdx, dvdy; ///< Barycentric coordinate v at (minX, minY) and its derivatives.
+};
+
+/**
+ * Sets up the triangles of the mesh, used with cv::parallel_for_.
+ */
+class ExtractionSetup : public cv::ParallelLoopBody {
+public:
+	ExtractionSetup(const vector<std::array<int, 3>>& tvi, const vector<Vec4f>& screenSpaceVertices, const Mat& texCoords,
+			int viewportWidth, int viewportHeight, const Mat& depthBuffer, int isomapResolution, vector<ExtractionTriangle>& triangles) :
+			tvi(tvi), screenSpaceVertices(screenSpaceVertices), texCoords(texCoords), viewportWidth(viewportWidth), viewportHeight(viewportHeight),
+			depthBuffer(depthBuffer), isomapResolution(isomapResolution), triangles(triangles) {}
+
+	void operator()(const cv::Range& range) const override {
+		for (int i = range.start; i < range.end; ++i)
+			triangles[i] = setUp(tvi[i]);
+	}
 
-		Vertex v0, v1, v2; // we don't copy the color and texcoords, we only do the visibility check here.
-		// This could be optimized in 2 ways though:
-		// - Use render(), or as in render(...), transfer the vertices once, not in a loop over all triangles (vertices are getting transformed multiple times)
-		// - We transform them later (below) a second time. Only do it once.
-		v0.position = Mat(mvpMatrix * Mat(v0_3d.position));
-		v1.position = Mat(mvpMatrix * Mat(v1_3d.position));
-		v2.position = Mat(mvpMatrix * Mat(v2_3d.position));
+private:
 
-		// Well, in in principle, we'd have to do the whole stuff as in render(), like
-		// clipping against the frustums etc.
-		// But as long as our model is fully on the screen, we're fine.
+	ExtractionTriangle setUp(const std::array<int, 3>& triangleIndices) const {
+		ExtractionTriangle triangle;
+		triangle.extract = false;
+		Vertex v0, v1, v2; // we don't copy the color and texcoords, we only do the visibility check here.
+		v0.position = screenSpaceVertices[triangleIndices[0]];
+		v1.position = screenSpaceVertices[triangleIndices[1]];
+		v2.position = screenSpaceVertices[triangleIndices[2]];
+		if (!areVerticesCCWInScreenSpace(v0, v1, v2))
+			return triangle;
+		if (!depthBuffer.empty() && !isVisible(v0, v1, v2))
+			return triangle;
 
-		// divide by w
-		// if ortho, we can do the divide as well, it will just be a / 1.0f.
-		v0.position = v0.position / v0.position[3];
-		v1.position = v1.position / v1.position[3];
-		v2.position = v2.position / v2.position[3];
-
-		// Todo: This is all very similar to processProspectiveTri(...), except the other function does texturing stuff as well. Remove code duplication!
-		Vec2f v0_clip = clipToScreenSpace(Vec2f(v0.position[0], v0.position[1]), viewportWidth, viewportHeight);
-		Vec2f v1_clip = clipToScreenSpace(Vec2f(v1.position[0], v1.position[1]), viewportWidth, viewportHeight);
-		Vec2f v2_clip = clipToScreenSpace(Vec2f(v2.position[0], v2.position[1]), viewportWidth, viewportHeight);
-		v0.position[0] = v0_clip[0]; v0.position[1] = v0_clip[1];
-		v1.position[0] = v1_clip[0]; v1.position[1] = v1_clip[1];
-		v2.position[0] = v2_clip[0]; v2.position[1] = v2_clip[1];
-		
-		//if (doBackfaceCulling) {
-			if (!areVerticesCCWInScreenSpace(v0, v1, v2))
-				continue;
-		//}
+		cv::Point2f srcTri[3];
+		cv::Point2f dstTri[3];
+		for (int k = 0; k < 3; ++k) {
+			srcTri[k] = Point2f(screenSpaceVertices[triangleIndices[k]][0], screenSpaceVertices[triangleIndices[k]][1]);
+			const float* texCoord = texCoords.ptr<float>(triangleIndices[k]);
+			dstTri[k] = Point2f(isomapResolution * texCoord[0], isomapResolution * texCoord[1] - 1.0f);
+		}
+		triangle.isomapToImage = getAffineTransform(dstTri, srcTri);
+
+		triangle.minX = std::max(0, static_cast<int>(std::min(dstTri[0].x, std::min(dstTri[1].x, dstTri[2].x))));
+		triangle.maxX = std::min(isomapResolution, static_cast<int>(std::ceil(std::max(dstTri[0].x, std::max(dstTri[1].x, dstTri[2].x)))));
+		triangle.minY = std::max(0, static_cast<int>(std::min(dstTri[0].y, std::min(dstTri[1].y, dstTri[2].y))));
+		triangle.maxY = std::min(isomapResolution, static_cast<int>(std::ceil(std::max(dstTri[0].y, std::max(dstTri[1].y, dstTri[2].y)))));
+		if (triangle.minX >= triangle.maxX || triangle.minY >= triangle.maxY)
+			return triangle;
+
+		// The barycentric coordinates of MeshUtils::isPointInTriangle are linear in the point, so they
+		// can be evaluated from the pixel indices with the gradients below.
+		Point2f e0 = dstTri[2] - dstTri[0];
+		Point2f e1 = dstTri[1] - dstTri[0];
+		float dot00 = e0.dot(e0);
+		float dot01 = e0.dot(e1);
+		float dot11 = e1.dot(e1);
+		float invDenom = 1 / (dot00 * dot11 - dot01 * dot01);
+		Point2f uGradient = invDenom * (dot11 * e0 - dot01 * e1);
+		Point2f vGradient = invDenom * (dot00 * e1 - dot01 * e0);
+		Point2f start = Point2f(triangle.minX, triangle.minY) - dstTri[0];
+		triangle.u0 = uGradient.dot(start);
+		triangle.dudx = uGradient.x;
+		triangle.dudy = uGradient.y;
+		triangle.v0 = vGradient.dot(start);
+		triangle.dvdx = vGradient.x;
+		triangle.dvdy = vGradient.y;
+		triangle.extract = true;
+		return triangle;
+	}
 
+	/**
+	 * Determines whether the whole triangle is visible in the depth buffer.
+	 */
+	bool isVisible(const Vertex& v0, const Vertex& v1, const Vertex& v2) const {
 		cv::Rect bbox = calculateBoundingBox(v0, v1, v2, viewportWidth, viewportHeight);
 		int minX = bbox.x;
 		int maxX = bbox.x + bbox.width;
 		int minY = bbox.y;
 		int maxY = bbox.y + bbox.height;
-
-		//if (t.maxX <= t.minX || t.maxY <= t.minY) 	// Note: Can the width/height of the bbox be negative? Maybe we only need to check for equality here?
-		//	continue;
-
-		bool wholeTriangleIsVisible = true;
-		for (int yi = minY; yi <= maxY; yi++)
-		{
-			for (int xi = minX; xi <= maxX; xi++)
-			{
+		// these will be used for barycentric weights computation
+		double one_over_v0ToLine12 = 1.0 / implicitLine(v0.position[0], v0.position[1], v1.position, v2.position);
+		double one_over_v1ToLine20 = 1.0 / implicitLine(v1.position[0], v1.position[1], v2.position, v0.position);
+		double one_over_v2ToLine01 = 1.0 / implicitLine(v2.position[0], v2.position[1], v0.position, v1.position);
+		for (int yi = minY; yi <= maxY; yi++) {
+			const double* depthRow = depthBuffer.ptr<double>(yi);
+			for (int xi = minX; xi <= maxX; xi++) {
 				// we want centers of pixels to be used in computations. TODO: Do we?
 				float x = (float)xi + 0.5f;
 				float y = (float)yi + 0.5f;
-				// these will be used for barycentric weights computation
-				double one_over_v0ToLine12 = 1.0 / utils::implicitLine(v0.position[0], v0.position[1], v1.position, v2.position);
-				double one_over_v1ToLine20 = 1.0 / utils::implicitLine(v1.position[0], v1.position[1], v2.position, v0.position);
-				double one_over_v2ToLine01 = 1.0 / utils::implicitLine(v2.position[0], v2.position[1], v0.position, v1.position);
 				// affine barycentric weights
-				double alpha = utils::implicitLine(x, y, v1.position, v2.position) * one_over_v0ToLine12;
-				double beta = utils::implicitLine(x, y, v2.position, v0.position) * one_over_v1ToLine20;
-				double gamma = utils::implicitLine(x, y, v0.position, v1.position) * one_over_v2ToLine01;
+				double alpha = implicitLine(x, y, v1.position, v2.position) * one_over_v0ToLine12;
+				double beta = implicitLine(x, y, v2.position, v0.position) * one_over_v1ToLine20;
+				double gamma = implicitLine(x, y, v0.position, v1.position) * one_over_v2ToLine01;
 				// if pixel (x, y) is inside the triangle or on one of its edges
-				if (alpha >= 0 && beta >= 0 && gamma >= 0)
-				{
+				if (alpha >= 0 && beta >= 0 && gamma >= 0) {
 					double z_affine = alpha*(double)v0.position[2] + beta*(double)v1.position[2] + gamma*(double)v2.position[2];
-					// The '<= 1.0' clips against the far-plane in NDC. We clip against the near-plane earlier.
-					if (z_affine < depthBuffer.at<double>(yi, xi)/* && z_affine <= 1.0*/) {
-						wholeTriangleIsVisible = false;
-						break;
-					}
-					else {
-						
-					}
+					if (z_affine < depthRow[xi])
+						return false;
 				}
 			}
-			if (!wholeTriangleIsVisible) {
-				break;
-			}
 		}
+		return true;
+	}
 
-		if (!wholeTriangleIsVisible) {
-			continue;
+	const vector<std::array<int, 3>>& tvi;
+	const vector<Vec4f>& screenSpaceVertices;
+	const Mat& texCoords; ///< N x 2 CV_32FC1 texture coordinates.
+	int viewportWidth;
+	int viewportHeight;
+	const Mat& depthBuffer;
+	int isomapResolution;
+	vector<ExtractionTriangle>& triangles;
+};
+
+/**
+ * Fills bands of isomap rows with the texture of the triangles overlapping them, used with cv::parallel_for_.
+ */
+class ExtractionBody : public cv::ParallelLoopBody {
+public:
+	ExtractionBody(const vector<ExtractionTriangle>& triangles, const vector<vector<unsigned int>>& bands, int bandHeight,
+			const Mat& image, Mat& textureMap) :
+			triangles(triangles), bands(bands), bandHeight(bandHeight), image(image), textureMap(textureMap) {}
+
+	void operator()(const cv::Range& range) const override {
+		for (int band = range.start; band < range.end; ++band) {
+			int bandMinY = band * bandHeight;
+			int bandMaxY = std::min(bandMinY + bandHeight, textureMap.rows);
+			// the triangles are processed in mesh order, so a later triangle overwrites shared edge pixels as before
+			for (unsigned int triangleIndex : bands[band])
+				extract(triangles[triangleIndex], std::max(bandMinY, triangles[triangleIndex].minY), std::min(bandMaxY, triangles[triangleIndex].maxY));
 		}
+	}
 
-		cv::Point2f srcTri[3];
-		cv::Point2f dstTri[3];
-		cv::Vec4f vec(mesh.vertex[triangleIndices[0]].position[0], mesh.vertex[triangleIndices[0]].position[1], mesh.vertex[triangleIndices[0]].position[2], 1.0f);
-		cv::Vec4f res = Mat(mvpMatrix * Mat(vec));
-		res /= res[3];
-		Vec2f screenSpace = utils::clipToScreenSpace(Vec2f(res[0], res[1]), viewportWidth, viewportHeight);
-		srcTri[0] = screenSpace;
-
-		vec = cv::Vec4f(mesh.vertex[triangleIndices[1]].position[0], mesh.vertex[triangleIndices[1]].position[1], mesh.vertex[triangleIndices[1]].position[2], 1.0f);
-		res = Mat(mvpMatrix * Mat(vec));
-		res /= res[3];
-		screenSpace = utils::clipToScreenSpace(Vec2f(res[0], res[1]), viewportWidth, viewportHeight);
-		srcTri[1] = screenSpace;
-
-		vec = cv::Vec4f(mesh.vertex[triangleIndices[2]].position[0], mesh.vertex[triangleIndices[2]].position[1], mesh.vertex[triangleIndices[2]].position[2], 1.0f);
-		res = Mat(mvpMatrix * Mat(vec));
-		res /= res[3];
-		screenSpace = utils::clipToScreenSpace(Vec2f(res[0], res[1]), viewportWidth, viewportHeight);
-		srcTri[2] = screenSpace;
-
-		// ROI in the source image:
-		// Todo: Check if the triangle is on screen. If it's outside, we crash here.
-		float src_tri_min_x = std::min(srcTri[0].x, std::min(srcTri[1].x, srcTri[2].x)); // note: might be better to round later (i.e. use the float points for getAffineTransform for a more accurate warping)
-		float src_tri_max_x = std::max(srcTri[0].x, std::max(srcTri[1].x, srcTri[2].x));
-		float src_tri_min_y = std::min(srcTri[0].y, std::min(srcTri[1].y, srcTri[2].y));
-		float src_tri_max_y = std::max(srcTri[0].y, std::max(srcTri[1].y, srcTri[2].y));
-
-		Mat inputImageRoi = image.rowRange(cvFloor(src_tri_min_y), cvCeil(src_tri_max_y)).colRange(cvFloor(src_tri_min_x), cvCeil(src_tri_max_x)); // We round down and up. ROI is possibly larger. But wrong pixels get thrown away later when we check if the point is inside the triangle? Correct?
-		srcTri[0] -= Point2f(src_tri_min_x, src_tri_min_y);
-		srcTri[1] -= Point2f(src_tri_min_x, src_tri_min_y);
-		srcTri[2] -= Point2f(src_tri_min_x, src_tri_min_y); // shift all the points to correspond to the roi
-
-		dstTri[0] = cv::Point2f(textureMap.cols*mesh.vertex[triangleIndices[0]].texcrd[0], textureMap.rows*mesh.vertex[triangleIndices[0]].texcrd[1] - 1.0f);
-		dstTri[1] = cv::Point2f(textureMap.cols*mesh.vertex[triangleIndices[1]].texcrd[0], textureMap.rows*mesh.vertex[triangleIndices[1]].texcrd[1] - 1.0f);
-		dstTri[2] = cv::Point2f(textureMap.cols*mesh.vertex[triangleIndices[2]].texcrd[0], textureMap.rows*mesh.vertex[triangleIndices[2]].texcrd[1] - 1.0f);
-
-		/// Get the Affine Transform
-		Mat warp_mat = getAffineTransform(srcTri, dstTri);
-
-		/// Apply the Affine Transform just found to the src image
-		Mat tmpDstBuffer = Mat::zeros(textureMap.rows, textureMap.cols, image.type()); // I think using the source-size here is not correct. The dst might be larger. We should warp the endpoints and set to max-w/h. No, I think it would be even better to directly warp to the final textureMap size. (so that the last step is only a 1:1 copy)
-		warpAffine(inputImageRoi, tmpDstBuffer, warp_mat, tmpDstBuffer.size(), cv::INTER_CUBIC, cv::BORDER_TRANSPARENT); // last row/col is zeros, depends on interpolation method. Maybe because of rounding or interpolation? So it cuts a little. Maybe try to implement by myself?
-
-		// only copy to final img if point is inside the triangle (or on the border)
-		for (int x = std::min(dstTri[0].x, std::min(dstTri[1].x, dstTri[2].x)); x < std::max(dstTri[0].x, std::max(dstTri[1].x, dstTri[2].x)); ++x) {
-			for (int y = std::min(dstTri[0].y, std::min(dstTri[1].y, dstTri[2].y)); y < std::max(dstTri[0].y, std::max(dstTri[1].y, dstTri[2].y)); ++y) {
-				if (MeshUtils::isPointInTriangle(cv::Point2f(x, y), dstTri[0], dstTri[1], dstTri[2])) {
-					textureMap.at<cv::Vec3b>(y, x) = tmpDstBuffer.at<cv::Vec3b>(y, x);
-				}
+private:
+
+	void extract(const ExtractionTriangle& t, int minY, int maxY) const {
+		for (int y = minY; y < maxY; ++y) {
+			cv::Vec3b* textureRow = textureMap.ptr<cv::Vec3b>(y);
+			// u and v are computed from the pixel index, accumulating them would let rounding errors flip edge pixels
+			float rowU = t.u0 + (y - t.minY) * t.dudy;
+			float rowV = t.v0 + (y - t.minY) * t.dvdy;
+			float rowImageX = t.isomapToImage(0, 1) * y + t.isomapToImage(0, 2);
+			float rowImageY = t.isomapToImage(1, 1) * y + t.isomapToImage(1, 2);
+			for (int x = t.minX; x < t.maxX; ++x) {
+				float u = rowU + (x - t.minX) * t.dudx;
+				float v = rowV + (x - t.minX) * t.dvdx;
+				// only copy to final img if point is inside the triangle (or on the border)
+				if (u >= 0 && v >= 0 && u + v < 1)
+					textureRow[x] = sampleCubic(rowImageX + t.isomapToImage(0, 0) * x, rowImageY + t.isomapToImage(1, 0) * x);
 			}
 		}
 	}
+
+	/**
+	 * Samples the image with bicubic interpolation (same kernel as cv::INTER_CUBIC), replicating the border.
+	 */
+	cv::Vec3b sampleCubic(float x, float y) const {
+		int x0 = cvFloor(x);
+		int y0 = cvFloor(y);
+		float xWeights[4], yWeights[4];
+		computeCubicWeights(x - x0, xWeights);
+		computeCubicWeights(y - y0, yWeights);
+		int columns[4];
+		for (int k = 0; k < 4; ++k)
+			columns[k] = std::min(std::max(x0 - 1 + k, 0), image.cols - 1);
+		float color[3] = { 0, 0, 0 };
+		for (int j = 0; j < 4; ++j) {
+			const cv::Vec3b* imageRow = image.ptr<cv::Vec3b>(std::min(std::max(y0 - 1 + j, 0), image.rows - 1));
+			for (int k = 0; k < 4; ++k) {
+				float weight = yWeights[j] * xWeights[k];
+				const cv::Vec3b& pixel = imageRow[columns[k]];
+				color[0] += weight * pixel[0];
+				color[1] += weight * pixel[1];
+				color[2] += weight * pixel[2];
+			}
+		}
+		return cv::Vec3b(cv::saturate_cast<uchar>(color[0]), cv::saturate_cast<uchar>(color[1]), cv::saturate_cast<uchar>(color[2]));
+	}
+
+	static void computeCubicWeights(float x, float* weights) {
+		const float A = -0.75f;
+		weights[0] = ((A*(x + 1) - 5*A)*(x + 1) + 8*A)*(x + 1) - 4*A;
+		weights[1] = ((A + 2)*x - (A + 3))*x*x + 1;
+		weights[2] = ((A + 2)*(1 - x) - (A + 3))*(1 - x)*(1 - x) + 1;
+		weights[3] = 1.f - weights[0] - weights[1] - weights[2];
+	}
+
+	const vector<ExtractionTriangle>& triangles;
+	const vector<vector<unsigned int>>& bands;
+	int bandHeight;
+	const Mat& image;
+	Mat& textureMap;
+};
+
+/**
+ * Extracts the texture given the clip-space vertices, see extractTexture(...).
+ *
+ * @param[in] tvi Triangle vertex indices.
+ * @param[in] clipSpaceVertices Vertices transformed by the MVP matrix, will be transformed to screen-space.
+ * @param[in] texCoords N x 2 CV_32FC1 texture coordinates.
+ */
+static Mat extractTextureFromClipSpace(const vector<std::array<int, 3>>& tvi, vector<Vec4f>& clipSpaceVertices, const Mat& texCoords,
+		int viewportWidth, int viewportHeight, Mat image, Mat depthBuffer, int isomapResolution) {
+	if (isomapResolution <= 0)
+		throw std::invalid_argument("extractTexture: the isomap resolution must be greater than zero");
+	if (!depthBuffer.empty() && (depthBuffer.type() != CV_64FC1 || depthBuffer.rows != viewportHeight || depthBuffer.cols != viewportWidth))
+		throw std::invalid_argument("extractTexture: the depth buffer must be of type CV_64FC1 and have the size of the viewport");
+	if (texCoords.type() != CV_32FC1 || texCoords.cols != 2 || texCoords.rows != static_cast<int>(clipSpaceVertices.size()))
+		throw std::invalid_argument("extractTexture: there must be two CV_32F texture coordinates per vertex");
+	Mat bgrImage; // We don't want an alpha channel.
+	if (image.type() == CV_8UC3)
+		bgrImage = image;
+	else if (image.type() == CV_8UC1)
+		cv::cvtColor(image, bgrImage, cv::COLOR_GRAY2BGR);
+	else if (image.type() == CV_8UC4)
+		cv::cvtColor(image, bgrImage, cv::COLOR_BGRA2BGR);
+	else
+		throw std::invalid_argument("extractTexture: the image must be of type CV_8UC1, CV_8UC3 or CV_8UC4");
+	Mat textureMap = Mat::zeros(isomapResolution, isomapResolution, CV_8UC3);
+
+	// Well, in in principle, we'd have to do the whole stuff as in render(), like clipping
+	// against the frustums etc. But as long as our model is fully on the screen, we're fine.
+	for (Vec4f& position : clipSpaceVertices) {
+		// divide by w
+		// if ortho, we can do the divide as well, it will just be a / 1.0f.
+		position = position / position[3];
+		Vec2f screenSpace = clipToScreenSpace(Vec2f(position[0], position[1]), viewportWidth, viewportHeight);
+		position[0] = screenSpace[0];
+		position[1] = screenSpace[1];
+	}
+	const vector<Vec4f>& screenSpaceVertices = clipSpaceVertices;
+
+	vector<ExtractionTriangle> triangles(tvi.size());
+	cv::parallel_for_(cv::Range(0, static_cast<int>(tvi.size())),
+			ExtractionSetup(tvi, screenSpaceVertices, texCoords, viewportWidth, viewportHeight, depthBuffer, isomapResolution, triangles));
+
+	// Bin the triangles into bands of isomap rows, keeping the mesh order within each band.
+	const int bandHeight = 16;
+	vector<vector<unsigned int>> bands((isomapResolution + bandHeight - 1) / bandHeight);
+	for (unsigned int i = 0; i < triangles.size(); ++i) {
+		if (triangles[i].extract) {
+			for (int band = triangles[i].minY / bandHeight; band <= (triangles[i].maxY - 1) / bandHeight; ++band)
+				bands[band].push_back(i);
+		}
+	}
+	cv::parallel_for_(cv::Range(0, static_cast<int>(bands.size())), ExtractionBody(triangles, bands, bandHeight, bgrImage, textureMap));
 	return textureMap;
 }
 
+// image: where to extract the texture from
+// note: framebuffer should have size of the image (ok not necessarily. What about mobile?) (well it should, to get optimal quality (and everywhere the same quality)?)
+// note: mvpMatrix: Atm working with a 4x4 (full) affine. But anything would work, just take care with the w-division.
+// Regarding the depth-buffer: We could also pass an instance of a Renderer here. Depending on how "stateful" the renderer is, this might make more sense.
+Mat extractTexture(const Mesh& mesh, Mat mvpMatrix, int viewportWidth, int viewportHeight, Mat image, Mat depthBuffer, int isomapResolution) {
+	// Transform every vertex once, the same way as the SoftwareRenderer
+	const cv::Matx44f m = mvpMatrix;
+	vector<Vec4f> clipSpaceVertices(mesh.vertex.size());
+	Mat texCoords(static_cast<int>(mesh.vertex.size()), 2, CV_32FC1);
+	for (size_t i = 0; i < mesh.vertex.size(); ++i) {
+		const Vec4f& p = mesh.vertex[i].position;
+		Vec4f& position = clipSpaceVertices[i];
+		position[0] = m(0, 0) * p[0] + m(0, 1) * p[1] + m(0, 2) * p[2] + m(0, 3) * p[3];
+		position[1] = m(1, 0) * p[0] + m(1, 1) * p[1] + m(1, 2) * p[2] + m(1, 3) * p[3];
+		position[2] = m(2, 0) * p[0] + m(2, 1) * p[1] + m(2, 2) * p[2] + m(2, 3) * p[3];
+		position[3] = m(3, 0) * p[0] + m(3, 1) * p[1] + m(3, 2) * p[2] + m(3, 3) * p[3];
+		texCoords.at<float>(i, 0) = mesh.vertex[i].texcrd[0];
+		texCoords.at<float>(i, 1) = mesh.vertex[i].texcrd[1];
+	}
+	return extractTextureFromClipSpace(mesh.tvi, clipSpaceVertices, texCoords, viewportWidth, viewportHeight, image, depthBuffer, isomapResolution);
+}
+
+Mat extractTexture(const SoaMesh& mesh, Mat mvpMatrix, int viewportWidth, int viewportHeight, Mat image, Mat depthBuffer, int isomapResolution) {
+	if (mesh.positions.type() != CV_32FC1 || mesh.positions.cols != 3)
+		throw std::invalid_argument("extractTexture: the positions must be a N x 3 matrix of type CV_32FC1");
+	const cv::Matx44f m = mvpMatrix;
+	vector<Vec4f> clipSpaceVertices(mesh.getVertexCount());
+	for (int i = 0; i < mesh.getVertexCount(); ++i) {
+		const float* p = mesh.positions.ptr<float>(i);
+		Vec4f& position = clipSpaceVertices[i];
+		position[0] = m(0, 0) * p[0] + m(0, 1) * p[1] + m(0, 2) * p[2] + m(0, 3);
+		position[1] = m(1, 0) * p[0] + m(1, 1) * p[1] + m(1, 2) * p[2] + m(1, 3);
+		position[2] = m(2, 0) * p[0] + m(2, 1) * p[1] + m(2, 2) * p[2] + m(2, 3);
+		position[3] = m(3, 0) * p[0] + m(3, 1) * p[1] + m(3, 2) * p[2] + m(3, 3);
+	}
+	return extractTextureFromClipSpace(mesh.tvi, clipSpaceVertices, mesh.texcrds, viewportWidth, viewportHeight, image, depthBuffer, isomapResolution);
+}
+
 	} /* namespace utils */
 } /* namespace render */
@@ -0,0 +1,83 @@
+/*
+ * SoaMesh.cpp
+ *
+ *  Created on: 18.10.2026
+ *      Author: Patrik Huber
+ */
+
+#include "render/SoaMesh.hpp"
+
+#include <fstream>
+#include <stdexcept>
+
+using cv::Mat;
+using std::string;
+
+namespace render {
+
+Mat SoaMesh::wrap(const Mat& values, int channels)
+{
+	if (values.empty())
+		return Mat();
+	if (values.total() * values.channels() % channels != 0)
+		throw std::invalid_argument("SoaMesh: the number of values must be a multiple of the number of channels");
+	Mat floatValues = values;
+	if (values.depth() != CV_32F)
+		values.convertTo(floatValues, CV_32F);
+	else if (!values.isContinuous())
+		floatValues = values.clone();
+	int rows = static_cast<int>(floatValues.total() * floatValues.channels() / channels);
+	return floatValues.reshape(1, rows);
+}
+
+SoaMesh SoaMesh::fromMesh(const Mesh& mesh)
+{
+	SoaMesh soaMesh;
+	int vertexCount = static_cast<int>(mesh.vertex.size());
+	soaMesh.positions.create(vertexCount, 3, CV_32FC1);
+	soaMesh.colors.create(vertexCount, 3, CV_32FC1);
+	soaMesh.texcrds.create(vertexCount, 2, CV_32FC1);
+	for (int i = 0; i < vertexCount; ++i) {
+		const Vertex& v = mesh.vertex[i];
+		float* position = soaMesh.positions.ptr<float>(i);
+		float* color = soaMesh.colors.ptr<float>(i);
+		float* texcrd = soaMesh.texcrds.ptr<float>(i);
+		position[0] = v.position[0];
+		position[1] = v.position[1];
+		position[2] = v.position[2];
+		color[0] = v.color[0];
+		color[1] = v.color[1];
+		color[2] = v.color[2];
+		texcrd[0] = v.texcrd[0];
+		texcrd[1] = v.texcrd[1];
+	}
+	soaMesh.tvi = mesh.tvi;
+	soaMesh.tci = mesh.tci;
+	soaMesh.hasTexture = mesh.hasTexture;
+	soaMesh.textureName = mesh.textureName;
+	soaMesh.texture = mesh.texture;
+	return soaMesh;
+}
+
+void SoaMesh::writeObj(const SoaMesh& mesh, string filename)
+{
+	std::ofstream objFile(filename);
+
+	for (int i = 0; i < mesh.getVertexCount(); ++i) {
+		const float* position = mesh.positions.ptr<float>(i);
+		objFile << "v " << position[0] << " " << position[1] << " " << position[2];
+		if (!mesh.colors.empty()) {
+			const float* color = mesh.colors.ptr<float>(i);
+			objFile << " " << color[0] << " " << color[1] << " " << color[2] << " ";
+		}
+		objFile << std::endl;
+	}
+
+	// obj starts counting triangles at 1
+	for (const auto& v : mesh.tvi) {
+		objFile << "f " << v[0]+1 << " " << v[1]+1 << " " << v[2]+1 << std::endl;
+	}
+	objFile.close();
+}
+
+} /* namespace render */
@@ -9,6 +9,9 @@
 
 #include "render/utils.hpp"
 
+#include <cmath>
+#include <stdexcept>
+
 using cv::Mat;
 using cv::Vec4b;
 using cv::Vec2f;
@@ -21,15 +24,45 @@ using std::min;
 using std::max;
 using std::floor;
 using std::ceil;
+using std::invalid_argument;
 
 namespace render {
 
+class SoftwareRenderer::TileRasterizer : public cv::ParallelLoopBody
+{
+public:
+	TileRasterizer(SoftwareRenderer& renderer, int tilesX) : renderer(renderer), tilesX(tilesX) {}
+
+	void operator()(const cv::Range& range) const override
+	{
+		for (int i = range.start; i < range.end; ++i) {
+			int minX = (i % tilesX) * renderer.tileSize;
+			int minY = (i / tilesX) * renderer.tileSize;
+			int maxX = min(minX + renderer.tileSize, static_cast<int>(renderer.viewportWidth)) - 1;
+			int maxY = min(minY + renderer.tileSize, static_cast<int>(renderer.viewportHeight)) - 1;
+			for (unsigned int triangleIndex : renderer.tileBins[i])
+				renderer.rasterTriangle(renderer.trisToRaster[triangleIndex], minX, maxX, minY, maxY);
+		}
+	}
+
+private:
+	SoftwareRenderer& renderer;
+	int tilesX; ///< Number of tiles per row.
+};
+
 SoftwareRenderer::SoftwareRenderer(unsigned int viewportWidth, unsigned int viewportHeight) : viewportWidth(viewportWidth), viewportHeight(viewportHeight)
 {
 }
 
+void SoftwareRenderer::setTileSize(int tileSize)
+{
+	if (tileSize <= 0)
+		throw invalid_argument("SoftwareRenderer: the tile size must be greater than zero");
+	this->tileSize = tileSize;
+}
+
 #ifdef WITH_RENDER_QOPENGL
-pair<Mat, Mat> SoftwareRenderer::render(Mesh mesh, QMatrix4x4 mvp)
+pair<Mat, Mat> SoftwareRenderer::render(const Mesh& mesh, QMatrix4x4 mvp)
 {
 	// We assign the values one-by-one since if we used
 	// mvp.data() or something, we'd have to transpose
@@ -43,61 +76,137 @@ pair<Mat, Mat> SoftwareRenderer::render(Mesh mesh, QMatrix4x4 mvp)
 }
 #endif
 
-pair<Mat, Mat> SoftwareRenderer::render(Mesh mesh, Mat mvp)
+pair<Mat, Mat> SoftwareRenderer::render(const Mesh& mesh, Mat mvp)
 {
-	colorBuffer = Mat::zeros(viewportHeight, viewportWidth, CV_8UC4);
-	depthBuffer = Mat::ones(viewportHeight, viewportWidth, CV_64FC1) * 1000000;
+	// Vertex shader:
+	//processedVertex = shade(Vertex); // processedVertex : pos, col, tex, texweight
+	// The products are summed up in single precision and in the same order as cv::gemm does for
+	// a 4x4 float matrix, so the clip-space positions are the same as with mvp * Mat(v.position).
+	const cv::Matx44f m = mvp;
+	clipSpaceVertices.resize(mesh.vertex.size());
+	for (size_t i = 0; i < mesh.vertex.size(); ++i) {
+		const Vertex& v = mesh.vertex[i];
+		const Vec4f& p = v.position;
+		Vertex& clipSpaceVertex = clipSpaceVertices[i];
+		clipSpaceVertex.position[0] = m(0, 0) * p[0] + m(0, 1) * p[1] + m(0, 2) * p[2] + m(0, 3) * p[3];
+		clipSpaceVertex.position[1] = m(1, 0) * p[0] + m(1, 1) * p[1] + m(1, 2) * p[2] + m(1, 3) * p[3];
+		clipSpaceVertex.position[2] = m(2, 0) * p[0] + m(2, 1) * p[1] + m(2, 2) * p[2] + m(2, 3) * p[3];
+		clipSpaceVertex.position[3] = m(3, 0) * p[0] + m(3, 1) * p[1] + m(3, 2) * p[2] + m(3, 3) * p[3];
+		clipSpaceVertex.color = v.color;
+		clipSpaceVertex.texcrd = v.texcrd;
+	}
+	return renderClipSpaceVertices(mesh.tvi);
+}
+
+pair<Mat, Mat> SoftwareRenderer::render(const SoaMesh& mesh, Mat mvp)
+{
+	if (mesh.positions.type() != CV_32FC1 || mesh.positions.cols != 3)
+		throw invalid_argument("SoftwareRenderer: the positions must be a N x 3 matrix of type CV_32FC1");
+	if (!mesh.colors.empty() && (mesh.colors.type() != CV_32FC1 || mesh.colors.cols != 3 || mesh.colors.rows != mesh.positions.rows))
+		throw invalid_argument("SoftwareRenderer: the colors must be a N x 3 matrix of type CV_32FC1");
+	if (!mesh.texcrds.empty() && (mesh.texcrds.type() != CV_32FC1 || mesh.texcrds.cols != 2 || mesh.texcrds.rows != mesh.positions.rows))
+		throw invalid_argument("SoftwareRenderer: the texture coordinates must be a N x 2 matrix of type CV_32FC1");
+	// Vertex shader, same as above with a homogeneous coordinate of 1:
+	const cv::Matx44f m = mvp;
+	clipSpaceVertices.resize(mesh.getVertexCount());
+	for (int i = 0; i < mesh.getVertexCount(); ++i) {
+		const float* p = mesh.positions.ptr<float>(i);
+		Vertex& clipSpaceVertex = clipSpaceVertices[i];
+		clipSpaceVertex.position[0] = m(0, 0) * p[0] + m(0, 1) * p[1] + m(0, 2) * p[2] + m(0, 3);
+		clipSpaceVertex.position[1] = m(1, 0) * p[0] + m(1, 1) * p[1] + m(1, 2) * p[2] + m(1, 3);
+		clipSpaceVertex.position[2] = m(2, 0) * p[0] + m(2, 1) * p[1] + m(2, 2) * p[2] + m(2, 3);
+		clipSpaceVertex.position[3] = m(3, 0) * p[0] + m(3, 1) * p[1] + m(3, 2) * p[2] + m(3, 3);
+		if (mesh.colors.empty())
+			clipSpaceVertex.color = Vec3f(0, 0, 0);
+		else
+			clipSpaceVertex.color = Vec3f(mesh.colors.ptr<float>(i));
+		if (mesh.texcrds.empty())
+			clipSpaceVertex.texcrd = Vec2f(0, 0);
+		else
+			clipSpaceVertex.texcrd = Vec2f(mesh.texcrds.ptr<float>(i));
+	}
+	return renderClipSpaceVertices(mesh.tvi);
+}
+
+pair<Mat, Mat> SoftwareRenderer::renderClipSpaceVertices(const vector<std::array<int, 3>>& tvi)
+{
+	// create() only re-allocates if the viewport size changed
+	colorBuffer.create(viewportHeight, viewportWidth, CV_8UC4);
+	depthBuffer.create(viewportHeight, viewportWidth, CV_64FC1);
+	colorBuffer.setTo(cv::Scalar::all(0));
+	depthBuffer.setTo(cv::Scalar::all(1000000));
 	//depthBuffer = Mat::ones(viewportHeight, viewportWidth, CV_64FC1) * -0.88;
 
-	vector<TriangleToRasterize> trisToRaster;
+	cullAndClipTriangles(tvi);
 
-	// Vertex shader:
-	//processedVertex = shade(Vertex); // processedVertex : pos, col, tex, texweight
-	vector<Vertex> clipSpaceVertices;
-	for (const auto& v : mesh.vertex) {
-		Mat mpnew = mvp * Mat(v.position);
-		clipSpaceVertices.push_back(Vertex(mpnew, v.color, v.texcrd));
+	// runPixelProcessor:
+	// Fragment shader: Color the pixel values
+	if (doTiledRasterization) {
+		rasterTiles();
+	} else {
+		for (const auto& tri : trisToRaster) {
+			rasterTriangle(tri, 0, viewportWidth - 1, 0, viewportHeight - 1);
+		}
 	}
+	return make_pair(colorBuffer, depthBuffer);
+}
+
+void SoftwareRenderer::cullAndClipTriangles(const vector<std::array<int, 3>>& tvi)
+{
+	trisToRaster.clear();
+	cullingStatistics = CullingStatistics();
+	cullingStatistics.numTriangles = static_cast<int>(tvi.size());
 
 	// We're in clip-space now
-	// PREPARE rasterizer:
-	// processProspectiveTriangleToRasterize:
-	// for every vertex/tri:
-	for (const auto& triIndices : mesh.tvi) {
-		// Todo: Split this whole stuff up. Make a "clip" function, ... rename "processProspective..".. what is "process"... get rid of "continue;"-stuff by moving stuff inside process...
-		// classify vertices visibility with respect to the planes of the view frustum
-		// we're in clip-coords (NDC), so just check if outside [-1, 1] x ...
-		// Actually we're in clip-coords and it's not the same as NDC. We're only in NDC after the division by w.
-		// We should do the clipping in clip-coords though. See http://www.songho.ca/opengl/gl_projectionmatrix.html for more details.
-		// However, when comparing against w_c below, we might run into the trouble of the sign again in the affine case.
-		unsigned char visibilityBits[3];
-		for (unsigned char k = 0; k < 3; k++)
-		{
-			visibilityBits[k] = 0;
-			float xOverW = clipSpaceVertices[triIndices[k]].position[0] / clipSpaceVertices[triIndices[k]].position[3];
-			float yOverW = clipSpaceVertices[triIndices[k]].position[1] / clipSpaceVertices[triIndices[k]].position[3];
-			float zOverW = clipSpaceVertices[triIndices[k]].position[2] / clipSpaceVertices[triIndices[k]].position[3];
-			if (xOverW < -1)			// true if outside of view frustum
-				visibilityBits[k] |= 1;	// set bit if outside of frustum
-			if (xOverW > 1)
-				visibilityBits[k] |= 2;
-			if (yOverW < -1)
-				visibilityBits[k] |= 4;
-			if (yOverW > 1)
-				visibilityBits[k] |= 8;
-			//if (zOverW < -1) // these 4 lines somehow only clip against the back-plane of the frustum?
-				//visibilityBits[k] |= 16;
-			//if (zOverW > 1)
-				//visibilityBits[k] |= 32;
-		} // if all bits are 0, then it's inside the frustum
+	// Classify every vertex once (and not once per triangle it belongs to) with respect to the planes of the view frustum.
+	// We're in clip-coords (NDC), so just check if outside [-1, 1] x ...
+	// Actually we're in clip-coords and it's not the same as NDC. We're only in NDC after the division by w.
+	// We should do the clipping in clip-coords though. See http://www.songho.ca/opengl/gl_projectionmatrix.html for more details.
+	// However, when comparing against w_c below, we might run into the trouble of the sign again in the affine case.
+	vertexOutcodes.resize(clipSpaceVertices.size());
+	screenSpacePositions.resize(clipSpaceVertices.size());
+	for (size_t i = 0; i < clipSpaceVertices.size(); ++i) {
+		const Vec4f& position = clipSpaceVertices[i].position;
+		float xOverW = position[0] / position[3];
+		float yOverW = position[1] / position[3];
+		// Set a bit for every plane the vertex is outside of. If all bits are 0, it's inside the frustum.
+		// (Checking z against the near- and far-plane here somehow only clips against the back-plane of the frustum.)
+		vertexOutcodes[i] = (xOverW < -1 ? 1 : 0) | (xOverW > 1 ? 2 : 0) | (yOverW < -1 ? 4 : 0) | (yOverW > 1 ? 8 : 0);
+		// The same operations as in processProspectiveTri(...), so the back-face test below gives the same result:
+		Vec4f ndc = position / position[3];
+		screenSpacePositions[i][0] = (ndc[0] + 1) * (viewportWidth / 2.0f);
+		screenSpacePositions[i][1] = viewportHeight - (ndc[1] + 1) * (viewportHeight / 2.0f);
+	}
+
+	Vertex polygon[3];
+	Vertex clippedPolygon[4]; // clipping a triangle against one plane results in at most 4 vertices
+	for (const auto& triIndices : tvi) {
+		unsigned char outcode0 = vertexOutcodes[triIndices[0]];
+		unsigned char outcode1 = vertexOutcodes[triIndices[1]];
+		unsigned char outcode2 = vertexOutcodes[triIndices[2]];
 		// all vertices are not visible - reject the triangle.
-		if ((visibilityBits[0] & visibilityBits[1] & visibilityBits[2]) > 0)
+		if ((outcode0 & outcode1 & outcode2) > 0)
 		{
+			++cullingStatistics.numOutside;
 			continue;
 		}
 		// all vertices are visible - pass the whole triangle to the rasterizer. = All bits of all 3 triangles are 0.
-		if ((visibilityBits[0] | visibilityBits[1] | visibilityBits[2]) == 0)
+		if ((outcode0 | outcode1 | outcode2) == 0)
 		{
+			// Reject back-facing triangles before anything gets copied, see utils::areVerticesCCWInScreenSpace(...)
+			if (doBackfaceCulling) {
+				const Vec2f& s0 = screenSpacePositions[triIndices[0]];
+				const Vec2f& s1 = screenSpacePositions[triIndices[1]];
+				const Vec2f& s2 = screenSpacePositions[triIndices[2]];
+				float dx01 = s1[0] - s0[0];
+				float dy01 = s1[1] - s0[1];
+				float dx02 = s2[0] - s0[0];
+				float dy02 = s2[1] - s0[1];
+				if (!(dx01*dy02 - dy01*dx02 < 0.0f)) {
+					++cullingStatistics.numBackfacing;
+					continue;
+				}
+			}
 			boost::optional<TriangleToRasterize> t = processProspectiveTri(clipSpaceVertices[triIndices[0]], clipSpaceVertices[triIndices[1]], clipSpaceVertices[triIndices[2]]);
 			if (t) {
 				trisToRaster.push_back(*t);
@@ -105,18 +214,12 @@ pair<Mat, Mat> SoftwareRenderer::render(Mesh mesh, Mat mvp)
 			continue;
 		}
 		// at this moment the triangle is known to be intersecting one of the view frustum's planes
-		vector<Vertex> vertices;
-		vertices.push_back(clipSpaceVertices[triIndices[0]]);
-		vertices.push_back(clipSpaceVertices[triIndices[1]]);
-		vertices.push_back(clipSpaceVertices[triIndices[2]]);
+		++cullingStatistics.numClipped;
+		polygon[0] = clipSpaceVertices[triIndices[0]];
+		polygon[1] = clipSpaceVertices[triIndices[1]];
+		polygon[2] = clipSpaceVertices[triIndices[2]];
 		// split the tri etc... then pass to to the rasterizer.
-		//vertices = clipPolygonToPlaneIn4D(vertices, Vec4f(0.0f, 0.0f, -1.0f, -1.0f));	// This is the near-plane, right? Because we only have to check against that. For tlbr planes of the frustum, we can just draw, and then clamp it because it's outside the screen
-		vertices = clipPolygonToPlaneIn4D(vertices, Vec4f(0.0f, 0.0f, 1.0f, -1.0f));	// This is the near-plane, right? Because we only have to check against that. For tlbr planes of the frustum, we can just draw, and then clamp it because it's outside the screen
-		//	vertices = clipPolygonToPlaneIn4D(vertices, vec4(0.0f, 0.0f, 1.0f, -1.0f));
-		//	vertices = clipPolygonToPlaneIn4D(vertices, vec4(-1.0f, 0.0f, 0.0f, -1.0f));
-		//	vertices = clipPolygonToPlaneIn4D(vertices, vec4(1.0f, 0.0f, 0.0f, -1.0f));
-		//	vertices = clipPolygonToPlaneIn4D(vertices, vec4(0.0f, -1.0f, 0.0f, -1.0f));
-		//	vertices = clipPolygonToPlaneIn4D(vertices, vec4(0.0f, 1.0f, 0.0f, -1.0f));
+		int numClippedVertices = clipPolygonToPlaneIn4D(polygon, 3, Vec4f(0.0f, 0.0f, 1.0f, -1.0f), clippedPolygon);	// This is the near-plane, right? Because we only have to check against that. For tlbr planes of the frustum, we can just draw, and then clamp it because it's outside the screen
 		/* Note from mail: (note: stuff might flip because we change z/P-matrix?)
 		vertices = clipPolygonToPlaneIn4D(vertices, Vec4f(0.0f, 0.0f, -1.0f, -1.0f));
 		PH: That vector should be the normal of the NEAR-plane of the frustum, right? Because we only have to check if the triangle intersects the near plane. (?) and the rest we should be able to just clamp.
@@ -125,25 +228,34 @@ pair<Mat, Mat> SoftwareRenderer::render(Mesh mesh, Mat mvp)
 		*/
 
 		// triangulation of the polygon formed of vertices array
-		if (vertices.size() >= 3)
+		for (int k = 0; k < numClippedVertices - 2; k++)
 		{
-			for (unsigned char k = 0; k < vertices.size() - 2; k++)
-			{
-				boost::optional<TriangleToRasterize> t = processProspectiveTri(vertices[0], vertices[1 + k], vertices[2 + k]);
-				if (t) {
-					trisToRaster.push_back(*t);
-				}
+			boost::optional<TriangleToRasterize> t = processProspectiveTri(clippedPolygon[0], clippedPolygon[1 + k], clippedPolygon[2 + k]);
+			if (t) {
+				trisToRaster.push_back(*t);
 			}
 		}
 	}
+	cullingStatistics.numRasterized = static_cast<int>(trisToRaster.size());
+}
 
-	// runPixelProcessor:
-	// Fragment shader: Color the pixel values
-	// for every tri:
-	for (const auto& tri : trisToRaster) {
-		rasterTriangle(tri);
+void SoftwareRenderer::rasterTiles()
+{
+	// Bin the triangles by their bounding boxes. The triangles of each bin stay in mesh order, so every pixel
+	// sees the same sequence of depth tests as with serial rasterization and the output is identical.
+	int tilesX = (viewportWidth + tileSize - 1) / tileSize;
+	int tilesY = (viewportHeight + tileSize - 1) / tileSize;
+	tileBins.resize(tilesX * tilesY);
+	for (auto& bin : tileBins)
+		bin.clear();
+	for (unsigned int i = 0; i < trisToRaster.size(); ++i) {
+		const TriangleToRasterize& t = trisToRaster[i];
+		for (int tileY = t.minY / tileSize; tileY <= t.maxY / tileSize; ++tileY) {
+			for (int tileX = t.minX / tileSize; tileX <= t.maxX / tileSize; ++tileX)
+				tileBins[tileY * tilesX + tileX].push_back(i);
+		}
 	}
-	return make_pair(colorBuffer, depthBuffer);
+	cv::parallel_for_(cv::Range(0, tilesX * tilesY), TileRasterizer(*this, tilesX));
 }
 
 boost::optional<TriangleToRasterize> SoftwareRenderer::processProspectiveTri(Vertex v0, Vertex v1, Vertex v2)
@@ -226,35 +338,36 @@ boost::optional<TriangleToRasterize> SoftwareRenderer::processProspectiveTri(Ver
 	return boost::optional<TriangleToRasterize>(t);
 }
 
-void SoftwareRenderer::rasterTriangle(TriangleToRasterize triangle)
+void SoftwareRenderer::rasterTriangle(const TriangleToRasterize& triangle, int minX, int maxX, int minY, int maxY)
 {
-	TriangleToRasterize t = triangle; // remove this, use 'triangle'
-	for (int yi = t.minY; yi <= t.maxY; yi++)
+	const TriangleToRasterize& t = triangle;
+	// these will be used for barycentric weights computation, they are the same for every pixel
+	const double one_over_v0ToLine12 = 1.0 / utils::implicitLine(t.v0.position[0], t.v0.position[1], t.v1.position, t.v2.position);
+	const double one_over_v1ToLine20 = 1.0 / utils::implicitLine(t.v1.position[0], t.v1.position[1], t.v2.position, t.v0.position);
+	const double one_over_v2ToLine01 = 1.0 / utils::implicitLine(t.v2.position[0], t.v2.position[1], t.v0.position, t.v1.position);
+	const int endY = min(t.maxY, maxY);
+	const int endX = min(t.maxX, maxX);
+	for (int yi = max(t.minY, minY); yi <= endY; yi++)
 	{
-		for (int xi = t.minX; xi <= t.maxX; xi++)
+		Vec4b* colorRow = colorBuffer.ptr<Vec4b>(yi);
+		double* depthRow = depthBuffer.ptr<double>(yi);
+		for (int xi = max(t.minX, minX); xi <= endX; xi++)
 		{
 			// we want centers of pixels to be used in computations. TODO: Do we?
 			float x = (float)xi + 0.5f;
 			float y = (float)yi + 0.5f;
 
-			// these will be used for barycentric weights computation
-			t.one_over_v0ToLine12 = 1.0 / utils::implicitLine(t.v0.position[0], t.v0.position[1], t.v1.position, t.v2.position);
-			t.one_over_v1ToLine20 = 1.0 / utils::implicitLine(t.v1.position[0], t.v1.position[1], t.v2.position, t.v0.position);
-			t.one_over_v2ToLine01 = 1.0 / utils::implicitLine(t.v2.position[0], t.v2.position[1], t.v0.position, t.v1.position);
 			// affine barycentric weights
-			double alpha = utils::implicitLine(x, y, t.v1.position, t.v2.position) * t.one_over_v0ToLine12;
-			double beta = utils::implicitLine(x, y, t.v2.position, t.v0.position) * t.one_over_v1ToLine20;
-			double gamma = utils::implicitLine(x, y, t.v0.position, t.v1.position) * t.one_over_v2ToLine01;
+			double alpha = utils::implicitLine(x, y, t.v1.position, t.v2.position) * one_over_v0ToLine12;
+			double beta = utils::implicitLine(x, y, t.v2.position, t.v0.position) * one_over_v1ToLine20;
+			double gamma = utils::implicitLine(x, y, t.v0.position, t.v1.position) * one_over_v2ToLine01;
 
 			// if pixel (x, y) is inside the triangle or on one of its edges
 			if (alpha >= 0 && beta >= 0 && gamma >= 0)
 			{
-				int pixelIndexRow = yi;
-				int pixelIndexCol = xi;
-
 				double z_affine = alpha*(double)t.v0.position[2] + beta*(double)t.v1.position[2] + gamma*(double)t.v2.position[2];
 				// The '<= 1.0' clips against the far-plane in NDC. We clip against the near-plane earlier.
-				if (z_affine < depthBuffer.at<double>(pixelIndexRow, pixelIndexCol)/* && z_affine <= 1.0*/)
+				if (z_affine < depthRow[xi]/* && z_affine <= 1.0*/)
 				{
 					// perspective-correct barycentric weights
 					double d = alpha*t.one_over_z0 + beta*t.one_over_z1 + gamma*t.one_over_z2;
@@ -275,12 +388,12 @@ void SoftwareRenderer::rasterTriangle(TriangleToRasterize triangle)
 						float u_over_z = -(t.alphaPlane.a*x + t.alphaPlane.b*y + t.alphaPlane.d) * t.one_over_alpha_c;
 						float v_over_z = -(t.betaPlane.a*x + t.betaPlane.b*y + t.betaPlane.d) * t.one_over_beta_c;
 						float one_over_z = -(t.gammaPlane.a*x + t.gammaPlane.b*y + t.gammaPlane.d) * t.one_over_gamma_c;
-						float one_over_squared_one_over_z = 1.0f / pow(one_over_z, 2);
+						float one_over_squared_one_over_z = 1.0f / (one_over_z * one_over_z);
 
-						dudx = one_over_squared_one_over_z * (t.alpha_ffx * one_over_z - u_over_z * t.gamma_ffx);
-						dudy = one_over_squared_one_over_z * (t.beta_ffx * one_over_z - v_over_z * t.gamma_ffx);
-						dvdx = one_over_squared_one_over_z * (t.alpha_ffy * one_over_z - u_over_z * t.gamma_ffy);
-						dvdy = one_over_squared_one_over_z * (t.beta_ffy * one_over_z - v_over_z * t.gamma_ffy);
+						float dudx = one_over_squared_one_over_z * (t.alpha_ffx * one_over_z - u_over_z * t.gamma_ffx);
+						float dudy = one_over_squared_one_over_z * (t.beta_ffx * one_over_z - v_over_z * t.gamma_ffx);
+						float dvdx = one_over_squared_one_over_z * (t.alpha_ffy * one_over_z - u_over_z * t.gamma_ffy);
+						float dvdy = one_over_squared_one_over_z * (t.beta_ffy * one_over_z - v_over_z * t.gamma_ffy);
 
 						dudx *= currentTexture->mipmaps[0].cols;
 						dudy *= currentTexture->mipmaps[0].cols;
@@ -288,7 +401,7 @@ void SoftwareRenderer::rasterTriangle(TriangleToRasterize triangle)
 						dvdy *= currentTexture->mipmaps[0].rows;
 
 						// The Texture is in BGR, thus tex2D returns BGR
-						Vec3f textureColor = tex2D(texCoord_persp); // uses the current texture
+						Vec3f textureColor = tex2D(texCoord_persp, dudx, dudy, dvdx, dvdy); // uses the current texture
 						pixelColor = Vec3f(textureColor[2], textureColor[1], textureColor[0]);
 						// other: color.mul(tex2D(texture, texCoord));
 						// Old note: for texturing, we load the texture as BGRA, so the colors get the wrong way in the next few lines...
@@ -304,29 +417,29 @@ void SoftwareRenderer::rasterTriangle(TriangleToRasterize triangle)
 					unsigned char blue = (unsigned char)(255.0f * min(pixelColor[2], 1.0f));
 
 					// update buffers
-					colorBuffer.at<Vec4b>(pixelIndexRow, pixelIndexCol)[0] = blue;
-					colorBuffer.at<Vec4b>(pixelIndexRow, pixelIndexCol)[1] = green;
-					colorBuffer.at<Vec4b>(pixelIndexRow, pixelIndexCol)[2] = red;
-					colorBuffer.at<Vec4b>(pixelIndexRow, pixelIndexCol)[3] = 255; // alpha, or 1.0f?
-					depthBuffer.at<double>(pixelIndexRow, pixelIndexCol) = z_affine;
+					colorRow[xi][0] = blue;
+					colorRow[xi][1] = green;
+					colorRow[xi][2] = red;
+					colorRow[xi][3] = 255; // alpha, or 1.0f?
+					depthRow[xi] = z_affine;
 				}
 			}
 		}
 	}
 }
 
-std::vector<Vertex> SoftwareRenderer::clipPolygonToPlaneIn4D(const std::vector<Vertex>& vertices, const Vec4f& planeNormal)
+int SoftwareRenderer::clipPolygonToPlaneIn4D(const Vertex* vertices, int numVertices, const Vec4f& planeNormal, Vertex* clippedVertices) const
 {
-	std::vector<Vertex> clippedVertices;
+	int numClippedVertices = 0;
 
 	// We can have 2 cases:
 	//	* 1 vertex visible: we make 1 new triangle out of the visible vertex plus the 2 intersection points with the near-plane
 	//  * 2 vertices visible: we have a quad, so we have to make 2 new triangles out of it.
 
-	for (unsigned int i = 0; i < vertices.size(); i++)
+	for (int i = 0; i < numVertices; i++)
 	{
 		int a = i;
-		int b = (i + 1) % vertices.size();
+		int b = (i + 1) % numVertices;
 
 		float fa = vertices[a].position.dot(planeNormal);
 		float fb = vertices[b].position.dot(planeNormal);
@@ -342,35 +455,38 @@ std::vector<Vertex> SoftwareRenderer::clipPolygonToPlaneIn4D(const std::vector<V
 
 			if (fa < 0)
 			{
-				clippedVertices.push_back(vertices[a]);
-				clippedVertices.push_back(Vertex(position, color, texCoord));
+				clippedVertices[numClippedVertices++] = vertices[a];
+				clippedVertices[numClippedVertices++] = Vertex(position, color, texCoord);
 			}
 			else if (fb < 0)
 			{
-				clippedVertices.push_back(Vertex(position, color, texCoord));
+				clippedVertices[numClippedVertices++] = Vertex(position, color, texCoord);
 			}
 		}
 		else if (fa < 0 && fb < 0)
 		{
-			clippedVertices.push_back(vertices[a]);
+			clippedVertices[numClippedVertices++] = vertices[a];
 		}
 	}
 
-	return clippedVertices;
+	return numClippedVertices;
 }
 
-Vec3f SoftwareRenderer::tex2D(const Vec2f& texCoord)
+Vec3f SoftwareRenderer::tex2D(const Vec2f& texCoord, float dudx, float dudy, float dvdx, float dvdy) const
 {
-	return (1.0f / 255.0f) * tex2D_linear_mipmap_linear(texCoord);
+	return (1.0f / 255.0f) * tex2D_linear_mipmap_linear(texCoord, dudx, dudy, dvdx, dvdy);
 }
 
-Vec3f SoftwareRenderer::tex2D_linear_mipmap_linear(const Vec2f& texCoord)
+Vec3f SoftwareRenderer::tex2D_linear_mipmap_linear(const Vec2f& texCoord, float dudx, float dudy, float dvdx, float dvdy) const
 {
-	float px = std::sqrt(std::pow(dudx, 2) + std::pow(dvdx, 2));
-	float py = std::sqrt(std::pow(dudy, 2) + std::pow(dvdy, 2));
-	float lambda = std::log(max(px, py)) / CV_LOG2;
-	unsigned char mipmapIndex1 = clamp((int)lambda, 0.0f, max(currentTexture->widthLog, currentTexture->heightLog) - 1);
-	unsigned char mipmapIndex2 = mipmapIndex1 + 1;
+	float px = std::sqrt(dudx * dudx + dvdx * dvdx);
+	float py = std::sqrt(dudy * dudy + dvdy * dvdy);
+	float lambda = std::log2(max(px, py));
+	// The level of detail, clamped to the available mip-levels. Written like this, it is 0 for a NaN or -inf lambda too.
+	int lastMipmapIndex = static_cast<int>(currentTexture->mipmaps.size()) - 1;
+	float level = lambda > 0.0f ? min(lambda, static_cast<float>(lastMipmapIndex)) : 0.0f;
+	unsigned char mipmapIndex1 = static_cast<unsigned char>(level);
+	unsigned char mipmapIndex2 = static_cast<unsigned char>(min(mipmapIndex1 + 1, lastMipmapIndex));
 
 	Vec2f imageTexCoord = texCoord_wrap(texCoord);
 	Vec2f imageTexCoord1 = imageTexCoord;
@@ -382,21 +498,25 @@ Vec3f SoftwareRenderer::tex2D_linear_mipmap_linear(const Vec2f& texCoord)
 
 	Vec3f color, color1, color2;
 	color1 = tex2D_linear(imageTexCoord1, mipmapIndex1);
+	float lambdaFrac = level - mipmapIndex1;
+	if (lambdaFrac == 0.0f) {
+		return color1; // the second level doesn't contribute
+	}
 	color2 = tex2D_linear(imageTexCoord2, mipmapIndex2);
-	float lambdaFrac = max(lambda, 0.0f);
-	lambdaFrac = lambdaFrac - (int)lambdaFrac;
 	color = (1.0f - lambdaFrac)*color1 + lambdaFrac*color2;
 
 	return color;
 }
 
-Vec2f SoftwareRenderer::texCoord_wrap(const Vec2f& texCoord)
+Vec2f SoftwareRenderer::texCoord_wrap(const Vec2f& texCoord) const
 {
-	return Vec2f(texCoord[0] - (int)texCoord[0], texCoord[1] - (int)texCoord[1]);
+	// floor instead of truncation, so that negative coordinates are wrapped to [0, 1) as well
+	return Vec2f(texCoord[0] - floor(texCoord[0]), texCoord[1] - floor(texCoord[1]));
 }
 
-Vec3f SoftwareRenderer::tex2D_linear(const Vec2f& imageTexCoord, unsigned char mipmapIndex)
+Vec3f SoftwareRenderer::tex2D_linear(const Vec2f& imageTexCoord, unsigned char mipmapIndex) const
 {
+	const Mat& mipmap = currentTexture->mipmaps[mipmapIndex];
 	int x = (int)imageTexCoord[0];
 	int y = (int)imageTexCoord[1];
 	float alpha = imageTexCoord[0] - x;
@@ -407,43 +527,28 @@ Vec3f SoftwareRenderer::tex2D_linear(const Vec2f& imageTexCoord, unsigned char m
 	float b = alpha * oneMinusBeta;
 	float c = oneMinusAlpha * beta;
 	float d = alpha * beta;
-	Vec3f color;
 
-	//int pixelIndex;
-	//pixelIndex = getPixelIndex_wrap(x, y, texture->mipmaps[mipmapIndex].cols, texture->mipmaps[mipmapIndex].rows);
-	int pixelIndexCol = x; if (pixelIndexCol == currentTexture->mipmaps[mipmapIndex].cols) { pixelIndexCol = 0; }
-	int pixelIndexRow = y; if (pixelIndexRow == currentTexture->mipmaps[mipmapIndex].rows) { pixelIndexRow = 0; }
-	//std::cout << texture->mipmaps[mipmapIndex].cols << " " << texture->mipmaps[mipmapIndex].rows << " " << texture->mipmaps[mipmapIndex].channels() << std::endl;
-	//cv::imwrite("mm.png", texture->mipmaps[mipmapIndex]);
-	color[0] = a * currentTexture->mipmaps[mipmapIndex].at<Vec4b>(pixelIndexRow, pixelIndexCol)[0];
-	color[1] = a * currentTexture->mipmaps[mipmapIndex].at<Vec4b>(pixelIndexRow, pixelIndexCol)[1];
-	color[2] = a * currentTexture->mipmaps[mipmapIndex].at<Vec4b>(pixelIndexRow, pixelIndexCol)[2];
-
-	//pixelIndex = getPixelIndex_wrap(x + 1, y, texture->mipmaps[mipmapIndex].cols, texture->mipmaps[mipmapIndex].rows);
-	pixelIndexCol = x + 1; if (pixelIndexCol == currentTexture->mipmaps[mipmapIndex].cols) { pixelIndexCol = 0; }
-	pixelIndexRow = y; if (pixelIndexRow == currentTexture->mipmaps[mipmapIndex].rows) { pixelIndexRow = 0; }
-	color[0] += b * currentTexture->mipmaps[mipmapIndex].at<Vec4b>(pixelIndexRow, pixelIndexCol)[0];
-	color[1] += b * currentTexture->mipmaps[mipmapIndex].at<Vec4b>(pixelIndexRow, pixelIndexCol)[1];
-	color[2] += b * currentTexture->mipmaps[mipmapIndex].at<Vec4b>(pixelIndexRow, pixelIndexCol)[2];
-
-	//pixelIndex = getPixelIndex_wrap(x, y + 1, texture->mipmaps[mipmapIndex].cols, texture->mipmaps[mipmapIndex].rows);
-	pixelIndexCol = x; if (pixelIndexCol == currentTexture->mipmaps[mipmapIndex].cols) { pixelIndexCol = 0; }
-	pixelIndexRow = y + 1; if (pixelIndexRow == currentTexture->mipmaps[mipmapIndex].rows) { pixelIndexRow = 0; }
-	color[0] += c * currentTexture->mipmaps[mipmapIndex].at<Vec4b>(pixelIndexRow, pixelIndexCol)[0];
-	color[1] += c * currentTexture->mipmaps[mipmapIndex].at<Vec4b>(pixelIndexRow, pixelIndexCol)[1];
-	color[2] += c * currentTexture->mipmaps[mipmapIndex].at<Vec4b>(pixelIndexRow, pixelIndexCol)[2];
-
-	//pixelIndex = getPixelIndex_wrap(x + 1, y + 1, texture->mipmaps[mipmapIndex].cols, texture->mipmaps[mipmapIndex].rows);
-	pixelIndexCol = x + 1; if (pixelIndexCol == currentTexture->mipmaps[mipmapIndex].cols) { pixelIndexCol = 0; }
-	pixelIndexRow = y + 1; if (pixelIndexRow == currentTexture->mipmaps[mipmapIndex].rows) { pixelIndexRow = 0; }
-	color[0] += d * currentTexture->mipmaps[mipmapIndex].at<Vec4b>(pixelIndexRow, pixelIndexCol)[0];
-	color[1] += d * currentTexture->mipmaps[mipmapIndex].at<Vec4b>(pixelIndexRow, pixelIndexCol)[1];
-	color[2] += d * currentTexture->mipmaps[mipmapIndex].at<Vec4b>(pixelIndexRow, pixelIndexCol)[2];
+	// The texture coordinates are wrapped to [0, 1), only the right and bottom neighbours can lie outside:
+	int x0 = (x >= mipmap.cols) ? 0 : x;
+	int y0 = (y >= mipmap.rows) ? 0 : y;
+	int x1 = (x0 + 1 == mipmap.cols) ? 0 : x0 + 1;
+	int y1 = (y0 + 1 == mipmap.rows) ? 0 : y0 + 1;
+	const Vec4b* row0 = mipmap.ptr<Vec4b>(y0);
+	const Vec4b* row1 = mipmap.ptr<Vec4b>(y1);
+	const Vec4b& texel00 = row0[x0];
+	const Vec4b& texel10 = row0[x1];
+	const Vec4b& texel01 = row1[x0];
+	const Vec4b& texel11 = row1[x1];
+
+	Vec3f color;
+	color[0] = a * texel00[0] + b * texel10[0] + c * texel01[0] + d * texel11[0];
+	color[1] = a * texel00[1] + b * texel10[1] + c * texel01[1] + d * texel11[1];
+	color[2] = a * texel00[2] + b * texel10[2] + c * texel01[2] + d * texel11[2];
 
 	return color;
 }
 
-float SoftwareRenderer::clamp(float x, float a, float b)
+float SoftwareRenderer::clamp(float x, float a, float b) const
 {
 	return max(min(x, b), a);
 }
@@ -12,10 +12,42 @@
 #include "opencv2/imgproc/imgproc.hpp"
 #include "opencv2/highgui/highgui.hpp"
 
+#include <algorithm>
 #include <iostream>
+#include <stdexcept>
+
+using cv::Mat;
+using std::vector;
 
 namespace render {
 
+class Texture::DownsampleBody : public cv::ParallelLoopBody
+{
+public:
+	DownsampleBody(const Mat& source, const Mat& destination) : source(source), destination(destination) {}
+
+	void operator()(const cv::Range& range) const override
+	{
+		for (int y = range.start; y < range.end; ++y) {
+			// A dimension that is already 1 doesn't get halved anymore, then the same row or column is used twice
+			const uchar* sourceRow0 = source.ptr<uchar>(std::min(2 * y, source.rows - 1));
+			const uchar* sourceRow1 = source.ptr<uchar>(std::min(2 * y + 1, source.rows - 1));
+			uchar* destinationRow = destination.ptr<uchar>(y);
+			for (int x = 0; x < destination.cols; ++x) {
+				int x0 = 4 * std::min(2 * x, source.cols - 1);
+				int x1 = 4 * std::min(2 * x + 1, source.cols - 1);
+				for (int c = 0; c < 4; ++c) {
+					destinationRow[4 * x + c] = static_cast<uchar>((sourceRow0[x0 + c] + sourceRow0[x1 + c] + sourceRow1[x0 + c] + sourceRow1[x1 + c] + 2) >> 2);
+				}
+			}
+		}
+	}
+
+private:
+	Mat source; ///< The previous (larger) mip-level
+	Mat destination; ///< The mip-level to compute, shares its data with the texture
+};
+
 void Texture::createFromFile(const std::string& fileName, unsigned int mipmapsNum)
 {
 	cv::Mat image;
@@ -30,45 +62,62 @@ void Texture::createFromFile(const std::string& fileName, unsigned int mipmapsNu
 		exit(EXIT_FAILURE);
 	}
 
-	this->mipmapsNum = (mipmapsNum == 0 ? render::utils::getMaxPossibleMipmapsNum(image.cols, image.rows) : mipmapsNum);
-	/*if (mipmapsNum == 0)
-	{
-		uchar mmn = render::utils::MatrixUtils::getMaxPossibleMipmapsNum(image.cols, image.rows);
-		this->mipmapsNum = mmn;
-	} else
-	{
-		this->mipmapsNum = mipmapsNum;
-	}*/
+	create(image, mipmapsNum);
+	this->fileName = fileName;
+}
 
+void Texture::create(const cv::Mat& image, unsigned int mipmapsNum)
+{
+	if (image.empty() || image.depth() != CV_8U || (image.channels() != 3 && image.channels() != 4)) {
+		throw std::invalid_argument("Texture: The image must be a non-empty CV_8UC3 or CV_8UC4 image.");
+	}
+
+	this->mipmapsNum = (mipmapsNum == 0 ? render::utils::getMaxPossibleMipmapsNum(image.cols, image.rows) : mipmapsNum);
 	if (this->mipmapsNum > 1)
 	{
 		if (!isPowerOfTwo(image.cols) || !isPowerOfTwo(image.rows))
 		{
-			std::cout << "Error: Couldn't generate mipmaps for image: " << fileName << std::endl;
-			exit(EXIT_FAILURE);
+			throw std::invalid_argument("Texture: Mipmaps can only be generated for images whose width and height are powers of two.");
 		}
 	}
-	image.convertTo(image, CV_8UC4);	// Most often, the input img is CV_8UC3. Img is BGR. Add an alpha channel
-	cv::cvtColor(image, image, CV_BGR2BGRA);
 
+	// All levels are stored one after another in one buffer
+	vector<cv::Size> sizes;
+	vector<int> offsets;
+	int totalSize = 0;
 	int currWidth = image.cols;
 	int currHeight = image.rows;
-	for (int i = 0; i < this->mipmapsNum; i++)
+	for (unsigned int i = 0; i < this->mipmapsNum; i++)
 	{
-		if( i==0 ) {
-			mipmaps.push_back(image);
-		} else {
-			cv::Mat currMipMap(currHeight, currWidth, CV_8UC4);
-			cv::resize(mipmaps[i-1], currMipMap, currMipMap.size());
-			mipmaps.push_back(currMipMap);
-		}
+		sizes.push_back(cv::Size(currWidth, currHeight));
+		offsets.push_back(totalSize);
+		totalSize += currWidth * currHeight;
 
 		if (currWidth > 1)
 			currWidth >>= 1;
 		if (currHeight > 1)
 			currHeight >>= 1;
 	}
-	this->fileName = fileName;
+	storage.create(1, totalSize, CV_8UC4);
+	mipmaps.clear();
+	for (unsigned int i = 0; i < this->mipmapsNum; i++)
+	{
+		// A part of a single row is continuous, so it can be reshaped to the size of the level
+		mipmaps.push_back(storage.colRange(offsets[i], offsets[i] + sizes[i].area()).reshape(4, sizes[i].height));
+	}
+
+	// Most often, the input img is CV_8UC3. Img is BGR. Add an alpha channel
+	if (image.channels() == 3) {
+		cv::cvtColor(image, mipmaps[0], CV_BGR2BGRA);
+	} else {
+		image.copyTo(mipmaps[0]);
+	}
+	for (unsigned int i = 1; i < this->mipmapsNum; i++)
+	{
+		cv::parallel_for_(cv::Range(0, mipmaps[i].rows), DownsampleBody(mipmaps[i - 1], mipmaps[i]));
+	}
+
+	this->fileName.clear();
 	this->widthLog = (uchar)(std::log(mipmaps[0].cols)/CV_LOG2 + 0.0001f); // std::epsilon or something? or why 0.0001f here?
 	this->heightLog = (uchar)(std::log(mipmaps[0].rows)/CV_LOG2 + 0.0001f); // Changed std::logf to std::log because it doesnt compile in linux (gcc 4.8). CHECK THAT
 }
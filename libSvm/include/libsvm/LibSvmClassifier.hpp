@@ -15,6 +15,7 @@
 
 namespace classification {
 class ExampleManagement;
+class FeatureVectorStore;
 }; /* namespace classification */
 
 namespace libsvm {
@@ -98,18 +99,48 @@ public:
 public:
 
 	/**
-	 * Loads static negative training examples from a file.
+	 * Loads static negative training examples from a file. The file is either a text file with one feature vector
+	 * per line or a binary feature vector store (see classification::FeatureVectorStore), which is memory-mapped.
 	 *
 	 * @param[in] negativesFilename The name of the file containing the static negative training examples.
 	 * @param[in] maxNegatives The amount of static negative training examples to use.
 	 * @param[in] scale The factor for scaling the data after loading.
+	 * @param[in] randomSubset Flag that indicates whether to use a random subset instead of the first examples (binary files only).
 	 */
-	void loadStaticNegatives(const std::string& negativesFilename, int maxNegatives, double scale = 1);
+	void loadStaticNegatives(const std::string& negativesFilename, int maxNegatives, double scale = 1, bool randomSubset = false);
+
+	/**
+	 * Loads static negative training examples from a binary feature vector store. Only the selected feature vectors
+	 * are read.
+	 *
+	 * @param[in] store The feature vector store containing the static negative training examples.
+	 * @param[in] maxNegatives The amount of static negative training examples to use.
+	 * @param[in] scale The factor for scaling the data after loading.
+	 * @param[in] randomSubset Flag that indicates whether to use a random subset instead of the first examples.
+	 */
+	void loadStaticNegatives(const classification::FeatureVectorStore& store, int maxNegatives, double scale = 1, bool randomSubset = false);
 
 	bool retrain(const std::vector<cv::Mat>& newPositiveExamples, const std::vector<cv::Mat>& newNegativeExamples);
 
 	void reset();
 
+	/**
+	 * Enables or disables warm starts. If enabled, the solver is initialized with the coefficients of the retained
+	 * training examples of the previous training instead of starting from zero. Only supported for binary SVMs.
+	 *
+	 * @param[in] warmStart Flag that indicates whether to initialize the solver with the previous solution.
+	 */
+	void setWarmStart(bool warmStart) {
+		this->warmStart = warmStart;
+	}
+
+	/**
+	 * Changes the size of the kernel cache that libSVM uses for storing kernel values while training.
+	 *
+	 * @param[in] megabytes Maximum size of the kernel cache in MB.
+	 */
+	void setKernelCacheSize(double megabytes);
+
 	/**
 	 * @param[in] positiveExamples Storage of positive training examples.
 	 */
@@ -157,26 +188,50 @@ private:
 	bool train();
 
 	/**
-	 * Creates libSVM nodes from training examples.
+	 * Training example with its libSVM node and its coefficient of the previous training.
+	 */
+	struct TrainingNode {
+		cv::Mat example; ///< The training example (keeps the data alive, so its address cannot be taken by another example).
+		std::unique_ptr<struct svm_node[], NodeDeleter> node; ///< The libSVM node of the training example.
+		double alpha; ///< Absolute coefficient of the previous training, zero if it was no support vector.
+	};
+
+	/**
+	 * Updates the libSVM nodes to match the current training examples. Nodes of retained examples are re-used, only
+	 * new examples are converted.
 	 *
 	 * @param[in] examples Training examples.
-	 * @return Vector of libSVM nodes.
+	 * @param[in,out] nodes libSVM nodes of the previous training, will be replaced by the nodes of the given examples.
 	 */
-	std::vector<std::unique_ptr<struct svm_node[], NodeDeleter>> createNodes(classification::ExampleManagement* examples);
+	void updateNodes(classification::ExampleManagement* examples, std::vector<TrainingNode>& nodes);
 
 	/**
 	 * Creates the libSVM problem containing the training data.
 	 *
-	 * @param[in] positiveExamples Positive training examples.
-	 * @param[in] negativeExamples Negative training examples.
+	 * @param[in] positiveNodes Positive training examples.
+	 * @param[in] negativeNodes Negative training examples.
 	 * @param[in] staticNegativeExamples Static negative training examples.
 	 * @return The libSVM problem.
 	 */
 	std::unique_ptr<struct svm_problem, ProblemDeleter> createProblem(
-			const std::vector<std::unique_ptr<struct svm_node[], NodeDeleter>>& positiveExamples,
-			const std::vector<std::unique_ptr<struct svm_node[], NodeDeleter>>& negativeExamples,
+			const std::vector<TrainingNode>& positiveNodes,
+			const std::vector<TrainingNode>& negativeNodes,
 			const std::vector<std::unique_ptr<struct svm_node[], NodeDeleter>>& staticNegativeExamples);
 
+	/**
+	 * Collects the coefficients of the previous training in the order of the libSVM problem.
+	 *
+	 * @return The coefficients of all training examples.
+	 */
+	std::vector<double> collectAlphas() const;
+
+	/**
+	 * Stores the coefficients of the trained model with the training examples for the next warm start.
+	 *
+	 * @param[in] model The trained libSVM model.
+	 */
+	void storeAlphas(const struct svm_model* model);
+
 	bool compensateImbalance; ///< Flag that indicates whether to adjust class weights to compensate for unbalanced data.
 	bool probabilistic; ///< Flag that indicates whether to compute logistic parameters for probabilistic output.
 	std::shared_ptr<classification::ProbabilisticSvmClassifier> probabilisticSvm; ///< The actual probabilistic SVM classifier.
@@ -185,6 +240,11 @@ private:
 	std::unique_ptr<classification::ExampleManagement> positiveExamples; ///< Storage of positive training examples.
 	std::unique_ptr<classification::ExampleManagement> negativeExamples; ///< Storage of negative training examples.
 	std::vector<std::unique_ptr<struct svm_node[], NodeDeleter>> staticNegativeExamples; ///< The static negative training examples.
+	std::vector<double> staticNegativeAlphas; ///< Coefficients of the static negative training examples of the previous training.
+	std::vector<TrainingNode> positiveNodes; ///< libSVM nodes of the positive training examples of the previous training.
+	std::vector<TrainingNode> negativeNodes; ///< libSVM nodes of the negative training examples of the previous training.
+	bool warmStart; ///< Flag that indicates whether to initialize the solver with the previous solution.
+	bool hasAlphas; ///< Flag that indicates whether the stored coefficients belong to a previous training.
 };
 
 } /* namespace libsvm */
@@ -72,6 +72,9 @@ struct svm_model
 };
 
 struct svm_model *svm_train(const struct svm_problem *prob, const struct svm_parameter *param);
+/* initial_alpha holds one non-negative alpha per training example (in problem order),
+   it is only used for two-class C_SVC problems and ignored otherwise */
+struct svm_model *svm_train_warm_start(const struct svm_problem *prob, const struct svm_parameter *param, const double *initial_alpha);
 void svm_cross_validation(const struct svm_problem *prob, const struct svm_parameter *param, int nr_fold, double *target);
 
 int svm_save_model(const char *model_file_name, const struct svm_model *model);
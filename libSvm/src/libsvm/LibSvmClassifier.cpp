@@ -10,9 +10,14 @@
 #include "classification/ExampleManagement.hpp"
 #include "classification/UnlimitedExampleManagement.hpp"
 #include "classification/EmptyExampleManagement.hpp"
+#include "classification/FeatureVectorStore.hpp"
 #include "svm.h"
+#include <algorithm>
+#include <cmath>
 #include <fstream>
+#include <random>
 #include <stdexcept>
+#include <unordered_map>
 
 using classification::Kernel;
 using classification::SvmClassifier;
@@ -20,6 +25,7 @@ using classification::ProbabilisticSvmClassifier;
 using classification::ExampleManagement;
 using classification::UnlimitedExampleManagement;
 using classification::EmptyExampleManagement;
+using classification::FeatureVectorStore;
 using cv::Mat;
 using std::move;
 using std::string;
@@ -28,6 +34,7 @@ using std::unique_ptr;
 using std::shared_ptr;
 using std::make_shared;
 using std::invalid_argument;
+using std::unordered_map;
 
 namespace libsvm {
 
@@ -43,7 +50,12 @@ LibSvmClassifier::LibSvmClassifier(shared_ptr<SvmClassifier> svm, double cnu, bo
 		param(),
 		positiveExamples(new UnlimitedExampleManagement()),
 		negativeExamples(new UnlimitedExampleManagement()),
-		staticNegativeExamples() {
+		staticNegativeExamples(),
+		staticNegativeAlphas(),
+		positiveNodes(),
+		negativeNodes(),
+		warmStart(!oneClass),
+		hasAlphas(false) {
 	if (oneClass && compensateImbalance)
 		throw invalid_argument("LibSvmClassifier: a one-class SVM cannot have unbalanced data it needs to compensate for");
 	if (oneClass && probabilistic)
@@ -84,7 +96,17 @@ void LibSvmClassifier::createParameters(const shared_ptr<Kernel> kernel, double
 	utils.setKernelParams(*kernel, param.get());
 }
 
-void LibSvmClassifier::loadStaticNegatives(const string& negativesFilename, int maxNegatives, double scale) {
+void LibSvmClassifier::setKernelCacheSize(double megabytes) {
+	if (megabytes <= 0)
+		throw invalid_argument("LibSvmClassifier: the kernel cache size must be greater than zero");
+	param->cache_size = megabytes;
+}
+
+void LibSvmClassifier::loadStaticNegatives(const string& negativesFilename, int maxNegatives, double scale, bool randomSubset) {
+	if (FeatureVectorStore::isStore(negativesFilename)) {
+		loadStaticNegatives(FeatureVectorStore(negativesFilename), maxNegatives, scale, randomSubset);
+		return;
+	}
 	staticNegativeExamples.reserve(maxNegatives);
 	int negatives = 0;
 	vector<double> values;
@@ -107,13 +129,41 @@ void LibSvmClassifier::loadStaticNegatives(const string& negativesFilename, int
 			// create node
 			unique_ptr<struct svm_node[], NodeDeleter> data(new struct svm_node[values.size() + 1], utils.getNodeDeleter());
 			for (size_t i = 0; i < values.size(); ++i) {
-				data[i].index = i;
+				data[i].index = i + 1;
 				data[i].value = scale * values[i];
 			}
 			data[values.size()].index = -1;
 			staticNegativeExamples.push_back(move(data));
 		}
 	}
+	staticNegativeAlphas.resize(staticNegativeExamples.size(), 0.0);
+}
+
+void LibSvmClassifier::loadStaticNegatives(const FeatureVectorStore& store, int maxNegatives, double scale, bool randomSubset) {
+	size_t count = std::min(store.size(), static_cast<size_t>(std::max(0, maxNegatives)));
+	vector<size_t> indices;
+	if (randomSubset) {
+		std::mt19937 generator(std::random_device{}());
+		indices = store.sample(count, generator);
+	} else {
+		indices.resize(count);
+		for (size_t i = 0; i < count; ++i)
+			indices[i] = i;
+	}
+	int dimensions = store.getDimensions();
+	staticNegativeExamples.reserve(staticNegativeExamples.size() + count);
+	for (size_t index : indices) {
+		Mat vector = store.get(index);
+		const float* values = vector.ptr<float>();
+		unique_ptr<struct svm_node[], NodeDeleter> data(new struct svm_node[dimensions + 1], utils.getNodeDeleter());
+		for (int i = 0; i < dimensions; ++i) {
+			data[i].index = i + 1;
+			data[i].value = scale * values[i];
+		}
+		data[dimensions].index = -1;
+		staticNegativeExamples.push_back(move(data));
+	}
+	staticNegativeAlphas.resize(staticNegativeExamples.size(), 0.0);
 }
 
 bool LibSvmClassifier::retrain(const vector<Mat>& newPositiveExamples, const vector<Mat>& newNegativeExamples) {
@@ -127,20 +177,27 @@ bool LibSvmClassifier::retrain(const vector<Mat>& newPositiveExamples, const vec
 }
 
 bool LibSvmClassifier::train() {
-	vector<unique_ptr<struct svm_node[], NodeDeleter>> positiveExamples = move(createNodes(this->positiveExamples.get()));
-	vector<unique_ptr<struct svm_node[], NodeDeleter>> negativeExamples = move(createNodes(this->negativeExamples.get()));
+	updateNodes(positiveExamples.get(), positiveNodes);
+	updateNodes(negativeExamples.get(), negativeNodes);
 	if (compensateImbalance) {
-		double positiveCount = positiveExamples.size();
-		double negativeCount = negativeExamples.size() + staticNegativeExamples.size();
+		double positiveCount = positiveNodes.size();
+		double negativeCount = negativeNodes.size() + staticNegativeExamples.size();
 		param->weight[0] = negativeCount / positiveCount;
 		param->weight[1] = positiveCount / negativeCount;
 	}
 	unique_ptr<struct svm_problem, ProblemDeleter> problem = move(createProblem(
-			positiveExamples, negativeExamples, staticNegativeExamples));
+			positiveNodes, negativeNodes, staticNegativeExamples));
 	const char* message = svm_check_parameter(problem.get(), param.get());
 	if (message != 0)
 		throw invalid_argument(string("LibSvmClassifier: invalid SVM parameters: ") + message);
-	unique_ptr<struct svm_model, ModelDeleter> model(svm_train(problem.get(), param.get()));
+	unique_ptr<struct svm_model, ModelDeleter> model;
+	if (warmStart && hasAlphas && param->svm_type == C_SVC) {
+		vector<double> alphas = collectAlphas();
+		model.reset(svm_train_warm_start(problem.get(), param.get(), alphas.data()));
+	} else {
+		model.reset(svm_train(problem.get(), param.get()));
+	}
+	storeAlphas(model.get());
 	svm->setSvmParameters(
 			utils.extractSupportVectors(model.get()),
 			utils.extractCoefficients(model.get()),
@@ -153,31 +210,46 @@ bool LibSvmClassifier::train() {
 	return true;
 }
 
-vector<unique_ptr<struct svm_node[], NodeDeleter>> LibSvmClassifier::createNodes(ExampleManagement* examples) {
-	vector<unique_ptr<struct svm_node[], NodeDeleter>> nodes;
-	nodes.reserve(examples->size());
-	for (auto iterator = examples->iterator(); iterator->hasNext();)
-		nodes.push_back(move(utils.createNode(iterator->next())));
-	return move(nodes);
+void LibSvmClassifier::updateNodes(ExampleManagement* examples, vector<TrainingNode>& nodes) {
+	// examples are identified by their data, which stays alive as long as the node keeps a reference to it
+	unordered_map<const uchar*, size_t> indices;
+	indices.reserve(nodes.size());
+	for (size_t i = 0; i < nodes.size(); ++i)
+		indices.emplace(nodes[i].example.data, i);
+	vector<TrainingNode> updatedNodes;
+	updatedNodes.reserve(examples->size());
+	for (auto iterator = examples->iterator(); iterator->hasNext();) {
+		const Mat& example = iterator->next();
+		auto index = indices.find(example.data);
+		if (index != indices.end()) {
+			TrainingNode& node = nodes[index->second];
+			if (node.node && node.example.size() == example.size() && node.example.type() == example.type()) {
+				updatedNodes.push_back(move(node));
+				continue;
+			}
+		}
+		updatedNodes.push_back(TrainingNode{example, utils.createNode(example), 0.0});
+	}
+	nodes.swap(updatedNodes);
 }
 
 unique_ptr<struct svm_problem, ProblemDeleter> LibSvmClassifier::createProblem(
-		const vector<unique_ptr<struct svm_node[], NodeDeleter>>& positiveExamples,
-		const vector<unique_ptr<struct svm_node[], NodeDeleter>>& negativeExamples,
+		const vector<TrainingNode>& positiveNodes,
+		const vector<TrainingNode>& negativeNodes,
 		const vector<unique_ptr<struct svm_node[], NodeDeleter>>& staticNegativeExamples) {
 	unique_ptr<struct svm_problem, ProblemDeleter> problem(new struct svm_problem);
-	problem->l = positiveExamples.size() + negativeExamples.size() + staticNegativeExamples.size();
+	problem->l = positiveNodes.size() + negativeNodes.size() + staticNegativeExamples.size();
 	problem->y = new double[problem->l];
 	problem->x = new struct svm_node *[problem->l];
 	size_t i = 0;
-	for (auto& example : positiveExamples) {
+	for (const TrainingNode& node : positiveNodes) {
 		problem->y[i] = 1;
-		problem->x[i] = example.get();
+		problem->x[i] = node.node.get();
 		++i;
 	}
-	for (auto& example : negativeExamples) {
+	for (const TrainingNode& node : negativeNodes) {
 		problem->y[i] = -1;
-		problem->x[i] = example.get();
+		problem->x[i] = node.node.get();
 		++i;
 	}
 	for (auto& example : staticNegativeExamples) {
@@ -188,11 +260,47 @@ unique_ptr<struct svm_problem, ProblemDeleter> LibSvmClassifier::createProblem(
 	return move(problem);
 }
 
+vector<double> LibSvmClassifier::collectAlphas() const {
+	vector<double> alphas;
+	alphas.reserve(positiveNodes.size() + negativeNodes.size() + staticNegativeAlphas.size());
+	for (const TrainingNode& node : positiveNodes)
+		alphas.push_back(node.alpha);
+	for (const TrainingNode& node : negativeNodes)
+		alphas.push_back(node.alpha);
+	alphas.insert(alphas.end(), staticNegativeAlphas.begin(), staticNegativeAlphas.end());
+	return alphas;
+}
+
+void LibSvmClassifier::storeAlphas(const struct svm_model* model) {
+	for (TrainingNode& node : positiveNodes)
+		node.alpha = 0;
+	for (TrainingNode& node : negativeNodes)
+		node.alpha = 0;
+	std::fill(staticNegativeAlphas.begin(), staticNegativeAlphas.end(), 0.0);
+	size_t positiveCount = positiveNodes.size();
+	size_t negativeCount = negativeNodes.size();
+	for (int i = 0; i < model->l; ++i) {
+		size_t index = model->sv_indices[i] - 1;
+		double alpha = std::abs(model->sv_coef[0][i]);
+		if (index < positiveCount)
+			positiveNodes[index].alpha = alpha;
+		else if (index < positiveCount + negativeCount)
+			negativeNodes[index - positiveCount].alpha = alpha;
+		else
+			staticNegativeAlphas[index - positiveCount - negativeCount] = alpha;
+	}
+	hasAlphas = true;
+}
+
 void LibSvmClassifier::reset() {
 	usable = false;
 	svm->setSvmParameters(vector<Mat>(), vector<float>(), 0.0);
 	positiveExamples->clear();
 	negativeExamples->clear();
+	positiveNodes.clear();
+	negativeNodes.clear();
+	std::fill(staticNegativeAlphas.begin(), staticNegativeAlphas.end(), 0.0);
+	hasAlphas = false;
 }
 
 } /* namespace libsvm */
@@ -1486,7 +1486,8 @@ private:
 //
 static void solve_c_svc(
 	const svm_problem *prob, const svm_parameter* param,
-	double *alpha, Solver::SolutionInfo* si, double Cp, double Cn)
+	double *alpha, Solver::SolutionInfo* si, double Cp, double Cn,
+	const double *initial_alpha)
 {
 	int l = prob->l;
 	double *minus_ones = new double[l];
@@ -1501,6 +1502,27 @@ static void solve_c_svc(
 		if(prob->y[i] > 0) y[i] = +1; else y[i] = -1;
 	}
 
+	if(initial_alpha)
+	{
+		// warm start: clip to the box constraints and restore
+		// sum(y_i alpha_i) = 0 by lowering the alphas of the
+		// dominating class, so that the start is feasible
+		double sum_y_alpha = 0;
+		for(i=0;i<l;i++)
+		{
+			double C = y[i] > 0 ? Cp : Cn;
+			alpha[i] = min(max(initial_alpha[i],0.0),C);
+			sum_y_alpha += y[i]*alpha[i];
+		}
+		for(i=0;i<l && sum_y_alpha != 0;i++)
+			if(y[i]*sum_y_alpha > 0)
+			{
+				double delta = min(alpha[i],fabs(sum_y_alpha));
+				alpha[i] -= delta;
+				sum_y_alpha -= y[i]*delta;
+			}
+	}
+
 	Solver s;
 	s.Solve(l, SVC_Q(*prob,*param,y), minus_ones, y,
 		alpha, Cp, Cn, param->eps, si, param->shrinking);
@@ -1693,14 +1715,14 @@ struct decision_function
 
 static decision_function svm_train_one(
 	const svm_problem *prob, const svm_parameter *param,
-	double Cp, double Cn)
+	double Cp, double Cn, const double *initial_alpha = NULL)
 {
 	double *alpha = Malloc(double,prob->l);
 	Solver::SolutionInfo si;
 	switch(param->svm_type)
 	{
 		case C_SVC:
-			solve_c_svc(prob,param,alpha,&si,Cp,Cn);
+			solve_c_svc(prob,param,alpha,&si,Cp,Cn,initial_alpha);
 			break;
 		case NU_SVC:
 			solve_nu_svc(prob,param,alpha,&si);
@@ -2136,7 +2158,7 @@ static void svm_group_classes(const svm_problem *prob, int *nr_class_ret, int **
 //
 // Interface functions
 //
-svm_model *svm_train(const svm_problem *prob, const svm_parameter *param)
+static svm_model *svm_train_internal(const svm_problem *prob, const svm_parameter *param, const double *initial_alpha)
 {
 	svm_model *model = Malloc(svm_model,1);
 	model->param = *param;
@@ -2261,7 +2283,20 @@ svm_model *svm_train(const svm_problem *prob, const svm_parameter *param)
 				if(param->probability)
 					svm_binary_svc_probability(&sub_prob,param,weighted_C[i],weighted_C[j],probA[p],probB[p]);
 
-				f[p] = svm_train_one(&sub_prob,param,weighted_C[i],weighted_C[j]);
+				// warm start is only possible for a single binary problem,
+				// the alphas of one-against-one problems are not comparable
+				double *sub_alpha = NULL;
+				if(initial_alpha && param->svm_type == C_SVC && nr_class == 2)
+				{
+					sub_alpha = Malloc(double,sub_prob.l);
+					for(k=0;k<ci;k++)
+						sub_alpha[k] = initial_alpha[perm[si+k]];
+					for(k=0;k<cj;k++)
+						sub_alpha[ci+k] = initial_alpha[perm[sj+k]];
+				}
+
+				f[p] = svm_train_one(&sub_prob,param,weighted_C[i],weighted_C[j],sub_alpha);
+				free(sub_alpha);
 				for(k=0;k<ci;k++)
 					if(!nonzero[si+k] && fabs(f[p].alpha[k]) > 0)
 						nonzero[si+k] = true;
@@ -2382,6 +2417,16 @@ svm_model *svm_train(const svm_problem *prob, const svm_parameter *param)
 	return model;
 }
 
+svm_model *svm_train(const svm_problem *prob, const svm_parameter *param)
+{
+	return svm_train_internal(prob,param,NULL);
+}
+
+svm_model *svm_train_warm_start(const svm_problem *prob, const svm_parameter *param, const double *initial_alpha)
+{
+	return svm_train_internal(prob,param,initial_alpha);
+}
+
 // Stratified cross validation
 void svm_cross_validation(const svm_problem *prob, const svm_parameter *param, int nr_fold, double *target)
 {
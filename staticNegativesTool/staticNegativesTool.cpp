@@ -0,0 +1,239 @@
+/*
+ * staticNegativesTool.cpp
+ *
+ *  Created on: 18.10.2026
+ *      Author: poschmann
+ */
+
+#include "imageio/DirectoryImageSource.hpp"
+#include "imageprocessing/GrayscaleFilter.hpp"
+#include "imageprocessing/UnitNormFilter.hpp"
+#include "imageprocessing/ConversionFilter.hpp"
+#include "imageprocessing/WhiteningFilter.hpp"
+#include "imageprocessing/HistogramEqualizationFilter.hpp"
+#include "imageprocessing/GradientFilter.hpp"
+#include "imageprocessing/GradientMagnitudeFilter.hpp"
+#include "imageprocessing/GradientBinningFilter.hpp"
+#include "imageprocessing/SpatialHistogramFilter.hpp"
+#include "imageprocessing/SpatialPyramidHistogramFilter.hpp"
+#include "imageprocessing/HogFilter.hpp"
+#include "imageprocessing/ExtendedHogFilter.hpp"
+#include "imageprocessing/LbpFilter.hpp"
+#include "imageprocessing/DirectPyramidFeatureExtractor.hpp"
+#include "imageprocessing/Patch.hpp"
+#include "classification/FeatureVectorStoreWriter.hpp"
+#include "boost/program_options.hpp"
+#include "boost/property_tree/ptree.hpp"
+#include "boost/property_tree/info_parser.hpp"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace imageprocessing;
+using classification::FeatureVectorStoreWriter;
+using imageio::DirectoryImageSource;
+using boost::property_tree::ptree;
+using cv::Mat;
+using std::make_shared;
+using std::shared_ptr;
+using std::string;
+using std::vector;
+using std::invalid_argument;
+
+namespace po = boost::program_options;
+
+/**
+ * Converts a text file with one feature vector per line (values separated by a single character) into a
+ * binary feature vector store.
+ */
+size_t convertText(const string& inputFilename, FeatureVectorStoreWriter& writer) {
+	std::ifstream file(inputFilename);
+	if (!file)
+		throw invalid_argument("staticNegativesTool: could not open file '" + inputFilename + "'");
+	vector<float> values;
+	double value;
+	char separator;
+	string line;
+	while (std::getline(file, line)) {
+		values.clear();
+		std::istringstream lineStream(line);
+		while (lineStream.good() && !lineStream.fail()) {
+			lineStream >> value >> separator;
+			values.push_back(static_cast<float>(value));
+		}
+		writer.add(Mat(values, false));
+	}
+	return writer.size();
+}
+
+shared_ptr<HistogramFilter> createHistogramFilter(unsigned int bins, ptree& config) {
+	HistogramFilter::Normalization normalization;
+	if (config.get<string>("normalization") == "none")
+		normalization = HistogramFilter::Normalization::NONE;
+	else if (config.get<string>("normalization") == "l2norm")
+		normalization = HistogramFilter::Normalization::L2NORM;
+	else if (config.get<string>("normalization") == "l2hys")
+		normalization = HistogramFilter::Normalization::L2HYS;
+	else if (config.get<string>("normalization") == "l1norm")
+		normalization = HistogramFilter::Normalization::L1NORM;
+	else if (config.get<string>("normalization") == "l1sqrt")
+		normalization = HistogramFilter::Normalization::L1SQRT;
+	else
+		throw invalid_argument("staticNegativesTool: invalid normalization method: " + config.get<string>("normalization"));
+	if (config.get_value<string>() == "spatial")
+		return make_shared<SpatialHistogramFilter>(bins, config.get<int>("cellSize"), config.get<int>("blockSize"),
+				config.get<bool>("interpolate"), config.get<bool>("concatenate"), normalization);
+	else if (config.get_value<string>() == "pyramid")
+		return make_shared<SpatialPyramidHistogramFilter>(bins, config.get<int>("levels"), config.get<bool>("interpolate"), normalization);
+	else
+		throw invalid_argument("staticNegativesTool: invalid histogram type: " + config.get_value<string>());
+}
+
+shared_ptr<LbpFilter> createLbpFilter(const string& lbpType) {
+	if (lbpType == "lbp8")
+		return make_shared<LbpFilter>(LbpFilter::Type::LBP8);
+	else if (lbpType == "lbp8uniform")
+		return make_shared<LbpFilter>(LbpFilter::Type::LBP8_UNIFORM);
+	else if (lbpType == "lbp4")
+		return make_shared<LbpFilter>(LbpFilter::Type::LBP4);
+	else if (lbpType == "lbp4rotated")
+		return make_shared<LbpFilter>(LbpFilter::Type::LBP4_ROTATED);
+	else
+		throw invalid_argument("staticNegativesTool: invalid LBP type: " + lbpType);
+}
+
+/**
+ * Creates a pyramid based feature extractor, uses the same configuration format as the tracking apps.
+ */
+shared_ptr<DirectPyramidFeatureExtractor> createFeatureExtractor(ptree& config) {
+	ptree& pyramidConfig = config.get_child("pyramid");
+	shared_ptr<DirectPyramidFeatureExtractor> featureExtractor = make_shared<DirectPyramidFeatureExtractor>(
+			pyramidConfig.get<int>("patch.width"), pyramidConfig.get<int>("patch.height"),
+			pyramidConfig.get<int>("patch.minWidth"), pyramidConfig.get<int>("patch.maxWidth"),
+			pyramidConfig.get<int>("interval"));
+	featureExtractor->addImageFilter(make_shared<GrayscaleFilter>());
+	if (config.get_value<string>() == "histeq") {
+		featureExtractor->addPatchFilter(make_shared<HistogramEqualizationFilter>());
+	} else if (config.get_value<string>() == "whi") {
+		featureExtractor->addPatchFilter(make_shared<WhiteningFilter>());
+		featureExtractor->addPatchFilter(make_shared<HistogramEqualizationFilter>());
+		featureExtractor->addPatchFilter(make_shared<ConversionFilter>(CV_32F, 1.0 / 127.5, -1.0));
+		featureExtractor->addPatchFilter(make_shared<UnitNormFilter>(cv::NORM_L2));
+	} else if (config.get_value<string>() == "hog") {
+		featureExtractor->addLayerFilter(make_shared<GradientFilter>(config.get<int>("gradientKernel"), config.get<int>("blurKernel")));
+		featureExtractor->addLayerFilter(make_shared<GradientBinningFilter>(config.get<int>("bins"), config.get<bool>("signed"), config.get<bool>("interpolate")));
+		if (config.get<int>("histogram.blockSize") == 1 && !config.get<bool>("histogram.signedAndUnsigned"))
+			featureExtractor->addPatchFilter(createHistogramFilter(config.get<int>("bins"), config.get_child("histogram")));
+		else
+			featureExtractor->addPatchFilter(make_shared<HogFilter>(config.get<int>("bins"), config.get<int>("histogram.cellSize"),
+					config.get<int>("histogram.blockSize"), config.get<bool>("histogram.interpolate"), config.get<bool>("histogram.signedAndUnsigned")));
+	} else if (config.get_value<string>() == "ehog") {
+		featureExtractor->addLayerFilter(make_shared<GradientFilter>(config.get<int>("gradientKernel"), config.get<int>("blurKernel")));
+		featureExtractor->addLayerFilter(make_shared<GradientBinningFilter>(config.get<int>("bins"), config.get<bool>("signed"), config.get<bool>("interpolate")));
+		featureExtractor->addPatchFilter(make_shared<ExtendedHogFilter>(config.get<int>("bins"), config.get<int>("histogram.cellSize"),
+				config.get<bool>("histogram.interpolate"), config.get<bool>("histogram.signedAndUnsigned"), config.get<float>("histogram.alpha")));
+	} else if (config.get_value<string>() == "lbp") {
+		shared_ptr<LbpFilter> lbpFilter = createLbpFilter(config.get<string>("type"));
+		featureExtractor->addLayerFilter(lbpFilter);
+		featureExtractor->addPatchFilter(createHistogramFilter(lbpFilter->getBinCount(), config.get_child("histogram")));
+	} else if (config.get_value<string>() == "glbp") {
+		shared_ptr<LbpFilter> lbpFilter = createLbpFilter(config.get<string>("type"));
+		featureExtractor->addLayerFilter(make_shared<GradientFilter>(config.get<int>("gradientKernel"), config.get<int>("blurKernel")));
+		featureExtractor->addLayerFilter(make_shared<GradientMagnitudeFilter>());
+		featureExtractor->addLayerFilter(lbpFilter);
+		featureExtractor->addPatchFilter(createHistogramFilter(lbpFilter->getBinCount(), config.get_child("histogram")));
+	} else {
+		throw invalid_argument("staticNegativesTool: invalid feature type: " + config.get_value<string>());
+	}
+	return featureExtractor;
+}
+
+/**
+ * Extracts the feature vectors of randomly placed and sized windows of all images of a directory.
+ */
+size_t extractNegatives(const string& directory, FeatureExtractor& featureExtractor,
+		int patchWidth, int patchHeight, int minWidth, int maxWidth, int negativesPerImage, FeatureVectorStoreWriter& writer) {
+	std::mt19937 generator(std::random_device{}());
+	DirectoryImageSource imageSource(directory);
+	while (imageSource.next()) {
+		Mat image = imageSource.getImage();
+		if (image.empty())
+			continue;
+		featureExtractor.update(image);
+		int maxImageWidth = std::min(maxWidth, std::min(image.cols, image.rows * patchWidth / patchHeight));
+		if (maxImageWidth < minWidth)
+			continue;
+		std::uniform_int_distribution<int> widthDistribution(minWidth, maxImageWidth);
+		for (int i = 0; i < negativesPerImage; ++i) {
+			int width = widthDistribution(generator);
+			int height = width * patchHeight / patchWidth;
+			int x = std::uniform_int_distribution<int>(width / 2, image.cols - width + width / 2)(generator);
+			int y = std::uniform_int_distribution<int>(height / 2, image.rows - height + height / 2)(generator);
+			shared_ptr<Patch> patch = featureExtractor.extract(x, y, width, height);
+			if (patch)
+				writer.add(patch->getData());
+		}
+	}
+	return writer.size();
+}
+
+int main(int argc, char *argv[]) {
+	string textFilename, directory, configFile, outputFilename;
+	int negativesPerImage;
+
+	try {
+		po::options_description desc("Allowed options");
+		desc.add_options()
+			("help,h", "Produce help message")
+			("text,t", po::value<string>(&textFilename), "Text file with one feature vector per line that should be converted")
+			("directory,i", po::value<string>(&directory), "Directory with images that do not contain the target to extract negatives from")
+			("config,c", po::value<string>(&configFile)->default_value("default.cfg", "default.cfg"), "Config file with the feature extraction parameters")
+			("negatives,n", po::value<int>(&negativesPerImage)->default_value(50), "Number of negatives to extract from each image")
+			("output,o", po::value<string>(&outputFilename)->required(), "Binary feature vector file that is created")
+			;
+
+		po::variables_map vm;
+		po::store(po::parse_command_line(argc, argv, desc), vm);
+		if (vm.count("help")) {
+			std::cout << "Usage: staticNegativesTool [options]" << std::endl;
+			std::cout << desc;
+			return 0;
+		}
+		po::notify(vm);
+		if (vm.count("text") == vm.count("directory")) {
+			std::cerr << "Either a text file or an image directory must be specified" << std::endl;
+			return -1;
+		}
+	} catch (std::exception& e) {
+		std::cerr << e.what() << std::endl;
+		return -1;
+	}
+
+	try {
+		FeatureVectorStoreWriter writer(outputFilename);
+		size_t count;
+		if (!textFilename.empty()) {
+			count = convertText(textFilename, writer);
+		} else {
+			ptree config;
+			boost::property_tree::info_parser::read_info(configFile, config);
+			ptree& featureConfig = config.get_child("feature");
+			shared_ptr<DirectPyramidFeatureExtractor> featureExtractor = createFeatureExtractor(featureConfig);
+			count = extractNegatives(directory, *featureExtractor,
+					featureConfig.get<int>("pyramid.patch.width"), featureConfig.get<int>("pyramid.patch.height"),
+					featureConfig.get<int>("pyramid.patch.minWidth"), featureConfig.get<int>("pyramid.patch.maxWidth"),
+					negativesPerImage, writer);
+		}
+		writer.close();
+		std::cout << "Wrote " << count << " feature vectors to " << outputFilename << std::endl;
+	} catch (std::exception& e) {
+		std::cerr << e.what() << std::endl;
+		return -1;
+	}
+	return 0;
+}